@@ -0,0 +1,136 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "Bench.hpp"
+#include "instrument/Allocations.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+    struct Sample
+    {
+        double nanoseconds;
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+    };
+
+    Sample timeBatch(bench::Benchmark const & benchmark, std::size_t const n)
+    {
+        if (benchmark.setup) {
+            benchmark.setup(n);
+        }
+        auto const allocations = instrument::allocationCount();
+        auto const bytes = instrument::allocatedBytes();
+        auto const start = std::chrono::steady_clock::now();
+        benchmark.run(n);
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        return {std::chrono::duration<double, std::nano>(elapsed).count(),
+                instrument::allocationCount() - allocations,
+                instrument::allocatedBytes() - bytes};
+    }
+
+    std::string escape(std::string const & text)
+    {
+        std::string out;
+        for (auto const c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+}
+
+namespace bench {
+
+    std::vector<Result> runAll(std::vector<Benchmark> const & benchmarks,
+                               Options const & options,
+                               std::ostream & progress)
+    {
+        std::vector<Result> results;
+        for (auto const & benchmark : benchmarks) {
+            if (benchmark.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            progress << benchmark.name << "..." << std::flush;
+
+            // Grow the batch until it takes at least a millisecond,
+            // which also serves as the warm-up
+            std::size_t n = 1;
+            auto calibration = timeBatch(benchmark, n);
+            auto const maxBatch = benchmark.maxBatch ? benchmark.maxBatch : std::size_t(1) << 30;
+            while (calibration.nanoseconds < 1e6 && n < maxBatch) {
+                n = std::min(n * 10, maxBatch);
+                calibration = timeBatch(benchmark, n);
+            }
+            auto const perOp = calibration.nanoseconds / n;
+            n = std::max<std::size_t>(1, options.sampleMilliseconds * 1e6 / perOp);
+            n = std::min(n, maxBatch);
+
+            std::vector<double> nanosecondsPerOp;
+            std::uint64_t allocations = 0;
+            std::uint64_t bytes = 0;
+            for (int s = 0; s < options.samples; ++s) {
+                auto const sample = timeBatch(benchmark, n);
+                nanosecondsPerOp.push_back(sample.nanoseconds / n);
+                allocations += sample.allocations;
+                bytes += sample.bytes;
+            }
+            std::sort(std::begin(nanosecondsPerOp), std::end(nanosecondsPerOp));
+
+            Result result;
+            result.name = benchmark.name;
+            result.iterations = n * options.samples;
+            result.nanosecondsPerOp = nanosecondsPerOp[nanosecondsPerOp.size() / 2];
+            result.allocationsPerOp = double(allocations) / result.iterations;
+            result.bytesPerOp = double(bytes) / result.iterations;
+            results.push_back(result);
+            progress << " done" << std::endl;
+        }
+        return results;
+    }
+
+    void writeTable(std::vector<Result> const & results, std::ostream & out)
+    {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-44s %14s %12s %12s\n",
+                      "benchmark", "ns/op", "allocs/op", "bytes/op");
+        out << line;
+        for (auto const & result : results) {
+            std::snprintf(line, sizeof(line), "%-44s %14.1f %12.2f %12.1f\n",
+                          result.name.c_str(),
+                          result.nanosecondsPerOp,
+                          result.allocationsPerOp,
+                          result.bytesPerOp);
+            out << line;
+        }
+    }
+
+    void writeJson(std::vector<Result> const & results, std::ostream & out)
+    {
+        char date[32];
+        auto const now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        out << "{\n  \"context\": {\"date\": \"" << date << "\", \"compiler\": \""
+            << escape(__VERSION__) << "\"},\n  \"benchmarks\": [";
+        char line[512];
+        for (std::size_t r = 0; r < results.size(); ++r) {
+            auto const & result = results[r];
+            std::snprintf(line, sizeof(line),
+                          "%s\n    {\"name\": \"%s\", \"iterations\": %llu, "
+                          "\"ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}",
+                          r == 0 ? "" : ",",
+                          escape(result.name).c_str(),
+                          static_cast<unsigned long long>(result.iterations),
+                          result.nanosecondsPerOp,
+                          result.allocationsPerOp,
+                          result.bytesPerOp);
+            out << line;
+        }
+        out << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,66 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    /// A kernel to time. setup(n) prepares for n operations and is not
+    /// timed; run(n) performs them. setup may be left empty.
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void(std::size_t const n)> setup;
+        std::function<void(std::size_t const n)> run;
+
+        /// Upper bound on n for kernels whose setup holds state per
+        /// operation; zero for no bound
+        std::size_t maxBatch = 0;
+    };
+
+    struct Result
+    {
+        std::string name;
+        std::uint64_t iterations;
+
+        /// Median over the samples
+        double nanosecondsPerOp;
+
+        /// Averaged over every timed iteration
+        double allocationsPerOp;
+        double bytesPerOp;
+    };
+
+    struct Options
+    {
+        /// Only benchmarks whose name contains this are run
+        std::string filter;
+
+        /// Time to spend on each sample, and how many samples
+        double sampleMilliseconds = 100;
+        int samples = 5;
+    };
+
+    /// Keeps the compiler from optimising away a value
+    template <typename T>
+    inline void keep(T const & value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Times each benchmark: the iteration count is first grown until
+    /// one batch takes a measurable time, then scaled so that each
+    /// sample lasts about sampleMilliseconds.
+    std::vector<Result> runAll(std::vector<Benchmark> const & benchmarks,
+                               Options const & options,
+                               std::ostream & progress);
+
+    void writeTable(std::vector<Result> const & results, std::ostream & out);
+    void writeJson(std::vector<Result> const & results, std::ostream & out);
+}
@@ -0,0 +1,282 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "Kernels.hpp"
+#include "model/Animat.hpp"
+#include "model/AnimatWorld.hpp"
+#include "physics/PhysicsEngine.hpp"
+#include "physics/WaterForceGenerator.hpp"
+#include "ctrnn/Network.hpp"
+#include "ctrnn/FixedNetwork.hpp"
+#include "simulator/CTRNNController.hpp"
+#include "simulator/Simulation.hpp"
+#include "neat/Network.hpp"
+#include "neat/MutationParameters.hpp"
+#include <memory>
+#include <string>
+
+namespace {
+
+    /// Matches the genome shape Agent evolves
+    neat::Network makeNeatNet(int const mutations)
+    {
+        neat::Network net(7, 3, 13, {0.2, 0.2, 0.5, 0.2}, 30.0);
+        for (int m = 0; m < mutations; ++m) {
+            net.mutate();
+        }
+        return net;
+    }
+
+    void addPhysics(std::vector<bench::Benchmark> & benchmarks)
+    {
+        for (int blocks = 5; blocks <= 8; ++blocks) {
+            auto animat = std::make_shared<model::Animat>(0, model::AnimatProperties{blocks, 2.0, 4.0});
+            benchmarks.push_back({"physics.update/blocks:" + std::to_string(blocks),
+                                  {},
+                                  [animat](std::size_t const n) {
+                                      auto & engine = animat->getPhysicsEngine();
+                                      for (std::size_t i = 0; i < n; ++i) {
+                                          engine.update(0.1);
+                                      }
+                                  }});
+        }
+
+        auto animat = std::make_shared<model::Animat>(0);
+        benchmarks.push_back({"physics.water_apply",
+                              {},
+                              [animat](std::size_t const n) {
+                                  auto & engine = animat->getPhysicsEngine();
+                                  auto & block = animat->getBlock(0);
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      physics::WaterForceGenerator(block.getLayerOne(),
+                                                                   block.getLayerTwo(),
+                                                                   engine).apply();
+                                  }
+                              }});
+    }
+
+    void addCollisions(std::vector<bench::Benchmark> & benchmarks)
+    {
+        // Overlapping bodies take the full segment test; distant ones
+        // should be rejected by the bounding checks
+        auto self = std::make_shared<model::Animat>(0);
+        auto near = std::make_shared<model::Animat>(1);
+        auto far = std::make_shared<model::Animat>(2);
+        auto & engine = far->getPhysicsEngine();
+        for (int p = 0; p < engine.getPointMassCount(); ++p) {
+            engine.getPointMassPositionRef(p) += physics::Vector3(500, 500, 0);
+        }
+        far->updateDerivedComponents();
+
+        for (auto const & other : {std::make_pair(std::string("near"), near),
+                                   std::make_pair(std::string("far"), far)}) {
+            auto const animat = other.second;
+            benchmarks.push_back({"animat.collision/" + other.first,
+                                  {},
+                                  [self, animat](std::size_t const n) {
+                                      for (std::size_t i = 0; i < n; ++i) {
+                                          bench::keep(self->checkForCollisionWithOther(animat, false));
+                                      }
+                                  }});
+        }
+    }
+
+    template <typename CTRNN>
+    void addCTRNN(std::vector<bench::Benchmark> & benchmarks,
+                  std::string const & name,
+                  int const neurons)
+    {
+        auto net = std::make_shared<CTRNN>(neurons, 15.0);
+        for (int i = 0; i < neurons; ++i) {
+            for (int j = 0; j < neurons; ++j) {
+                if (i != j) {
+                    net->connect(i, j, ((i * 7 + j * 3) % 11 - 5) * 0.4);
+                }
+            }
+            net->setExternalInput(i, 0.1 * (i % 3));
+        }
+        benchmarks.push_back({name + "/neurons:" + std::to_string(neurons),
+                              {},
+                              [net](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      net->update();
+                                  }
+                                  bench::keep(net->getNeuronActivation(0));
+                              }});
+    }
+
+    void addControllers(std::vector<bench::Benchmark> & benchmarks)
+    {
+        for (int neurons = 20; neurons <= 48; neurons += 4) {
+            addCTRNN<ctrnn::Network>(benchmarks, "ctrnn.update", neurons);
+        }
+        addCTRNN<ctrnn::FixedNetwork<20>>(benchmarks, "ctrnn.fixed_update", 20);
+        addCTRNN<ctrnn::FixedNetwork<24>>(benchmarks, "ctrnn.fixed_update", 24);
+        addCTRNN<ctrnn::FixedNetwork<28>>(benchmarks, "ctrnn.fixed_update", 28);
+        addCTRNN<ctrnn::FixedNetwork<32>>(benchmarks, "ctrnn.fixed_update", 32);
+        addCTRNN<ctrnn::FixedNetwork<36>>(benchmarks, "ctrnn.fixed_update", 36);
+        addCTRNN<ctrnn::FixedNetwork<40>>(benchmarks, "ctrnn.fixed_update", 40);
+        addCTRNN<ctrnn::FixedNetwork<44>>(benchmarks, "ctrnn.fixed_update", 44);
+        addCTRNN<ctrnn::FixedNetwork<48>>(benchmarks, "ctrnn.fixed_update", 48);
+
+        for (int blocks = 5; blocks <= 12; ++blocks) {
+            auto neat = std::make_shared<neat::Network>(makeNeatNet(20));
+            auto controller = simulator::makeCTRNNController(blocks, *neat);
+            benchmarks.push_back({"controller.set/blocks:" + std::to_string(blocks),
+                                  {},
+                                  [neat, controller](std::size_t const n) {
+                                      for (std::size_t i = 0; i < n; ++i) {
+                                          controller->set();
+                                      }
+                                  }});
+
+            // What an agent does on taking a new genome; in place, so
+            // should not allocate at any block count
+            benchmarks.push_back({"controller.reset/blocks:" + std::to_string(blocks),
+                                  {},
+                                  [neat, controller](std::size_t const n) {
+                                      for (std::size_t i = 0; i < n; ++i) {
+                                          controller->reset();
+                                      }
+                                  }});
+        }
+    }
+
+    void addTick(std::vector<bench::Benchmark> & benchmarks)
+    {
+        // Whole ticks of a small world with evolution off, run past
+        // start-up first; steady state should not allocate at all
+        for (auto const collisions : {false, true}) {
+            // Leaked: a Simulation is never torn down
+            auto * simulation = new simulator::Simulation(20, 42);
+            simulation->deactivateEvolution();
+            if (collisions) {
+                simulation->enableCollisionHandling();
+            } else {
+                simulation->disableCollisionHandling();
+            }
+            simulation->runTicks(100);
+            benchmarks.push_back({std::string("simulation.tick/pop:20/collisions:") +
+                                  (collisions ? "on" : "off"),
+                                  {},
+                                  [simulation](std::size_t const n) {
+                                      simulation->runTicks(n);
+                                  }});
+        }
+
+        // As above with the larger bodies evolution can produce, whose
+        // controllers are reset whenever their physics breaks
+        auto * simulation = new simulator::Simulation(20, 42);
+        simulation->deactivateEvolution();
+        auto & agents = simulation->population().getAgents();
+        for (int i = 0; i < static_cast<int>(agents.size()); ++i) {
+            simulation->animatWorld().reconstructAnimat(i, 9 + i % 4);
+            agents[i].resetController();
+        }
+        simulation->runTicks(100);
+        benchmarks.push_back({"simulation.tick/pop:20/blocks:9-12",
+                              {},
+                              [simulation](std::size_t const n) {
+                                  simulation->runTicks(n);
+                              }});
+    }
+
+    void addReconstruct(std::vector<bench::Benchmark> & benchmarks)
+    {
+        // Cycles one animat through every segment count evolution can
+        // produce, resizing it in place each op
+        auto world = std::make_shared<model::AnimatWorld>(20, 42);
+        auto segments = std::make_shared<int>(5);
+        benchmarks.push_back({"world.reconstruct",
+                              {},
+                              [world, segments](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      *segments = *segments == 12 ? 5 : *segments + 1;
+                                      world->reconstructAnimat(0, *segments);
+                                  }
+                              }});
+    }
+
+    void addNeat(std::vector<bench::Benchmark> & benchmarks)
+    {
+        auto parent = std::make_shared<neat::Network>(makeNeatNet(20));
+        auto other = std::make_shared<neat::Network>(makeNeatNet(20));
+
+        benchmarks.push_back({"neat.copy",
+                              {},
+                              [parent](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      neat::Network copy(*parent);
+                                      bench::keep(copy);
+                                  }
+                              }});
+
+        // What an evolution step does: the genome being replaced
+        // rewinds its arena and rebuilds in place
+        auto target = std::make_shared<neat::Network>(makeNeatNet(20));
+        benchmarks.push_back({"neat.assign",
+                              {},
+                              [parent, target](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      *target = *parent;
+                                  }
+                                  bench::keep(*target);
+                              }});
+
+        // Mutation grows the genome, so each op works on a fresh copy
+        // of the same parent, made outside the timed region
+        auto copies = std::make_shared<std::vector<neat::Network>>();
+        benchmarks.push_back({"neat.mutate",
+                              [parent, copies](std::size_t const n) {
+                                  copies->assign(n, *parent);
+                              },
+                              [copies](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      bench::keep((*copies)[i].mutate());
+                                  }
+                              },
+                              2000});
+
+        benchmarks.push_back({"neat.measure_difference",
+                              {},
+                              [parent, other](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      bench::keep(parent->measureDifference(*other));
+                                  }
+                              }});
+
+        benchmarks.push_back({"neat.cross_with",
+                              {},
+                              [parent, other](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      auto child = parent->crossWith(*other);
+                                      bench::keep(child);
+                                  }
+                              }});
+
+        benchmarks.push_back({"neat.get_output",
+                              {},
+                              [parent](std::size_t const n) {
+                                  for (std::size_t i = 0; i < n; ++i) {
+                                      for (int in = 0; in < 4; ++in) {
+                                          parent->setInput(in, 0.1 * (in + i % 5));
+                                      }
+                                      bench::keep(parent->getOutput(0));
+                                  }
+                              }});
+    }
+}
+
+namespace bench {
+
+    std::vector<Benchmark> kernelBenchmarks()
+    {
+        std::vector<Benchmark> benchmarks;
+        addPhysics(benchmarks);
+        addCollisions(benchmarks);
+        addControllers(benchmarks);
+        addNeat(benchmarks);
+        addReconstruct(benchmarks);
+        addTick(benchmarks);
+        return benchmarks;
+    }
+}
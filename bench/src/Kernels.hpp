@@ -0,0 +1,13 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Bench.hpp"
+#include <vector>
+
+namespace bench {
+
+    /// Microbenchmarks of the per-tick physics, controller and
+    /// NEAT kernels, built on fixed inputs
+    std::vector<Benchmark> kernelBenchmarks();
+}
@@ -0,0 +1,101 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "SelfCheck.hpp"
+#include "simulator/CompatibilityMatrix.hpp"
+#include "simulator/Simulation.hpp"
+#include "simulator/WorkerPool.hpp"
+#include <cstdlib>
+
+namespace {
+
+    /// As Population's
+    double const THRESHOLD = 1;
+
+    int const ROUNDS = 20;
+
+    /// Agents whose species, representative or members differ from
+    /// those found by comparing every pair
+    int mismatches(simulator::CompatibilityMatrix const & matrix,
+                   std::vector<simulator::Agent> const & agents)
+    {
+        auto const size = static_cast<int>(agents.size());
+        auto count = 0;
+        for (int i = 0; i < size; ++i) {
+            auto members = 0;
+            auto representative = -1;
+            auto const & genome = agents[i].getNeatNet();
+            for (int j = 0; j < size; ++j) {
+                if (genome.measureDifference(agents[j].getNeatNet()) < THRESHOLD) {
+                    ++members;
+                    if (representative < 0) {
+                        representative = j;
+                    }
+                }
+            }
+            auto visited = 0;
+            auto ordered = true;
+            auto previous = -1;
+            matrix.forEachMember(i, [&](int const j) {
+                ++visited;
+                ordered = ordered && j > previous &&
+                          genome.measureDifference(agents[j].getNeatNet()) < THRESHOLD;
+                previous = j;
+            });
+            if (members != matrix.speciesSize(i) || members != visited || !ordered ||
+                representative != matrix.representative(i)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    int check(int const popSize, int const workers, std::ostream & out)
+    {
+        ::srand(1);
+        simulator::Simulation simulation(popSize, 7);
+        auto & agents = simulation.population().getAgents();
+        simulator::WorkerPool pool(workers);
+        simulator::CompatibilityMatrix matrix(popSize, THRESHOLD);
+        auto total = 0;
+        for (int round = 0; round < ROUNDS; ++round) {
+            // Mostly a few genomes replaced, as in steady-state
+            // evolution; now and then most of them, or a forced rebuild
+            auto changes = ::rand() % 10 + 1;
+            if (round % 5 == 3) {
+                changes = popSize * 3 / 5;
+            } else if (round % 5 == 4) {
+                matrix.invalidateAll();
+            }
+            for (int c = 0; c < changes; ++c) {
+                auto const i = ::rand() % popSize;
+                auto const parent = ::rand() % popSize;
+                if (parent != i && ::rand() % 2) {
+                    agents[i].inheritNeat(agents[parent]);
+                }
+                agents[i].mutateNeat();
+                matrix.invalidate(i);
+            }
+            matrix.update(agents, pool);
+            total += mismatches(matrix, agents);
+        }
+        out << "species matrix, pop " << popSize << ", " << workers << " worker(s): "
+            << total << " mismatches" << std::endl;
+        return total;
+    }
+}
+
+namespace bench {
+
+    int checkCompatibilityMatrix(std::ostream & out)
+    {
+        // The larger population takes the parallel paths of both
+        // incremental updates and rebuilds
+        auto total = 0;
+        for (auto const popSize : {100, 600}) {
+            for (auto const workers : {1, 4}) {
+                total += check(popSize, workers, out);
+            }
+        }
+        return total;
+    }
+}
@@ -0,0 +1,16 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <ostream>
+
+namespace bench {
+
+    /// Evolves a population's genomes at random and, after each
+    /// round, checks simulator::CompatibilityMatrix against comparing
+    /// every pair of genomes directly. Rounds alternate between the
+    /// matrix's incremental row updates and full rebuilds, run both
+    /// on the calling thread and across a worker pool. Reports to out
+    /// and returns the number of mismatched agents.
+    int checkCompatibilityMatrix(std::ostream & out);
+}
@@ -0,0 +1,210 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "Sweep.hpp"
+#include "simulator/Simulation.hpp"
+#include "instrument/Allocations.hpp"
+#include "instrument/Memory.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+    bench::SweepResult runConfig(bench::SweepConfig const & config,
+                                 bench::SweepOptions const & options)
+    {
+        // Leaked: the child exits without tearing the world down
+        auto * simulation = new simulator::Simulation(config.popSize, options.seed);
+        if (config.collisions) {
+            simulation->enableCollisionHandling();
+        } else {
+            simulation->disableCollisionHandling();
+        }
+        if (config.evolution) {
+            simulation->activateEvolution();
+            if (options.generationTicks > 0) {
+                simulation->setGenerational(options.generationTicks);
+            }
+            if (options.prescreen) {
+                simulation->setPrescreen({});
+            }
+        } else {
+            simulation->deactivateEvolution();
+        }
+
+        auto const allocations = instrument::allocationCount();
+        auto const start = std::chrono::steady_clock::now();
+        auto const budget = std::chrono::duration<double>(options.budgetSeconds);
+        long ticks = 0;
+        while (ticks < options.ticks &&
+               std::chrono::steady_clock::now() - start < budget) {
+            simulation->runTicks(1);
+            ++ticks;
+        }
+        auto const seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        bench::SweepResult result;
+        result.config = config;
+        result.ticks = ticks;
+        result.seconds = seconds;
+        result.ticksPerSecond = ticks / seconds;
+        result.agentStepsPerSecond = double(ticks) * config.popSize / seconds;
+        result.allocationsPerTick = double(instrument::allocationCount() - allocations) / ticks;
+        result.peakResidentBytes = instrument::peakResidentBytes();
+        return result;
+    }
+
+    bench::SweepResult failed(bench::SweepConfig const & config)
+    {
+        return {config, 0, 0, 0, 0, 0, 0};
+    }
+
+    bench::SweepResult runInChild(bench::SweepConfig const & config,
+                                  bench::SweepOptions const & options)
+    {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            return failed(config);
+        }
+        auto const pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return failed(config);
+        }
+        if (pid == 0) {
+            ::close(fds[0]);
+            auto const result = runConfig(config, options);
+            auto const written = ::write(fds[1], &result, sizeof(result));
+            ::_exit(written == sizeof(result) ? 0 : 1);
+        }
+
+        ::close(fds[1]);
+        auto result = failed(config);
+        std::size_t got = 0;
+        while (got < sizeof(result)) {
+            auto const n = ::read(fds[0], reinterpret_cast<char *>(&result) + got,
+                                  sizeof(result) - got);
+            if (n <= 0) {
+                break;
+            }
+            got += n;
+        }
+        ::close(fds[0]);
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        if (got != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return failed(config);
+        }
+        return result;
+    }
+
+    char const * onOff(bool const on)
+    {
+        return on ? "on" : "off";
+    }
+}
+
+namespace bench {
+
+    std::vector<SweepConfig> sweepConfigs(SweepOptions const & options)
+    {
+        std::vector<SweepConfig> configs;
+        for (auto const popSize : options.popSizes) {
+            for (auto const collisions : {false, true}) {
+                for (auto const evolution : {false, true}) {
+                    // Generational mode steps agents in isolation so
+                    // refuses to run with collisions on
+                    if (collisions && evolution && options.generationTicks > 0) {
+                        continue;
+                    }
+                    configs.push_back({popSize, collisions, evolution});
+                }
+            }
+        }
+        return configs;
+    }
+
+    std::vector<SweepResult> runSweep(SweepOptions const & options,
+                                      std::ostream & progress)
+    {
+        std::vector<SweepResult> results;
+        for (auto const & config : sweepConfigs(options)) {
+            progress << "pop " << config.popSize
+                     << ", collisions " << onOff(config.collisions)
+                     << ", evolution " << onOff(config.evolution) << "..." << std::flush;
+            results.push_back(runInChild(config, options));
+            auto const & result = results.back();
+            if (result.ticks == 0) {
+                progress << " failed" << std::endl;
+            } else if (result.ticks < options.ticks) {
+                progress << " out of time after " << result.ticks << " ticks" << std::endl;
+            } else {
+                progress << " done" << std::endl;
+            }
+        }
+        return results;
+    }
+
+    void writeSweepTable(std::vector<SweepResult> const & results, std::ostream & out)
+    {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%8s %10s %9s %7s %12s %16s %12s %10s\n",
+                      "pop", "collisions", "evolution", "ticks",
+                      "ticks/s", "agent-steps/s", "allocs/tick", "peak MiB");
+        out << line;
+        for (auto const & result : results) {
+            std::snprintf(line, sizeof(line), "%8d %10s %9s %7ld %12.2f %16.0f %12.1f %10.1f\n",
+                          result.config.popSize,
+                          onOff(result.config.collisions),
+                          onOff(result.config.evolution),
+                          result.ticks,
+                          result.ticksPerSecond,
+                          result.agentStepsPerSecond,
+                          result.allocationsPerTick,
+                          result.peakResidentBytes / (1024.0 * 1024.0));
+            out << line;
+        }
+    }
+
+    void writeSweepJson(std::vector<SweepResult> const & results,
+                        SweepOptions const & options,
+                        std::ostream & out)
+    {
+        char date[32];
+        auto const now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        out << "{\n  \"context\": {\"date\": \"" << date
+            << "\", \"ticks\": " << options.ticks
+            << ", \"seed\": " << options.seed
+            << ", \"generation_ticks\": " << options.generationTicks
+            << ", \"prescreen\": " << (options.prescreen ? "true" : "false")
+            << "},\n  \"sweep\": [";
+        char line[512];
+        for (std::size_t r = 0; r < results.size(); ++r) {
+            auto const & result = results[r];
+            std::snprintf(line, sizeof(line),
+                          "%s\n    {\"pop\": %d, \"collisions\": %s, \"evolution\": %s, "
+                          "\"ticks\": %ld, \"seconds\": %.3f, \"ticks_per_second\": %.3f, "
+                          "\"agent_steps_per_second\": %.1f, \"allocations_per_tick\": %.2f, "
+                          "\"peak_rss_bytes\": %llu}",
+                          r == 0 ? "" : ",",
+                          result.config.popSize,
+                          result.config.collisions ? "true" : "false",
+                          result.config.evolution ? "true" : "false",
+                          result.ticks,
+                          result.seconds,
+                          result.ticksPerSecond,
+                          result.agentStepsPerSecond,
+                          result.allocationsPerTick,
+                          static_cast<unsigned long long>(result.peakResidentBytes));
+            out << line;
+        }
+        out << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,70 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    struct SweepConfig
+    {
+        int popSize;
+        bool collisions;
+        bool evolution;
+    };
+
+    struct SweepOptions
+    {
+        std::vector<int> popSizes{20, 100, 1000, 10000};
+        long ticks = 200;
+
+        /// A configuration that is still running after this long is
+        /// stopped and reported over the ticks it managed
+        double budgetSeconds = 120;
+
+        unsigned seed = 42;
+
+        /// Runs configurations with evolution on in generational mode
+        /// with generations this many ticks long; 0 for steady-state
+        int generationTicks = 0;
+
+        /// Prescreens offspring, with default PrescreenOptions, in
+        /// configurations with evolution on
+        bool prescreen = false;
+    };
+
+    struct SweepResult
+    {
+        SweepConfig config;
+
+        /// Zero if the configuration failed to run at all
+        long ticks;
+        double seconds;
+        double ticksPerSecond;
+        double agentStepsPerSecond;
+        double allocationsPerTick;
+
+        /// Of the process that ran just this configuration,
+        /// including building the population
+        std::uint64_t peakResidentBytes;
+    };
+
+    /// Every population size with collisions off and on and evolution
+    /// off and on; in generational mode, which refuses collisions,
+    /// collisions on is only run with evolution off
+    std::vector<SweepConfig> sweepConfigs(SweepOptions const & options);
+
+    /// Runs each configuration as a headless Simulation in a child
+    /// process of its own, so that peak memory is per configuration
+    /// and no global state leaks from one run into the next.
+    std::vector<SweepResult> runSweep(SweepOptions const & options,
+                                      std::ostream & progress);
+
+    void writeSweepTable(std::vector<SweepResult> const & results, std::ostream & out);
+    void writeSweepJson(std::vector<SweepResult> const & results,
+                        SweepOptions const & options,
+                        std::ostream & out);
+}
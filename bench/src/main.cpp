@@ -0,0 +1,123 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "Bench.hpp"
+#include "Kernels.hpp"
+#include "SelfCheck.hpp"
+#include "Sweep.hpp"
+#include "instrument/AllocationHook.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    void usage()
+    {
+        std::cerr << "usage: simplay_bench [--filter <text>] [--json <file>]"
+                  << " [--samples <n>] [--min-time <ms>]" << std::endl
+                  << "       simplay_bench --sweep [--sizes <n,n,...>] [--ticks <n>]"
+                  << " [--budget <s>] [--seed <n>] [--generation <ticks>]"
+                  << " [--prescreen] [--json <file>]" << std::endl
+                  << "       simplay_bench --check" << std::endl;
+    }
+
+    std::vector<int> parseSizes(std::string const & text)
+    {
+        std::vector<int> sizes;
+        std::istringstream in(text);
+        std::string size;
+        while (std::getline(in, size, ',')) {
+            if (auto const n = std::atoi(size.c_str()); n > 0) {
+                sizes.push_back(n);
+            }
+        }
+        return sizes;
+    }
+
+    bool writeJsonFile(std::string const & path, std::function<void(std::ostream &)> const & write)
+    {
+        std::ofstream json(path);
+        if (!json) {
+            std::cerr << "simplay_bench: couldn't write " << path << std::endl;
+            return false;
+        }
+        write(json);
+        return true;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bench::Options options;
+    bench::SweepOptions sweepOptions;
+    bool sweep = false;
+    bool check = false;
+    std::string jsonPath;
+    for (int a = 1; a < argc; ++a) {
+        auto const hasValue = a + 1 < argc;
+        if (!std::strcmp(argv[a], "--sweep")) {
+            sweep = true;
+        } else if (!std::strcmp(argv[a], "--check")) {
+            check = true;
+        } else if (!std::strcmp(argv[a], "--sizes") && hasValue) {
+            sweepOptions.popSizes = parseSizes(argv[++a]);
+        } else if (!std::strcmp(argv[a], "--ticks") && hasValue) {
+            sweepOptions.ticks = std::max(1, std::atoi(argv[++a]));
+        } else if (!std::strcmp(argv[a], "--budget") && hasValue) {
+            sweepOptions.budgetSeconds = std::max(1.0, std::atof(argv[++a]));
+        } else if (!std::strcmp(argv[a], "--seed") && hasValue) {
+            sweepOptions.seed = std::max(1, std::atoi(argv[++a]));
+        } else if (!std::strcmp(argv[a], "--generation") && hasValue) {
+            sweepOptions.generationTicks = std::max(0, std::atoi(argv[++a]));
+        } else if (!std::strcmp(argv[a], "--prescreen")) {
+            sweepOptions.prescreen = true;
+        } else if (!std::strcmp(argv[a], "--filter") && hasValue) {
+            options.filter = argv[++a];
+        } else if (!std::strcmp(argv[a], "--json") && hasValue) {
+            jsonPath = argv[++a];
+        } else if (!std::strcmp(argv[a], "--samples") && hasValue) {
+            options.samples = std::max(1, std::atoi(argv[++a]));
+        } else if (!std::strcmp(argv[a], "--min-time") && hasValue) {
+            options.sampleMilliseconds = std::max(1.0, std::atof(argv[++a]));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (check) {
+        return bench::checkCompatibilityMatrix(std::cout) == 0 ? 0 : 1;
+    }
+
+    if (sweep) {
+        auto const results = bench::runSweep(sweepOptions, std::cerr);
+        bench::writeSweepTable(results, std::cout);
+        if (!jsonPath.empty() &&
+            !writeJsonFile(jsonPath, [&](std::ostream & out) {
+                bench::writeSweepJson(results, sweepOptions, out);
+            })) {
+            return 1;
+        }
+        return 0;
+    }
+
+    // Fixed seed so that the genomes under test are comparable run to
+    // run (neat also draws from its own random_device-seeded engine)
+    ::srand(42);
+
+    auto const results = bench::runAll(bench::kernelBenchmarks(), options, std::cerr);
+    bench::writeTable(results, std::cout);
+
+    if (!jsonPath.empty() &&
+        !writeJsonFile(jsonPath, [&](std::ostream & out) {
+            bench::writeJson(results, out);
+        })) {
+        return 1;
+    }
+    return 0;
+}
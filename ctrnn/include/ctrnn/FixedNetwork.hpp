@@ -0,0 +1,152 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * A compile-time sized variant of ctrnn::Network. Animats have
+ * 5 to 12 body blocks (5 to 8 as built by AnimatWorld, up to 12
+ * through evolving segment counts), which means networks of 20 to 48
+ * neurons. For those sizes, neuron state and the weight matrix live
+ * in flat std::arrays and the update loops are unrolled at compile
+ * time.
+ *
+ * Integration is kept identical to ctrnn::Network: neurons are
+ * updated in index order and each one reads the 'old' activation of
+ * the others, some of which will already have been updated this step.
+ */
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace ctrnn {
+
+    template <int N>
+    class FixedNetwork
+    {
+        static_assert(N > 0, "FixedNetwork: neuron count must be positive");
+
+      public:
+
+        /// nCount is taken for parity with ctrnn::Network
+        /// and must match the compile-time neuron count
+        FixedNetwork(int const nCount, double const neuronTC)
+        {
+            if (nCount != N) {
+                throw std::runtime_error("FixedNetwork: neuron count mismatch");
+            }
+            m_tau.fill(neuronTC);
+            m_membranePotential.fill(0);
+            m_activation.fill(0);
+            m_oldActivation.fill(0);
+            m_externalInput.fill(0);
+            for (auto & row : m_weights) {
+                row.fill(0);
+            }
+        }
+
+        static constexpr int size() { return N; }
+
+        /// Zeros out the network state (weights and
+        /// time constants are left intact), as
+        /// ctrnn::Network::resetState
+        void resetState()
+        {
+            m_membranePotential.fill(0);
+            m_activation.fill(0);
+            m_oldActivation.fill(0);
+            m_externalInput.fill(0);
+        }
+
+        double getNeuronMembranePotential(int const n) const
+        {
+            return m_membranePotential[n];
+        }
+
+        double getNeuronActivation(int const n) const
+        {
+            return m_activation[n];
+        }
+
+        double getNeuronSigmoid(int const n) const
+        {
+            return 1.0 / (1.0 + ::exp(-m_membranePotential[n]));
+        }
+
+        /// Connection from pre-neuron i to post-neuron j
+        void connect(int const i, int const j, double const w)
+        {
+            m_weights[j][i] = w;
+        }
+
+        void setWeight(int const i, int const j, double const w)
+        {
+            m_weights[j][i] = w;
+        }
+
+        void setTimeConstantForNeuron(int const n, double const tau)
+        {
+            m_tau[n] = tau;
+        }
+
+        /// Sets the input current for a given neuron
+        void setExternalInput(int const n, double const a)
+        {
+            m_externalInput[n] = a;
+        }
+
+        /// Zero out all network input currents
+        void zeroInputCurrents()
+        {
+            m_externalInput.fill(0);
+        }
+
+        void zeroInputCurrent(int const n)
+        {
+            m_externalInput[n] = 0;
+        }
+
+        /// Perform a single integration step
+        void update()
+        {
+            updateNeurons(std::make_integer_sequence<int, N>());
+        }
+
+      private:
+
+        /// Neuron state, stored as structure-of-arrays
+        std::array<double, N> m_membranePotential;
+        std::array<double, N> m_tau;
+        std::array<double, N> m_activation;
+        std::array<double, N> m_oldActivation;
+        std::array<double, N> m_externalInput;
+
+        /// Row n holds the weights of all connections going into neuron n
+        std::array<std::array<double, N>, N> m_weights;
+
+        template <int... I>
+        double incomingCurrent(std::array<double, N> const & row,
+                               std::integer_sequence<int, I...>) const
+        {
+            return (... + (row[I] * m_oldActivation[I]));
+        }
+
+        template <int n>
+        void updateNeuron()
+        {
+            auto const inner = incomingCurrent(m_weights[n],
+                                               std::make_integer_sequence<int, N>());
+            auto & u = m_membranePotential[n];
+            u += (inner + m_externalInput[n] - u) / m_tau[n];
+            m_oldActivation[n] = m_activation[n];
+            m_activation[n] = ::tanh(u);
+        }
+
+        template <int... I>
+        void updateNeurons(std::integer_sequence<int, I...>)
+        {
+            (updateNeuron<I>(), ...);
+        }
+    };
+}
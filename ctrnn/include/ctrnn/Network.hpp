@@ -29,6 +29,10 @@ namespace ctrnn {
         /// Zeros out the network
         void reset();
 
+        /// Zeros out neuron state only, leaving the connections,
+        /// time constants and neurons themselves in place
+        void resetState();
+
         double getNeuronMembranePotential(int const n) const;
 
         double getNeuronActivation(int const n) const;
@@ -22,6 +22,13 @@ namespace ctrnn {
         m_neurons.clear();
     }
 
+    void Network::resetState()
+    {
+        std::for_each(std::begin(m_neurons), 
+                      std::end(m_neurons), 
+                      [](Neuron & n) { n.reset(); });
+    }
+
     double Network::getNeuronMembranePotential(int const n) const
     {
         if (n >= m_neurons.size()) {
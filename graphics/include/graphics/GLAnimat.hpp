@@ -3,25 +3,48 @@
 #pragma once
 
 #include "Color.hpp"
-#include "ThreadRunner.hpp"
+#include "GLBatchRenderer.hpp"
+#include "GLTextLayer.hpp"
+#include "Scheduler.hpp"
+#include "ViewCuller.hpp"
 #include "model/Animat.hpp"
+#include "model/WorldSnapshot.hpp"
 #include <atomic>
 #include <memory>
+#include <string>
 
 namespace graphics {
 
     struct GLAnimat
     {
         GLAnimat(std::shared_ptr<model::Animat> animat,
-                 detail::ThreadRunner & threadRunner);
+                 Scheduler & scheduler);
 
         GLAnimat() = delete;
 
-        void draw();
+        /// Adds body, antennae and bounding circles to the frame's batch,
+        /// including the big highlight circle if highlighted or selected.
+        /// Geometry comes from the animat's entry in the snapshot, never
+        /// from the live physics. Below LevelOfDetail::Full, only a
+        /// dot, a line or the bare body is added.
+        void batch(GLBatchRenderer & renderer,
+                   model::WorldSnapshot const & snapshot,
+                   int const index,
+                   LevelOfDetail const lod = LevelOfDetail::Full);
+
+        /// Adds the ID text, if highlighted but not selected and drawn
+        /// at LevelOfDetail::Body or more. Must be called while the
+        /// world scene is set, to find where the animat is on screen.
+        void addHighlightText(GLTextLayer & text,
+                              model::WorldSnapshot const & snapshot,
+                              int const index,
+                              LevelOfDetail const lod = LevelOfDetail::Full);
 
         bool handleSelection();
 
-        void checkForHighlight(double x, 
+        void checkForHighlight(model::WorldSnapshot const & snapshot,
+                               int const index,
+                               double x, 
                                double y,
                                double const viewDistance,
                                double const centerX,
@@ -29,8 +52,6 @@ namespace graphics {
 
         std::shared_ptr<model::Animat> animatRef();
 
-        void updateAnimat(std::shared_ptr<model::Animat> animat);
-
         void track();
         void untrack();
         bool isTracked() const;
@@ -43,8 +64,8 @@ namespace graphics {
 
         std::shared_ptr<model::Animat> m_animat;
 
-        /// Threads the fade-in or fade-out process
-        detail::ThreadRunner & m_threadRunner;
+        /// Runs the fade-in or fade-out animation
+        Scheduler & m_scheduler;
 
         Color m_basicColor { 87, 89, 92 };
         Color m_segmentColor { 197, 217, 200 };
@@ -70,14 +91,39 @@ namespace graphics {
         /// Controls if antennae should be drawn
         bool m_drawAntennae;
 
-        void drawBody();
-        void drawAntennae();
-        void drawBoundingCircles();
-        void drawBigBoundingCircle();
-        void showPopNumber(std::pair<physics::Vector3, double> const & point);
+        void batchDot(GLBatchRenderer & renderer,
+                      model::WorldSnapshot const & snapshot,
+                      int const index);
+        void batchLine(GLBatchRenderer & renderer,
+                       model::WorldSnapshot const & snapshot,
+                       int const index);
+        void batchBody(GLBatchRenderer & renderer,
+                       model::WorldSnapshot const & snapshot,
+                       int const index);
+        void batchAntennae(GLBatchRenderer & renderer,
+                           model::WorldSnapshot const & snapshot,
+                           int const index);
+        void batchBoundingCircles(GLBatchRenderer & renderer,
+                                  model::WorldSnapshot const & snapshot,
+                                  int const index);
+        void batchBigBoundingCircle(GLBatchRenderer & renderer,
+                                    model::WorldSnapshot const & snapshot,
+                                    int const index);
+
+        /// The ID text, rebuilt only when the snapshot's ID changes
+        std::string m_label;
+        int m_labelID;
+
+        void showPopNumber(GLTextLayer & text,
+                           model::WorldSnapshot const & snapshot,
+                           int const index);
+
+        /// The fade currently running, if any
+        Scheduler::TaskId m_fade;
 
         /// fade in text
         void fadeIn();
         void fadeOut();
+        void fadeTo(double const target);
     };
 }
\ No newline at end of file
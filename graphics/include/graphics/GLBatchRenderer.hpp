@@ -0,0 +1,89 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Color.hpp"
+#include "GLCircleRenderer.hpp"
+#include <OpenGL/gl.h>
+#include <vector>
+
+namespace graphics {
+
+    /// Collects the geometry of a whole frame (filled quads, filled
+    /// circles and lines of a few widths) into client-side arrays
+    /// and draws it from a single streamed vertex buffer with one
+    /// draw call per primitive type and line width, instead of a
+    /// glBegin/glEnd pair per shape. Batches are drawn in the order
+    /// they were first added to, so layering follows the order in
+    /// which a single animat adds its shapes.
+    class GLBatchRenderer
+    {
+      public:
+        GLBatchRenderer();
+        GLBatchRenderer(GLBatchRenderer const &) = delete;
+        GLBatchRenderer & operator=(GLBatchRenderer const &) = delete;
+        ~GLBatchRenderer();
+
+        /// Starts a new frame. Capacity from earlier
+        /// frames is kept so steady-state frames don't allocate.
+        void begin();
+
+        /// Corners in winding order
+        void addQuad(float const x0, float const y0,
+                     float const x1, float const y1,
+                     float const x2, float const y2,
+                     float const x3, float const y3,
+                     Color const & color);
+
+        void addLine(float const x0, float const y0,
+                     float const x1, float const y1,
+                     Color const & color,
+                     float const width = 1.0);
+
+        /// Square point, size in pixels
+        void addPoint(float const x, float const y,
+                      Color const & color,
+                      float const size = 1.0);
+
+        /// Circle outline or filled disc. Circles are drawn as
+        /// instances after, and so on top of, everything else.
+        void addCircle(float const cx, float const cy, float const r,
+                       int const segments,
+                       Color const & color,
+                       bool const filled = false,
+                       float const width = 1.0);
+
+        /// Uploads and draws everything added since begin
+        void draw();
+
+      private:
+        struct Vertex
+        {
+            GLfloat x;
+            GLfloat y;
+            GLubyte rgba[4];
+        };
+
+        /// Everything drawn with one primitive type and line width
+        /// (or point size)
+        struct Batch
+        {
+            GLenum mode;
+            float width;
+            std::vector<Vertex> vertices;
+        };
+
+        /// Only a handful are ever used
+        std::vector<Batch> m_batches;
+
+        /// Everything concatenated for upload
+        std::vector<Vertex> m_upload;
+
+        GLCircleRenderer m_circles;
+
+        GLuint m_buffer;
+
+        std::vector<Vertex> & batch(GLenum const mode, float const width = 1.0);
+        static Vertex vertex(float const x, float const y, Color const & color);
+    };
+}
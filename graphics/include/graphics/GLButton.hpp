@@ -4,7 +4,7 @@
 
 #include "GLGUIElement.hpp"
 #include "Color.hpp"
-#include "ThreadRunner.hpp"
+#include "Scheduler.hpp"
 #include <OpenGL/gl.h>
 #include <GLFW/glfw3.h>
 #include <atomic>
@@ -20,7 +20,7 @@ namespace graphics {
                  int yLocation,
                  int width,
                  int height,
-                 detail::ThreadRunner & threadRunner);
+                 Scheduler & scheduler);
         GLButton() = delete;
 
         void draw() override;
@@ -51,8 +51,8 @@ namespace graphics {
         int m_derivedY;
         int m_windowHeight;
 
-        /// Threads the fade-in or fade-out process
-        detail::ThreadRunner & m_threadRunner;
+        /// Runs the fade-in or fade-out animation
+        Scheduler & m_scheduler;
 
         /// Button width and height
         int m_width;
@@ -75,5 +75,11 @@ namespace graphics {
 
         // Default colour
         Color m_buttonColor { 155, 155, 155 };
+
+        /// The fade currently running, if any
+        Scheduler::TaskId m_fade;
+
+        /// Animates the opacity from where it is now to target
+        void fadeTo(double const target);
     };
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Color.hpp"
+#include <OpenGL/gl.h>
+#include <vector>
+
+namespace graphics {
+
+    /// Draws many circles from one unit-circle mesh per segment count,
+    /// uploaded once. Each circle is an instance with its own centre,
+    /// radius and colour; all circles sharing a segment count, fill
+    /// mode and line width are drawn with one instanced call. Circles
+    /// are drawn in the current modelview/projection, so they work in
+    /// world space and in translated GUI space alike. Without shader
+    /// support it falls back to transforming the shared mesh per circle.
+    class GLCircleRenderer
+    {
+      public:
+        GLCircleRenderer();
+        GLCircleRenderer(GLCircleRenderer const &) = delete;
+        GLCircleRenderer & operator=(GLCircleRenderer const &) = delete;
+        ~GLCircleRenderer();
+
+        /// Clears queued circles, keeping capacity
+        void begin();
+
+        void addCircle(float const cx, float const cy, float const r,
+                       Color const & color,
+                       double const opacity = 1.0,
+                       int const segments = 20,
+                       bool const filled = false,
+                       float const width = 1.0);
+
+        /// Draws everything queued since begin. Groups are drawn
+        /// in the order they were first added to.
+        void draw();
+
+      private:
+        struct Instance
+        {
+            GLfloat cx;
+            GLfloat cy;
+            GLfloat r;
+            GLubyte rgba[4];
+        };
+
+        struct Group
+        {
+            int segments;
+            bool filled;
+            float width;
+            std::vector<Instance> instances;
+        };
+
+        /// Offsets into m_meshBuffer of one segment count's mesh: an
+        /// outline loop followed by a fan (centre, then the loop closed)
+        struct Mesh
+        {
+            int segments;
+            GLint loopFirst;
+            GLint fanFirst;
+        };
+
+        std::vector<Group> m_groups;
+        std::vector<Mesh> m_meshes;
+
+        /// Unit circle vertices for every mesh; grows
+        /// (and is re-uploaded) only for new segment counts
+        std::vector<GLfloat> m_meshVertices;
+        bool m_meshDirty;
+        GLuint m_meshBuffer;
+        GLuint m_instanceBuffer;
+
+        /// 0 until the first draw; -1 if shaders are unavailable
+        GLint m_program;
+        GLint m_unitAttribute;
+        GLint m_circleAttribute;
+        GLint m_colorAttribute;
+
+        Mesh const & mesh(int const segments);
+        void initProgram();
+        void drawInstanced(Group const & group, Mesh const & m);
+        void drawFallback(Group const & group, Mesh const & m);
+    };
+
+    namespace detail {
+
+        /// cos and sin of segments evenly spaced angles, computed once
+        /// per segment count. Returns interleaved (cos, sin) pairs.
+        std::vector<float> const & unitCircle(int const segments);
+    }
+}
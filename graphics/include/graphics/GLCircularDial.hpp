@@ -4,7 +4,8 @@
 
 #include "GLGUIElement.hpp"
 #include "Color.hpp"
-#include "ThreadRunner.hpp"
+#include "GLCircleRenderer.hpp"
+#include "Scheduler.hpp"
 #include <OpenGL/gl.h>
 #include <GLFW/glfw3.h>
 #include <atomic>
@@ -22,7 +23,7 @@ namespace graphics {
                        int yLocation,
                        double radius,
                        int const startLevel,
-                       detail::ThreadRunner & threadRunner);
+                       Scheduler & scheduler);
         GLCircularDial() = delete;
 
         void draw() override;
@@ -47,8 +48,8 @@ namespace graphics {
         int m_derivedY;
         int m_windowHeight;
 
-        /// Threads the fade-in or fade-out process
-        detail::ThreadRunner & m_threadRunner;
+        /// Runs the fade-in or fade-out animation
+        Scheduler & m_scheduler;
 
         /// Button width and height
         double m_radius;
@@ -71,6 +72,8 @@ namespace graphics {
         /// Callback to call on m_level change
         std::function<void(int const value)> m_handler;
 
+        GLCircleRenderer m_circles;
+
         // Default colour
         Color m_buttonColor { 155, 155, 155 };
 
@@ -79,6 +82,12 @@ namespace graphics {
 
         /// fade out the button on pointer exit
         void fadeOut();
+
+        /// The fade currently running, if any
+        Scheduler::TaskId m_fade;
+
+        /// Animates the opacity from where it is now to target
+        void fadeTo(double const target);
     };
 
 
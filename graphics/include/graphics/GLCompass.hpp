@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Color.hpp"
+#include "GLCircleRenderer.hpp"
 #include "RetinaScalar.hpp"
 #include "SetScene.hpp"
 #include <OpenGL/gl.h>
@@ -22,6 +23,7 @@ namespace graphics {
           , m_windowHeight(windowHeight)
           , m_viewDistance(viewDistance)
           , m_angle(angle)
+          , m_circles()
         {
         }
         GLCompass() = delete;
@@ -36,14 +38,9 @@ namespace graphics {
             auto const rad = 50.0;
 
             // Draw outer compass circle
-            detail::setColor(m_compassOutline, 0.3 /* opacity */);
-            detail::lineWidth(3.0);
-            glBegin(GL_LINE_LOOP);
-                for (double angle = 0; angle < 3.1415926f * 2; angle += 0.25) {
-                    glVertex2f(::sin(angle) * rad, ::cos(angle) * rad);
-                }
-            glEnd();
-            detail::lineWidth(1.0);
+            m_circles.begin();
+            m_circles.addCircle(0, 0, rad, m_compassOutline, 0.3 /* opacity */, 25, false, 3.0);
+            m_circles.draw();
 
             // Draw blue 'north' part of pointer
             detail::setColor(m_pointerUp, 0.3 /* opacity */);
@@ -88,6 +85,7 @@ namespace graphics {
         Color m_pointerDown { 255, 255, 255};
         Color m_pointerOutline { 0, 0, 0 };
         Color m_compassOutline { 100, 100, 100 };
+        GLCircleRenderer m_circles;
     };
 
 
@@ -7,8 +7,8 @@
 
 #pragma once
 
+#include "GLTextLayer.hpp"
 #include "RetinaScalar.hpp"
-#include "glfreetype/TextRenderer.hpp"
 #include <OpenGL/gl.h>
 #include <OpenGL/glu.h>
 #include <GLFW/glfw3.h>
@@ -70,15 +70,13 @@ namespace glconsole {
                 glVertex2f(m_x - m_width, m_y + m_height);
             glEnd();
 
-            // Green text
-            glPushMatrix();
-            glLoadIdentity();
-            glColor4f(0, 0xff, 0, m_opacity);
-            std::stringstream ss;
+            // Green text. The layout is cached, so it's
+            // only redone when the buffer changes.
             // Offset from bottom of screen
             auto const ypos = (m_windowHeight * graphics::detail::retinaScalar() - (m_height / 2));
-            glfreetype::print(m_font, m_x, ypos, m_buffer.str());
-            glPopMatrix();
+            m_font.begin();
+            m_font.add(m_x, ypos, m_buffer.str(), {0, 255, 0}, m_opacity);
+            m_font.draw();
         }
 
         void setCallback(std::function<void(std::string)> callback)
@@ -196,7 +194,7 @@ namespace glconsole {
         int m_y;
 
         /// Stores information related to the font
-        glfreetype::font_data m_font;
+        graphics::GLTextLayer m_font;
 
         /// Stores text typed so far
         std::stringstream m_buffer;
@@ -6,22 +6,24 @@
 #include "GLAnimat.hpp"
 #include "GLCompass.hpp"
 #include "GLAxis.hpp"
+#include "GLBatchRenderer.hpp"
 #include "GLButton.hpp"
+#include "GLTextLayer.hpp"
 #include "RetinaScalar.hpp"
 #include "SetScene.hpp"
+#include "ViewCuller.hpp"
 #include "WorldToScreen.hpp"
-#include "ThreadRunner.hpp"
+#include "Scheduler.hpp"
 
 #include "model/AnimatWorld.hpp"
-#include "glfreetype/TextRenderer.hpp"
 
 #include <OpenGL/gl.h>
+#include <algorithm>
 #include <vector>
 #include <atomic>
 #include <chrono>
 #include <functional>
-#include <sstream>
-#include <unistd.h>
+#include <string>
 
 namespace graphics {
 
@@ -39,37 +41,38 @@ namespace graphics {
                       int & windowHeight,
                       double & viewDistance,
                       model::AnimatWorld & animatWorld,
-                      detail::ThreadRunner & threadRunner)
+                      Scheduler & scheduler)
         : m_windowWidth(windowWidth)
         , m_windowHeight(windowHeight)
         , m_animatWorld(animatWorld)
-        , m_threadRunner(threadRunner)
+        , m_scheduler(scheduler)
         , m_viewDistance(viewDistance)
         , m_worldOrientation(0)
         , m_centerX(0)
         , m_centerY(0)
         , m_oldFlyXDiv(0)
         , m_oldFlyYDiv(0)
+        , m_compass(m_windowWidth, m_windowHeight, m_viewDistance, m_worldOrientation)
         , m_selected(-1)
         , m_selectedOrig(-1)
         , m_generationText()
+        , m_generationShown(0)
+        , m_generationString()
+        , m_animatText()
         , m_trackCounter(0)
+        , m_flyAnimation(0)
         {
+            m_animatWorld.attachRenderer();
             auto const popSize = m_animatWorld.getPopSize();
             m_glAnimats.reserve(popSize);
             for (int p = 0; p < popSize; ++p) {
                 m_glAnimats.emplace_back(m_animatWorld.animat(p),
-                                         m_threadRunner);
+                                         m_scheduler);
             }
             m_generationText.init("../fonts/digital-7.ttf", 
                                    25 * detail::retinaScalar());
-        }
-
-        void updateAnimat(int const index,
-                          std::shared_ptr<model::Animat> animat)
-        {
-            std::lock_guard<std::mutex> lg(m_mutex);
-            m_glAnimats[index].updateAnimat(std::move(animat));
+            m_animatText.init("../fonts/Action_Man.ttf",
+                              25 * detail::retinaScalar());
         }
 
         void draw()
@@ -87,27 +90,50 @@ namespace graphics {
                              m_centerX,
                              m_centerY);
             {
+                // Draws whatever the sim most recently published; if
+                // nothing new has arrived, the previous frame is redrawn
+                m_animatWorld.snapshots().consume();
+                auto const & snapshot = m_animatWorld.snapshots().front();
+                auto const count = std::min<int>(snapshot.animatCount(), m_glAnimats.size());
+
+                // Skip what's off screen and simplify what's tiny
+                detail::ViewCuller const culler(m_windowWidth,
+                                                m_windowHeight,
+                                                m_viewDistance,
+                                                m_worldOrientation,
+                                                m_centerX,
+                                                m_centerY);
+                m_levels.resize(count);
+                for (int p = 0; p < count; ++p) {
+                    auto const * central = &snapshot.centralCircles[3 * p];
+                    m_levels[p] = culler.levelOfDetail(central[0], central[1], central[2]);
+                }
+
                 std::lock_guard<std::mutex> lg(m_mutex);
-                for (int p = 0; p < m_animatWorld.getPopSize(); ++p) {
-                    m_glAnimats[p].draw();
+                m_batch.begin();
+                for (int p = 0; p < count; ++p) {
+                    m_glAnimats[p].batch(m_batch, snapshot, p, m_levels[p]);
+                }
+                m_batch.draw();
+                m_animatText.begin();
+                for (int p = 0; p < count; ++p) {
+                    m_glAnimats[p].addHighlightText(m_animatText, snapshot, p, m_levels[p]);
                 }
+                m_animatText.draw();
             }
 
-            graphics::GLCompass(m_windowWidth, 
-                                m_windowHeight,
-                                m_viewDistance,
-                                m_worldOrientation).draw();
+            m_compass.draw();
             
-            glPushMatrix();
-            glLoadIdentity();
-            // Blue texts
-            glColor4f(0.5, 0.5, 0.9, 0.9);
-            auto realWidth = m_windowWidth * detail::retinaScalar();
-            std::stringstream ss;
-            ss << "GEN " << m_animatWorld.getOptimizationCount();
-            glfreetype::print(m_generationText, 200, 
-                              35 * detail::retinaScalar(), ss.str());
-            glPopMatrix();
+            // Blue texts; only re-formatted when the generation changes
+            auto const generation = m_animatWorld.getOptimizationCount();
+            if (generation != m_generationShown || m_generationString.empty()) {
+                m_generationShown = generation;
+                m_generationString = "GEN " + std::to_string(generation);
+            }
+            m_generationText.begin();
+            m_generationText.add(200, 35 * detail::retinaScalar(), m_generationString,
+                                 {127.5, 127.5, 229.5}, 0.9);
+            m_generationText.draw();
         }
 
         std::atomic<double> & getWorldOrientation()
@@ -137,11 +163,14 @@ namespace graphics {
 
         void checkForAnimatHighlight(double const x, double const y)
         {
+            auto const & snapshot = m_animatWorld.snapshots().front();
+            auto const count = std::min<int>(snapshot.animatCount(), m_glAnimats.size());
             std::lock_guard<std::mutex> lg(m_mutex);
-            for (auto & glAnimat : m_glAnimats) {
-                glAnimat.checkForHighlight(x, m_windowHeight - y, 
-                                           m_viewDistance, 
-                                           m_centerX, m_centerY);
+            for (int p = 0; p < count; ++p) {
+                m_glAnimats[p].checkForHighlight(snapshot, p,
+                                                 x, m_windowHeight - y, 
+                                                 m_viewDistance, 
+                                                 m_centerX, m_centerY);
             }
         }
 
@@ -264,7 +293,7 @@ namespace graphics {
         int & m_windowWidth;
         int & m_windowHeight;
         model::AnimatWorld & m_animatWorld;
-        detail::ThreadRunner & m_threadRunner;
+        Scheduler & m_scheduler;
 
         /// Index of the currently selected animat
         std::atomic<int> m_selected;
@@ -279,6 +308,15 @@ namespace graphics {
         double m_oldFlyYDiv;
         double m_oldZoomIt;
         std::vector<graphics::GLAnimat> m_glAnimats;
+
+        /// All animats are drawn through this each frame
+        GLBatchRenderer m_batch;
+
+        /// Per-animat level of detail for the current frame
+        std::vector<LevelOfDetail> m_levels;
+
+        /// Kept across frames so its circle mesh is only uploaded once
+        GLCompass m_compass;
         Color m_backGoundColour { 209, 220, 235};
         std::atomic<bool> m_displayAxis{true};
         std::atomic<bool> m_displayCompass{false};
@@ -286,7 +324,12 @@ namespace graphics {
         std::mutex m_mutex;
 
         // Display current generation
-        glfreetype::font_data m_generationText;
+        GLTextLayer m_generationText;
+        long m_generationShown;
+        std::string m_generationString;
+
+        // Animat ID labels
+        GLTextLayer m_animatText;
 
         // Tiggered when view distance is updated so that components
         // relying on this value (e.g. the vertical slider)
@@ -295,14 +338,14 @@ namespace graphics {
 
         long long m_trackCounter;
 
+        /// The fly in or out currently animating, if any
+        Scheduler::TaskId m_flyAnimation;
+
         FlyInfo doFlyIn()
         {
-            auto & flAnimat = m_glAnimats[m_selected];
-            auto animat = flAnimat.animatRef();
-            auto centralPoint = animat->getCentralPoint();
-            auto & pos = centralPoint.first;
-            auto cx = pos.m_vec[0];
-            auto cy = pos.m_vec[1];
+            auto const & snapshot = m_animatWorld.snapshots().front();
+            double cx = snapshot.centralCircles[3 * m_selected];
+            double cy = snapshot.centralCircles[3 * m_selected + 1];
             double sx, sy;
 
             detail::worldToScreen(cx, cy, sx, sy);
@@ -345,13 +388,13 @@ namespace graphics {
             m_centerY.store(valY);
         }
 
-        void moveWorldForTracking(double centerDivX, 
-                                  double centerDivY,
-                                  double const fx,
-                                  double const fy)
+        /// Moves the world centre one step of size centerDiv
+        /// towards fx, fy, remembering the step so a fly out can undo it
+        void flyStep(double const centerDivX,
+                     double const centerDivY,
+                     double const fx,
+                     double const fy)
         {
-            centerDivX *= 10;
-            centerDivY *= 10;
             auto valX = m_centerX.load();
 
             if (valX < fx - centerDivX) {
@@ -374,6 +417,35 @@ namespace graphics {
             update(valX, valY);
         }
 
+        void moveWorldForTracking(double const centerDivX, 
+                                  double const centerDivY,
+                                  double const fx,
+                                  double const fy)
+        {
+            flyStep(centerDivX * 10, centerDivY * 10, fx, fy);
+        }
+
+        /// Runs the ten steps of a fly in or out over 100ms of frame
+        /// time, taking as many steps each frame as are due. Starting
+        /// a new fly stops one still in progress.
+        void animateFly(std::function<void()> step)
+        {
+            m_scheduler.cancel(m_flyAnimation);
+            m_flyAnimation = m_scheduler.animate(std::chrono::milliseconds(100),
+                                                 [this, step, done = 0](double const progress) mutable {
+                auto const due = static_cast<int>(progress * 10);
+                if (done == due) {
+                    return;
+                }
+                for (; done < due; ++done) {
+                    step();
+                }
+                if(m_zoomTrigger) {
+                    m_zoomTrigger();
+                }
+            });
+        }
+
         void processFlyIn(double const centerDivX, 
                           double const centerDivY,
                           double const fx,
@@ -389,75 +461,25 @@ namespace graphics {
                 m_oldZoomIt = (0.4 - 0.15) / 10.0;
             }
 
-            std::function<void()> func([=]() {
-                auto zoomVal = m_viewDistance;
-                for(int i = 0; i < 10; ++i) {
-                    auto valX = m_centerX.load();
-
-                    if (valX < fx - centerDivX) {
-                        valX += centerDivX;
-                        m_oldFlyXDiv += centerDivX;
-                    } else if (valX > fx + centerDivX) {
-                        valX -= centerDivX;
-                        m_oldFlyXDiv -= centerDivX;
-                    }
-
-                    auto valY = m_centerY.load();
-                    if (valY > fy - centerDivY) {
-                        valY += centerDivY;
-                        m_oldFlyYDiv += centerDivY;
-                    } else if (valY < fy + centerDivY) {
-                        valY -= centerDivY;
-                        m_oldFlyYDiv -= centerDivY;
-                    }
-
-                    update(valX, valY);
-
-                    if(zoom) {
-                        zoomVal -= m_oldZoomIt;
-                        m_viewDistance = zoomVal;
-
-                        if(m_zoomTrigger) {
-                            m_zoomTrigger();
-                        }
-                    }
-
-                    usleep(10000);
+            animateFly([=]() {
+                flyStep(centerDivX, centerDivY, fx, fy);
+                if(zoom) {
+                    m_viewDistance -= m_oldZoomIt;
                 }
             });
-
-            m_threadRunner.add(func);
         }
 
         void processFlyOut(bool zoom = true)
         {
             m_oldFlyYDiv /= 10;
             m_oldFlyXDiv /= 10;
-            std::function<void()> func([=]() {
-                auto zoomVal = m_viewDistance;
-                for(int i = 0; i < 10; ++i) {
-                    auto valX = m_centerX.load();
-                    valX -= m_oldFlyXDiv;
-
-                    auto valY = m_centerY.load();
-                    valY -= m_oldFlyYDiv;
-
-                    update(valX, valY);
-
-                    if(zoom) {
-                        zoomVal += m_oldZoomIt;
-                        m_viewDistance = zoomVal;
-
-                        if(m_zoomTrigger) {
-                            m_zoomTrigger();
-                        }
-                    }
-
-                    usleep(10000);
+            animateFly([=]() {
+                update(m_centerX.load() - m_oldFlyXDiv,
+                       m_centerY.load() - m_oldFlyYDiv);
+                if(zoom) {
+                    m_viewDistance += m_oldZoomIt;
                 }
             });
-
-            m_threadRunner.add(func);
         }
     };
 }
\ No newline at end of file
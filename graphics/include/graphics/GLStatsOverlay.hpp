@@ -0,0 +1,58 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "GLTextLayer.hpp"
+#include "Scheduler.hpp"
+#include "instrument/PerformanceSummary.hpp"
+#include "instrument/Snapshot.hpp"
+#include "model/TripleBuffer.hpp"
+#include <atomic>
+#include <string>
+
+namespace graphics {
+
+    /// Live performance numbers in the top left of the window. Twice a
+    /// second the scheduler's worker takes an instrument snapshot,
+    /// works out the numbers since the previous one and publishes them
+    /// through a triple buffer, so the render thread only ever picks up
+    /// a finished summary and never waits on the sampling.
+    class GLStatsOverlay
+    {
+      public:
+        explicit GLStatsOverlay(Scheduler & scheduler);
+        GLStatsOverlay(GLStatsOverlay const &) = delete;
+        GLStatsOverlay & operator=(GLStatsOverlay const &) = delete;
+
+        /// Stops sampling. The scheduler must not be running a sample
+        /// at the time, i.e. it should already have been shut down.
+        ~GLStatsOverlay();
+
+        void show();
+        void hide();
+
+        /// The most recent summary. Render thread only.
+        instrument::PerformanceSummary const & latest();
+
+        /// Draws the numbers if shown. Render thread only.
+        void draw(int const windowHeight);
+
+      private:
+        Scheduler & m_scheduler;
+        Scheduler::TaskId m_sampling;
+
+        /// Only touched by the scheduler's worker
+        instrument::Snapshot m_previous;
+
+        model::TripleBuffer<instrument::PerformanceSummary> m_summaries;
+        std::atomic<bool> m_visible;
+
+        GLTextLayer m_text;
+        bool m_textReady;
+
+        /// The lines of the current summary, joined
+        std::string m_lines;
+
+        void sample();
+    };
+}
@@ -0,0 +1,102 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Color.hpp"
+#include <OpenGL/gl.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graphics {
+
+    /// Draws text from a glyph atlas: the printable ASCII range of a
+    /// font is rasterised once into a single texture, each distinct
+    /// string is laid out once and cached, and everything added in a
+    /// frame is drawn with one textured draw call. Replaces
+    /// glfreetype::print, which rasterised per glyph through display
+    /// lists and redid the whole string every frame.
+    class GLTextLayer
+    {
+      public:
+        GLTextLayer();
+        GLTextLayer(GLTextLayer const &) = delete;
+        GLTextLayer & operator=(GLTextLayer const &) = delete;
+        ~GLTextLayer();
+
+        /// Rasterises the font at the given height, sized as
+        /// glfreetype::font_data::init sizes it. Throws
+        /// std::runtime_error if the font can't be loaded.
+        void init(std::string const & fontPath, unsigned int const height);
+
+        /// Clears the text queued for the frame, keeping capacity
+        void begin();
+
+        /// Queues text with its baseline starting at (x, y), in
+        /// framebuffer pixels from the bottom left, as for
+        /// glfreetype::print. A '\n' starts a new line below.
+        void add(float const x, float const y,
+                 std::string const & text,
+                 Color const & color,
+                 double const opacity = 1.0);
+
+        /// Draws everything queued since begin, in screen space
+        void draw();
+
+      private:
+        struct Glyph
+        {
+            float left;
+            float top;
+            float width;
+            float height;
+            float advance;
+            float u0;
+            float v0;
+            float u1;
+            float v1;
+        };
+
+        /// A glyph quad relative to the start of the string
+        struct GlyphQuad
+        {
+            float x0;
+            float y0;
+            float x1;
+            float y1;
+            float u0;
+            float v0;
+            float u1;
+            float v1;
+        };
+
+        struct Vertex
+        {
+            GLfloat x;
+            GLfloat y;
+            GLfloat u;
+            GLfloat v;
+            GLubyte rgba[4];
+        };
+
+        static constexpr int FIRST_CHAR = 32;
+        static constexpr int LAST_CHAR = 126;
+
+        std::vector<Glyph> m_glyphs;
+        float m_lineHeight;
+
+        /// The atlas, kept until its first upload
+        std::vector<GLubyte> m_atlas;
+        int m_atlasWidth;
+        int m_atlasHeight;
+        GLuint m_texture;
+
+        /// Laid-out strings by content. Cleared when it gets large,
+        /// as with changing counters most entries are never reused.
+        std::unordered_map<std::string, std::vector<GlyphQuad>> m_layouts;
+
+        std::vector<Vertex> m_vertices;
+
+        std::vector<GlyphQuad> const & layout(std::string const & text);
+    };
+}
@@ -4,7 +4,7 @@
 
 #include "GLGUIElement.hpp"
 #include "Color.hpp"
-#include "ThreadRunner.hpp"
+#include "Scheduler.hpp"
 #include <OpenGL/gl.h>
 #include <GLFW/glfw3.h>
 #include <atomic>
@@ -18,7 +18,7 @@ namespace graphics {
         GLVerticalSlider(GLFWwindow * window,
                          int windowOffset,
                          int width,
-                         detail::ThreadRunner & threadRunner);
+                         Scheduler & scheduler);
         GLVerticalSlider() = delete;
 
         void draw() override;
@@ -48,8 +48,8 @@ namespace graphics {
         /// Up in -ve, down is +ve
         int m_sliderPosition;
 
-        /// Threads the fade-in or fade-out process
-        detail::ThreadRunner & m_threadRunner;
+        /// Runs the fade-in or fade-out animation
+        Scheduler & m_scheduler;
 
         /// Mouse hovering over button, true
         std::atomic<bool> m_entered;
@@ -2,11 +2,13 @@
 
 #include "GLEnvironment.hpp"
 #include "GLGUIElement.hpp"
-#include "ThreadRunner.hpp"
+#include "Scheduler.hpp"
 #include "GLConsole.hpp"
+#include "GLStatsOverlay.hpp"
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <ostream>
 #include <vector>
 
 namespace graphics {
@@ -16,7 +18,7 @@ namespace graphics {
         explicit Graphics(int & windowWidth, 
                           int & windowHeight, 
                           GLEnvironment & glEnviro,
-                          detail::ThreadRunner & threadRunner);
+                          Scheduler & scheduler);
         Graphics() = delete;
         void display();
         void reshape(int const w, int const h);
@@ -35,6 +37,12 @@ namespace graphics {
 
         void toggleAntennaeDraw();
 
+        /// Shows or hides the live performance overlay
+        void showStats(bool const show);
+
+        /// Writes the latest performance numbers, one per line
+        void printStats(std::ostream & out);
+
       private:
 
         /// Dimensions of window
@@ -47,8 +55,8 @@ namespace graphics {
         /// Zoom parameter
         double & m_viewDistance;
 
-        /// To run stuff async
-        detail::ThreadRunner & m_threadRunner;
+        /// To run stuff async, and to animate fades
+        Scheduler & m_scheduler;
 
         /// Testing out some GUI ideas
         std::vector<std::shared_ptr<GLGUIElement>> m_guiElements;
@@ -68,6 +76,12 @@ namespace graphics {
         /// Track an agent when selected
         std::atomic<bool> m_trackAgent;
 
+        /// The console fade-in, while it runs
+        Scheduler::TaskId m_consoleFade;
+
+        /// Live performance numbers
+        GLStatsOverlay m_stats;
+
         void handleKeyDown(int const key);
         void handleKeyUp(int const key);
         void handleKeyContinuous(int const key);
@@ -3,5 +3,6 @@
 namespace graphics { namespace detail {
     float retinaScalar(GLFWwindow * window = nullptr);
     void lineWidth(GLfloat orig);
+    void pointSize(GLfloat orig);
 }
 }
\ No newline at end of file
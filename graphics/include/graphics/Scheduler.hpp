@@ -0,0 +1,124 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace graphics {
+
+    /// Runs work off the render thread and drives animations on it.
+    ///
+    /// Tasks (post, postAfter, postEvery) run on a single worker thread,
+    /// in order of when they fall due, and never while the queue lock is
+    /// held, so a task can itself schedule or cancel other tasks.
+    ///
+    /// Animations (animate) are stepped from advanceFrame, which the
+    /// render loop calls once per frame; they are given how far through
+    /// their duration they are, measured on the frame clock, so their
+    /// speed doesn't depend on the frame rate and nothing ever sleeps.
+    class Scheduler
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Ids start from 1, so 0 can stand for no task
+        using TaskId = std::uint64_t;
+
+        /// Step of an animation; progress runs from 0 to 1 and the
+        /// last call always has progress exactly 1
+        using AnimationStep = std::function<void(double const progress)>;
+
+        Scheduler();
+        ~Scheduler();
+        Scheduler(Scheduler const &) = delete;
+        Scheduler & operator=(Scheduler const &) = delete;
+
+        /// Runs task on the worker as soon as possible
+        TaskId post(std::function<void()> task);
+
+        /// Runs task on the worker once delay has passed
+        TaskId postAfter(Clock::duration const delay,
+                         std::function<void()> task);
+
+        /// Runs task on the worker every period, the first
+        /// time one period from now
+        TaskId postEvery(Clock::duration const period,
+                         std::function<void()> task);
+
+        /// Runs step on the render thread every frame for duration
+        TaskId animate(Clock::duration const duration,
+                       AnimationStep step);
+
+        /// Stops a task or animation from running again. A task that
+        /// is currently running is allowed to finish; a cancelled
+        /// animation is not given its final step. Cancelling 0, or a
+        /// task that has already finished, does nothing.
+        void cancel(TaskId const id);
+
+        /// Steps every running animation; called once per frame
+        /// from the render thread
+        void advanceFrame();
+
+        /// Stops and joins the worker; tasks still queued are dropped.
+        /// Called by the destructor if not called before.
+        void shutdown();
+
+      private:
+        struct Task
+        {
+            Clock::time_point due;
+            Clock::duration period;
+            std::function<void()> func;
+        };
+
+        struct Animation
+        {
+            TaskId id;
+            Clock::time_point start;
+            Clock::duration duration;
+            AnimationStep step;
+        };
+
+        /// Ordered so that the earliest due is at the top of the queue
+        struct Due
+        {
+            Clock::time_point due;
+            TaskId id;
+            bool operator<(Due const & other) const
+            {
+                return other.due < due || (other.due == due && other.id < id);
+            }
+        };
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::priority_queue<Due> m_due;
+
+        /// A task is live while it is in here; cancelling
+        /// just removes it and leaves its entry in m_due stale
+        std::unordered_map<TaskId, Task> m_tasks;
+        TaskId m_nextId;
+        bool m_shutdown;
+        std::thread m_worker;
+
+        /// Handed over to the render thread on the next frame
+        std::vector<Animation> m_newAnimations;
+        std::vector<TaskId> m_cancelledAnimations;
+
+        /// Only touched by the render thread
+        std::vector<Animation> m_animations;
+
+        TaskId schedule(Clock::time_point const due,
+                        Clock::duration const period,
+                        std::function<void()> task);
+        void run();
+    };
+}
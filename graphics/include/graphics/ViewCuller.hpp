@@ -0,0 +1,89 @@
+// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "RetinaScalar.hpp"
+#include <cmath>
+
+namespace graphics {
+
+    /// How much of an animat is worth drawing at its on-screen size
+    enum class LevelOfDetail
+    {
+        Hidden, // entirely off screen
+        Dot,    // a single point
+        Line,   // one line from tail to head
+        Body,   // segments only
+        Full    // segments, bounding circles, antennae and text
+    };
+
+    namespace detail {
+
+        /// The world rectangle made visible by setScene, given the same
+        /// arguments. Used to skip animats that are off screen and to
+        /// simplify those that are too small to show any detail.
+        class ViewCuller
+        {
+          public:
+            ViewCuller(int const windowWidth,
+                       int const windowHeight,
+                       double const viewDistance,
+                       double const orientation,
+                       double const centerX = 0,
+                       double const centerY = 0)
+              : m_left((-windowWidth / 2) * viewDistance + centerX)
+              , m_right((windowWidth / 2) * viewDistance + centerX)
+              , m_bottom((-windowHeight / 2) * viewDistance + centerY)
+              , m_top((windowHeight / 2) * viewDistance + centerY)
+              , m_cos(std::cos(orientation * M_PI / 180.0))
+              , m_sin(std::sin(orientation * M_PI / 180.0))
+              , m_pixelsPerUnit(retinaScalar() / viewDistance)
+            {
+            }
+
+            /// False if a circle in world coordinates lies wholly
+            /// outside the visible rectangle
+            bool visible(double const x, double const y, double const radius) const
+            {
+                // Same rotation as setScene's modelview
+                auto const ex = m_cos * x - m_sin * y;
+                auto const ey = m_sin * x + m_cos * y;
+                return ex + radius >= m_left && ex - radius <= m_right &&
+                       ey + radius >= m_bottom && ey - radius <= m_top;
+            }
+
+            /// Picks a level of detail from the on-screen radius of the
+            /// circle bounding a whole animat and from the zoom
+            LevelOfDetail levelOfDetail(double const x, double const y,
+                                        double const radius) const
+            {
+                if (!visible(x, y, radius)) {
+                    return LevelOfDetail::Hidden;
+                }
+                auto const pixels = radius * m_pixelsPerUnit;
+                if (pixels < 2.0) {
+                    return LevelOfDetail::Dot;
+                }
+                if (pixels < 8.0) {
+                    return LevelOfDetail::Line;
+                }
+
+                // Block circles and antennae are a unit or two across
+                // whatever the animat's length, so they go with zoom alone
+                if (m_pixelsPerUnit < 2.0) {
+                    return LevelOfDetail::Body;
+                }
+                return LevelOfDetail::Full;
+            }
+
+          private:
+            double m_left;
+            double m_right;
+            double m_bottom;
+            double m_top;
+            double m_cos;
+            double m_sin;
+            double m_pixelsPerUnit;
+        };
+    }
+}
@@ -1,61 +1,35 @@
 // Copyright (c) 2017-present Ben Jones
 
-#include "glfreetype/TextRenderer.hpp"
 #include "graphics/GLAnimat.hpp"
 #include "graphics/WorldToScreen.hpp"
 #include "graphics/RetinaScalar.hpp"
 #include "physics/PhysicsEngine.hpp"
 #include "model/Animat.hpp"
 #include "model/AnimatWorld.hpp"
+#include "model/WorldSnapshot.hpp"
 #include <OpenGL/gl.h>
+#include <chrono>
 #include <cmath>
 #include <atomic>
 #include <memory>
 #include <mutex>
-#include <sstream>
-#include <unistd.h>
-
-namespace {
-    glfreetype::font_data g_animatText;
-    std::once_flag g_textInitGuard;
-}
+#include <string>
 
 namespace graphics {
 
-    namespace detail {
-
-        inline void drawCircle(float cx, float cy, float r, int num_segments, bool const filled = false) 
-        {
-            if (!filled) {
-                glBegin(GL_LINE_LOOP);
-            } else {
-                glBegin(GL_POLYGON);
-            }
-            for (int ii = 0; ii < num_segments; ii++)   {
-                float theta = 2.0f * 3.1415926f * float(ii) / float(num_segments);//get the current angle 
-                float x = r * ::cosf(theta);//calculate the x component 
-                float y = r * ::sinf(theta);//calculate the y component 
-                glVertex3f(x + cx, y + cy, 0);//output vertex 
-            }
-            glEnd();
-        }
-    }
-
     GLAnimat::GLAnimat(std::shared_ptr<model::Animat> animat,
-                       detail::ThreadRunner & threadRunner)
+                       Scheduler & scheduler)
       : m_animat(std::move(animat))
-      , m_threadRunner(threadRunner)
+      , m_scheduler(scheduler)
       , m_highlighted(std::make_shared<std::atomic<bool>>(false)) 
       , m_selected(std::make_shared<std::atomic<bool>>(false))
       , m_opacity(std::make_shared<std::atomic<double>>(1))
       , m_isTracked(false)
       , m_drawAntennae(false)
+      , m_label()
+      , m_labelID(-1)
+      , m_fade(0)
     {
-        std::call_once(g_textInitGuard, 
-                       [&](){
-                           g_animatText.init("../fonts/Action_Man.ttf",
-                           25 * detail::retinaScalar()); 
-                        });
     }
 
     void GLAnimat::toggleAntennaeDraw()
@@ -81,19 +55,41 @@ namespace graphics {
         return m_animat->hadToWrap();
     }
 
-    void GLAnimat::updateAnimat(std::shared_ptr<model::Animat> animat)
+    void GLAnimat::batch(GLBatchRenderer & renderer,
+                         model::WorldSnapshot const & snapshot,
+                         int const index,
+                         LevelOfDetail const lod)
     {
-        m_animat = std::move(animat);
+        switch (lod) {
+            case LevelOfDetail::Hidden:
+                return;
+            case LevelOfDetail::Dot:
+                batchDot(renderer, snapshot, index);
+                break;
+            case LevelOfDetail::Line:
+                batchLine(renderer, snapshot, index);
+                break;
+            case LevelOfDetail::Body:
+                batchBody(renderer, snapshot, index);
+                break;
+            case LevelOfDetail::Full:
+                batchBody(renderer, snapshot, index);
+                if(m_drawAntennae){ batchAntennae(renderer, snapshot, index); }
+                batchBoundingCircles(renderer, snapshot, index);
+                break;
+        }
+        if (*m_highlighted || *m_selected) {
+            batchBigBoundingCircle(renderer, snapshot, index);
+        }
     }
 
-    void GLAnimat::draw()
+    void GLAnimat::addHighlightText(GLTextLayer & text,
+                                    model::WorldSnapshot const & snapshot,
+                                    int const index,
+                                    LevelOfDetail const lod)
     {
-        detail::setColor(m_basicColor);
-        drawBody();
-        if(m_drawAntennae){ drawAntennae(); }
-        drawBoundingCircles();
-        if (*m_highlighted || *m_selected) {
-            drawBigBoundingCircle();
+        if (*m_highlighted && !*m_selected && lod >= LevelOfDetail::Body) {
+            showPopNumber(text, snapshot, index);
         }
     }
 
@@ -107,7 +103,9 @@ namespace graphics {
         return *m_selected;
     }
 
-    void GLAnimat::checkForHighlight(double x, 
+    void GLAnimat::checkForHighlight(model::WorldSnapshot const & snapshot,
+                                     int const index,
+                                     double x, 
                                      double y,
                                      double const viewDistance,
                                      double const centerX,
@@ -118,10 +116,9 @@ namespace graphics {
         x -= centerX;
         x *= detail::retinaScalar();
         y *= detail::retinaScalar();
-        auto centralPoint = m_animat->getCentralPoint();
-        auto & pos = centralPoint.first;
-        auto cx = pos.m_vec[0] - centerX;
-        auto cy = pos.m_vec[1] - centerY;
+        auto const * central = &snapshot.centralCircles[3 * index];
+        auto cx = central[0] - centerX;
+        auto cy = central[1] - centerY;
         double sx, sy;
         detail::worldToScreen(cx, cy, sx, sy);
 
@@ -132,8 +129,8 @@ namespace graphics {
 
         if (diffXSq < 5 && diffYSq < 5) {
             *m_highlighted = true;
-            // m_threadRunner.add([this]{fadeIn();});
-            // m_threadRunner.add([this]{fadeOut();});
+            // fadeIn();
+            // fadeOut();
         } else {
             *m_highlighted = false;
         }
@@ -144,141 +141,123 @@ namespace graphics {
         return m_animat;
     }
 
-    void GLAnimat::drawBody()
+    void GLAnimat::batchDot(GLBatchRenderer & renderer,
+                            model::WorldSnapshot const & snapshot,
+                            int const index)
+    {
+        auto const * central = &snapshot.centralCircles[3 * index];
+        renderer.addPoint(central[0], central[1], m_basicColor, 2.0);
+    }
+
+    void GLAnimat::batchLine(GLBatchRenderer & renderer,
+                             model::WorldSnapshot const & snapshot,
+                             int const index)
     {
-        detail::lineWidth(4.0);
-        auto & physicsEngine = m_animat->getPhysicsEngine();
+        // From the middle of the rearmost layer to the middle of the
+        // frontmost, so that heading still reads when zoomed far out
+        auto const * tail = &snapshot.blockCorners[8 * snapshot.blockOffsets[index]];
+        auto const * head = &snapshot.blockCorners[8 * (snapshot.blockOffsets[index + 1] - 1)];
+        renderer.addLine((tail[0] + tail[2]) / 2, (tail[1] + tail[3]) / 2,
+                         (head[4] + head[6]) / 2, (head[5] + head[7]) / 2,
+                         m_basicColor, 2.0);
+    }
 
-        auto blocks = m_animat->getBlockCount();
+    void GLAnimat::batchBody(GLBatchRenderer & renderer,
+                             model::WorldSnapshot const & snapshot,
+                             int const index)
+    {
+        auto const * rgb = &snapshot.colours[3 * index];
+        Color const speciesColor{double(rgb[0]), double(rgb[1]), double(rgb[2])};
 
-        for(int b = 0; b < m_animat->getBlockCount(); ++b) {
-            auto block = m_animat->getBlock(b);
-            auto layer1 = block.getLayerOne();
-            auto layer2 = block.getLayerTwo();
-            auto layer1Left = layer1.getPositionLeft(physicsEngine);
-            auto layer1Right = layer1.getPositionRight(physicsEngine);
-            auto layer2Left = layer2.getPositionLeft(physicsEngine);
-            auto layer2Right = layer2.getPositionRight(physicsEngine);
+        auto const first = snapshot.blockOffsets[index];
+        for(int b = first; b < snapshot.blockOffsets[index + 1]; ++b) {
 
-            detail::setColor(m_basicColor);
-            glBegin(GL_LINES);
-                glVertex3f(layer1Left.m_vec[0], layer1Left.m_vec[1], 0);
-                glVertex3f(layer1Right.m_vec[0], layer1Right.m_vec[1], 0);
-                glVertex3f(layer2Left.m_vec[0], layer2Left.m_vec[1], 0);
-                glVertex3f(layer2Right.m_vec[0], layer2Right.m_vec[1], 0);
-                glVertex3f(layer1Left.m_vec[0], layer1Left.m_vec[1], 0);
-                glVertex3f(layer2Left.m_vec[0], layer2Left.m_vec[1], 0);
-                glVertex3f(layer1Right.m_vec[0], layer1Right.m_vec[1], 0);
-                glVertex3f(layer2Right.m_vec[0], layer2Right.m_vec[1], 0);
-            glEnd();
-            auto sc = m_animat->getSpeciesColour();
-            detail::setColor({sc.R, sc.G, sc.B});
-            glBegin(GL_QUADS);
-                glVertex3f(layer1Left.m_vec[0], layer1Left.m_vec[1], 0);
-                glVertex3f(layer1Right.m_vec[0], layer1Right.m_vec[1], 0);
-                glVertex3f(layer2Right.m_vec[0], layer2Right.m_vec[1], 0);
-                glVertex3f(layer2Left.m_vec[0], layer2Left.m_vec[1], 0);
-            glEnd();
+            // layer one left, layer one right, layer two right, layer two left
+            auto const * q = &snapshot.blockCorners[8 * b];
+            renderer.addLine(q[0], q[1], q[2], q[3], m_basicColor, 4.0);
+            renderer.addLine(q[6], q[7], q[4], q[5], m_basicColor, 4.0);
+            renderer.addLine(q[0], q[1], q[6], q[7], m_basicColor, 4.0);
+            renderer.addLine(q[2], q[3], q[4], q[5], m_basicColor, 4.0);
+            renderer.addQuad(q[0], q[1], q[2], q[3], q[4], q[5], q[6], q[7],
+                             speciesColor);
         }
-        detail::setColor(m_basicColor);
-        detail::lineWidth(1.0);
     }
 
-    void GLAnimat::drawAntennae()
+    void GLAnimat::batchAntennae(GLBatchRenderer & renderer,
+                                 model::WorldSnapshot const & snapshot,
+                                 int const index)
     {
-        detail::lineWidth(2.0);
-        auto & physicsEngine = m_animat->getPhysicsEngine();
-        auto blocks = m_animat->getBlockCount();
-
-        // Draw antennae
-        auto leftAnt = m_animat->getLeftAntennaePoint();
-        auto rightAnt = m_animat->getRightAntennaePoint();
-        auto & layer1 = m_animat->getBlock(blocks-1).getLayerTwo();
-        auto layer1Left = layer1.getPositionLeft(physicsEngine);
-        auto layer1Right = layer1.getPositionRight(physicsEngine);
-        glBegin(GL_LINES);
-            glVertex3f(layer1Left.m_vec[0], layer1Left.m_vec[1], 0);
-            glVertex3f(leftAnt.m_vec[0], leftAnt.m_vec[1], 0);
-            glVertex3f(layer1Right.m_vec[0], layer1Right.m_vec[1], 0);
-            glVertex3f(rightAnt.m_vec[0], rightAnt.m_vec[1], 0);
-        glEnd();
+        // Antennae grow out of the front layer of the last block
+        auto const * q = &snapshot.blockCorners[8 * (snapshot.blockOffsets[index + 1] - 1)];
+        auto const * ant = &snapshot.antennae[4 * index];
+        renderer.addLine(q[6], q[7], ant[0], ant[1], m_basicColor, 2.0);
+        renderer.addLine(q[4], q[5], ant[2], ant[3], m_basicColor, 2.0);
 
-        // Draw 'bobbles' on the end of each antenna
-        detail::setColor(m_antennaeColor); 
-        detail::drawCircle(leftAnt.m_vec[0], leftAnt.m_vec[1], 0.2, 10, true /* filled */);
-        detail::drawCircle(rightAnt.m_vec[0], rightAnt.m_vec[1], 0.2, 10, true);
-
-        // Outline
-        detail::setColor(m_basicColor);
-        detail::drawCircle(leftAnt.m_vec[0], leftAnt.m_vec[1], 0.2, 10);
-        detail::drawCircle(rightAnt.m_vec[0], rightAnt.m_vec[1], 0.2, 10);
-        detail::lineWidth(1.0);
+        // 'Bobbles' on the end of each antenna, with outlines
+        renderer.addCircle(ant[0], ant[1], 0.2, 10, m_antennaeColor, true);
+        renderer.addCircle(ant[2], ant[3], 0.2, 10, m_antennaeColor, true);
+        renderer.addCircle(ant[0], ant[1], 0.2, 10, m_basicColor, false, 2.0);
+        renderer.addCircle(ant[2], ant[3], 0.2, 10, m_basicColor, false, 2.0);
     }
 
-    void GLAnimat::drawBoundingCircles()
+    void GLAnimat::batchBoundingCircles(GLBatchRenderer & renderer,
+                                        model::WorldSnapshot const & snapshot,
+                                        int const index)
     {
-        for(int b = 0; b < m_animat->getBlockCount(); ++b) {
-            auto boundingPair = m_animat->getBoundingCircle(b);
-            auto & centerPoint = boundingPair.first;
-            detail::drawCircle(centerPoint.m_vec[0], 
-                               centerPoint.m_vec[1],
-                               boundingPair.second, 20);
+        for(int b = snapshot.blockOffsets[index]; b < snapshot.blockOffsets[index + 1]; ++b) {
+            auto const * circle = &snapshot.blockCircles[3 * b];
+            renderer.addCircle(circle[0], circle[1], circle[2], 20, m_basicColor);
         }
     }
 
     void GLAnimat::fadeIn()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity->load();
-            val += inc;
-            m_opacity->store(val);
-            ::usleep(10000);
-        }
+        fadeTo(1.0);
     }
 
     void GLAnimat::fadeOut()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity->load();
-            val -= inc;
-            m_opacity->store(val);
-            ::usleep(10000);
-        }
+        fadeTo(0.1);
     }
 
-    void GLAnimat::showPopNumber(std::pair<physics::Vector3, double> 
-                                 const & boundingPair)
+    void GLAnimat::fadeTo(double const target)
     {
+        m_scheduler.cancel(m_fade);
+        auto const start = m_opacity->load();
+        auto opacity = m_opacity;
+        m_fade = m_scheduler.animate(std::chrono::milliseconds(300),
+                                     [opacity, start, target](double const progress) {
+            opacity->store(start + (target - start) * progress);
+        });
+    }
+
+    void GLAnimat::showPopNumber(GLTextLayer & text,
+                                 model::WorldSnapshot const & snapshot,
+                                 int const index)
+    {
+        auto const id = snapshot.ids[index];
+        if (id != m_labelID) {
+            m_label = "ID: " + std::to_string(id);
+            m_labelID = id;
+        }
+
         // display population number above agent
-        glPushMatrix();
-        glLoadIdentity();
-        detail::setColor({70, 70, 70}, *m_opacity);
-        auto cx = boundingPair.first.m_vec[0];
-        auto cy = boundingPair.first.m_vec[1];
-        cy += (boundingPair.second * 1.2);
+        auto const * central = &snapshot.centralCircles[3 * index];
+        double cx = central[0];
+        double cy = central[1];
+        cy += (central[2] * 1.2);
         double sx, sy;
         detail::worldToScreen(cx, cy, sx, sy);
-        std::stringstream ss;
-        ss << "ID: " << m_animat->getID();
-        glfreetype::print(g_animatText, sx - 20, sy, ss.str());
-        glPopMatrix();
+        text.add(sx - 20, sy, m_label, {70, 70, 70}, *m_opacity);
     }
 
-    void GLAnimat::drawBigBoundingCircle()
+    void GLAnimat::batchBigBoundingCircle(GLBatchRenderer & renderer,
+                                          model::WorldSnapshot const & snapshot,
+                                          int const index)
     {
-        auto boundingPair = m_animat->getCentralPoint();
-        if(*m_selected) {
-            detail::lineWidth(2.0);
-        } else {
-            showPopNumber(boundingPair);
-        }
-        detail::setColor(m_bigCircleColor);
-        detail::drawCircle(boundingPair.first.m_vec[0], 
-                           boundingPair.first.m_vec[1],
-                           boundingPair.second, 20);
-        detail::setColor(m_basicColor);
-        detail::lineWidth(1.0);
-    }   
+        auto const * central = &snapshot.centralCircles[3 * index];
+        renderer.addCircle(central[0], central[1], central[2], 20,
+                           m_bigCircleColor, false,
+                           *m_selected ? 2.0 : 1.0);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "graphics/GLBatchRenderer.hpp"
+#include "graphics/RetinaScalar.hpp"
+#include <cstddef>
+
+namespace graphics {
+
+    GLBatchRenderer::GLBatchRenderer()
+      : m_batches()
+      , m_upload()
+      , m_circles()
+      , m_buffer(0)
+    {
+    }
+
+    GLBatchRenderer::~GLBatchRenderer()
+    {
+        if (m_buffer != 0) {
+            glDeleteBuffers(1, &m_buffer);
+        }
+    }
+
+    void GLBatchRenderer::begin()
+    {
+        for (auto & b : m_batches) {
+            b.vertices.clear();
+        }
+        m_circles.begin();
+    }
+
+    GLBatchRenderer::Vertex GLBatchRenderer::vertex(float const x, float const y,
+                                                    Color const & color)
+    {
+        return {x, y, {static_cast<GLubyte>(color.R),
+                       static_cast<GLubyte>(color.G),
+                       static_cast<GLubyte>(color.B),
+                       255}};
+    }
+
+    std::vector<GLBatchRenderer::Vertex> & GLBatchRenderer::batch(GLenum const mode,
+                                                                  float const width)
+    {
+        for (auto & b : m_batches) {
+            if (b.mode == mode && b.width == width) {
+                return b.vertices;
+            }
+        }
+        m_batches.push_back({mode, width, {}});
+        return m_batches.back().vertices;
+    }
+
+    void GLBatchRenderer::addQuad(float const x0, float const y0,
+                                  float const x1, float const y1,
+                                  float const x2, float const y2,
+                                  float const x3, float const y3,
+                                  Color const & color)
+    {
+        auto & vertices = batch(GL_QUADS);
+        vertices.push_back(vertex(x0, y0, color));
+        vertices.push_back(vertex(x1, y1, color));
+        vertices.push_back(vertex(x2, y2, color));
+        vertices.push_back(vertex(x3, y3, color));
+    }
+
+    void GLBatchRenderer::addLine(float const x0, float const y0,
+                                  float const x1, float const y1,
+                                  Color const & color,
+                                  float const width)
+    {
+        auto & vertices = batch(GL_LINES, width);
+        vertices.push_back(vertex(x0, y0, color));
+        vertices.push_back(vertex(x1, y1, color));
+    }
+
+    void GLBatchRenderer::addPoint(float const x, float const y,
+                                   Color const & color,
+                                   float const size)
+    {
+        batch(GL_POINTS, size).push_back(vertex(x, y, color));
+    }
+
+    void GLBatchRenderer::addCircle(float const cx, float const cy, float const r,
+                                    int const segments,
+                                    Color const & color,
+                                    bool const filled,
+                                    float const width)
+    {
+        m_circles.addCircle(cx, cy, r, color, 1.0, segments, filled, width);
+    }
+
+    void GLBatchRenderer::draw()
+    {
+        m_upload.clear();
+        for (auto const & b : m_batches) {
+            m_upload.insert(std::end(m_upload), std::begin(b.vertices), std::end(b.vertices));
+        }
+        if (m_upload.empty()) {
+            m_circles.draw();
+            return;
+        }
+
+        if (m_buffer == 0) {
+            glGenBuffers(1, &m_buffer);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+        // Orphan last frame's storage so the driver needn't
+        // wait for it to be drawn before accepting new data
+        glBufferData(GL_ARRAY_BUFFER, m_upload.size() * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_upload.size() * sizeof(Vertex), m_upload.data());
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(Vertex),
+                        reinterpret_cast<GLvoid const *>(offsetof(Vertex, x)));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex),
+                       reinterpret_cast<GLvoid const *>(offsetof(Vertex, rgba)));
+
+        GLint first = 0;
+        for (auto const & b : m_batches) {
+            if (!b.vertices.empty()) {
+                if (b.mode == GL_POINTS) {
+                    detail::pointSize(b.width);
+                } else {
+                    detail::lineWidth(b.width);
+                }
+                glDrawArrays(b.mode, first, b.vertices.size());
+                first += b.vertices.size();
+            }
+        }
+        detail::lineWidth(1.0);
+        detail::pointSize(1.0);
+
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_circles.draw();
+    }
+}
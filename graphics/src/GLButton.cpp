@@ -2,8 +2,8 @@
 
 #include "graphics/GLButton.hpp"
 #include "graphics/RetinaScalar.hpp"
+#include <chrono>
 #include <cmath>
-#include <unistd.h>
 
 
 namespace {
@@ -24,11 +24,11 @@ namespace graphics {
                        int yLocation,
                        int width,
                        int height,
-                       detail::ThreadRunner & threadRunner)
+                       Scheduler & scheduler)
       : m_window(window) 
       , m_xLocation(xLocation)
       , m_yLocation(yLocation)
-      , m_threadRunner(threadRunner)
+      , m_scheduler(scheduler)
       , m_width(width)
       , m_height(height)
       , m_entered(false)
@@ -36,6 +36,7 @@ namespace graphics {
       , m_handler()
       , m_overLay()
       , m_state(false)
+      , m_fade(0)
     {
     }
 
@@ -77,25 +78,24 @@ namespace graphics {
     /// fade in the button when hovering over
     void GLButton::fadeIn()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity.load();
-            val += inc;
-            m_opacity.store(val);
-            ::usleep(10000);
-        }
+        fadeTo(1.2);
     }
 
     /// fade out the button on pointer exit
     void GLButton::fadeOut()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity.load();
-            val -= inc;
-            m_opacity.store(val);
-            ::usleep(10000);
-        }
+        fadeTo(0.3);
+    }
+
+    void GLButton::fadeTo(double const target)
+    {
+        // Picks up from wherever a fade still running has got to
+        m_scheduler.cancel(m_fade);
+        auto const start = m_opacity.load();
+        m_fade = m_scheduler.animate(std::chrono::milliseconds(300),
+                                     [this, start, target](double const progress) {
+            m_opacity.store(start + (target - start) * progress);
+        });
     }
 
     /// When pointer over button, a 'fade-in'
@@ -107,11 +107,11 @@ namespace graphics {
             y <= (m_windowHeight - m_yLocation) &&
             y >= (m_windowHeight - m_yLocation) - m_height) {
             if(!m_entered.exchange(true)) {
-                m_threadRunner.add([this]{fadeIn();});
+                fadeIn();
             }
         } else {
             if(m_entered.exchange(false)) {
-                m_threadRunner.add([this]{fadeOut();});
+                fadeOut();
             }
         }
     }
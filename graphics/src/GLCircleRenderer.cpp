@@ -0,0 +1,275 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "graphics/GLCircleRenderer.hpp"
+#include "graphics/RetinaScalar.hpp"
+#include <OpenGL/glext.h>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace {
+
+    /// Fixed-function matrices are used so that circles follow
+    /// whatever setScene or the GUI code has set up
+    char const * const VERTEX_SHADER =
+        "#version 120\n"
+        "attribute vec2 unit;\n"
+        "attribute vec3 circle;\n"
+        "attribute vec4 colour;\n"
+        "varying vec4 vColour;\n"
+        "void main()\n"
+        "{\n"
+        "    vec2 p = circle.xy + unit * circle.z;\n"
+        "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+        "    vColour = colour;\n"
+        "}\n";
+
+    char const * const FRAGMENT_SHADER =
+        "#version 120\n"
+        "varying vec4 vColour;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_FragColor = vColour;\n"
+        "}\n";
+
+    GLuint compileShader(GLenum const type, char const * source)
+    {
+        auto const shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (ok != GL_TRUE) {
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+}
+
+namespace graphics {
+
+    namespace detail {
+        std::vector<float> const & unitCircle(int const segments)
+        {
+            static std::map<int, std::vector<float>> circles;
+            static std::mutex circlesMutex;
+            std::lock_guard<std::mutex> lg(circlesMutex);
+            auto & circle = circles[segments];
+            if (circle.empty()) {
+                circle.reserve(segments * 2);
+                for (int i = 0; i < segments; ++i) {
+                    auto const theta = 2.0f * 3.1415926f * float(i) / float(segments);
+                    circle.push_back(::cosf(theta));
+                    circle.push_back(::sinf(theta));
+                }
+            }
+            return circle;
+        }
+    }
+
+    GLCircleRenderer::GLCircleRenderer()
+      : m_groups()
+      , m_meshes()
+      , m_meshVertices()
+      , m_meshDirty(false)
+      , m_meshBuffer(0)
+      , m_instanceBuffer(0)
+      , m_program(0)
+      , m_unitAttribute(-1)
+      , m_circleAttribute(-1)
+      , m_colorAttribute(-1)
+    {
+    }
+
+    GLCircleRenderer::~GLCircleRenderer()
+    {
+        if (m_meshBuffer != 0) {
+            glDeleteBuffers(1, &m_meshBuffer);
+            glDeleteBuffers(1, &m_instanceBuffer);
+        }
+        if (m_program > 0) {
+            glDeleteProgram(m_program);
+        }
+    }
+
+    void GLCircleRenderer::begin()
+    {
+        for (auto & group : m_groups) {
+            group.instances.clear();
+        }
+    }
+
+    void GLCircleRenderer::addCircle(float const cx, float const cy, float const r,
+                                     Color const & color,
+                                     double const opacity,
+                                     int const segments,
+                                     bool const filled,
+                                     float const width)
+    {
+        Instance const instance{cx, cy, r,
+                                {static_cast<GLubyte>(color.R),
+                                 static_cast<GLubyte>(color.G),
+                                 static_cast<GLubyte>(color.B),
+                                 static_cast<GLubyte>(opacity * 255.0)}};
+        for (auto & group : m_groups) {
+            if (group.segments == segments &&
+                group.filled == filled &&
+                (filled || group.width == width)) {
+                group.instances.push_back(instance);
+                return;
+            }
+        }
+        m_groups.push_back({segments, filled, width, {instance}});
+    }
+
+    GLCircleRenderer::Mesh const & GLCircleRenderer::mesh(int const segments)
+    {
+        for (auto const & m : m_meshes) {
+            if (m.segments == segments) {
+                return m;
+            }
+        }
+        auto const & circle = detail::unitCircle(segments);
+        Mesh m{segments, 0, 0};
+        m.loopFirst = m_meshVertices.size() / 2;
+        m_meshVertices.insert(std::end(m_meshVertices), std::begin(circle), std::end(circle));
+        m.fanFirst = m_meshVertices.size() / 2;
+        m_meshVertices.push_back(0);
+        m_meshVertices.push_back(0);
+        m_meshVertices.insert(std::end(m_meshVertices), std::begin(circle), std::end(circle));
+        m_meshVertices.push_back(circle[0]);
+        m_meshVertices.push_back(circle[1]);
+        m_meshDirty = true;
+        m_meshes.push_back(m);
+        return m_meshes.back();
+    }
+
+    void GLCircleRenderer::initProgram()
+    {
+        m_program = -1;
+        auto const vertexShader = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+        auto const fragmentShader = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+        if (vertexShader != 0 && fragmentShader != 0) {
+            auto const program = glCreateProgram();
+            glAttachShader(program, vertexShader);
+            glAttachShader(program, fragmentShader);
+            glLinkProgram(program);
+            GLint ok = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &ok);
+            if (ok == GL_TRUE) {
+                m_program = program;
+                m_unitAttribute = glGetAttribLocation(program, "unit");
+                m_circleAttribute = glGetAttribLocation(program, "circle");
+                m_colorAttribute = glGetAttribLocation(program, "colour");
+            } else {
+                glDeleteProgram(program);
+            }
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        if (m_program < 0) {
+            std::cerr << "GLCircleRenderer: no shader support, "
+                      << "falling back to per-circle draws" << std::endl;
+        }
+    }
+
+    void GLCircleRenderer::draw()
+    {
+        if (m_program == 0) {
+            initProgram();
+            glGenBuffers(1, &m_meshBuffer);
+            glGenBuffers(1, &m_instanceBuffer);
+        }
+
+        // Meshes are created before binding anything so that the
+        // mesh buffer is uploaded at most once per new segment count
+        for (auto const & group : m_groups) {
+            if (!group.instances.empty()) {
+                mesh(group.segments);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, m_meshBuffer);
+        if (m_meshDirty) {
+            glBufferData(GL_ARRAY_BUFFER, m_meshVertices.size() * sizeof(GLfloat),
+                         m_meshVertices.data(), GL_STATIC_DRAW);
+            m_meshDirty = false;
+        }
+
+        for (auto const & group : m_groups) {
+            if (group.instances.empty()) {
+                continue;
+            }
+            if (!group.filled) {
+                detail::lineWidth(group.width);
+            }
+            if (m_program > 0) {
+                drawInstanced(group, mesh(group.segments));
+            } else {
+                drawFallback(group, mesh(group.segments));
+            }
+        }
+        detail::lineWidth(1.0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void GLCircleRenderer::drawInstanced(Group const & group, Mesh const & m)
+    {
+        glUseProgram(m_program);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_meshBuffer);
+        glEnableVertexAttribArray(m_unitAttribute);
+        glVertexAttribPointer(m_unitAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, group.instances.size() * sizeof(Instance),
+                     nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, group.instances.size() * sizeof(Instance),
+                        group.instances.data());
+        glEnableVertexAttribArray(m_circleAttribute);
+        glVertexAttribPointer(m_circleAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<GLvoid const *>(offsetof(Instance, cx)));
+        glVertexAttribDivisorARB(m_circleAttribute, 1);
+        glEnableVertexAttribArray(m_colorAttribute);
+        glVertexAttribPointer(m_colorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance),
+                              reinterpret_cast<GLvoid const *>(offsetof(Instance, rgba)));
+        glVertexAttribDivisorARB(m_colorAttribute, 1);
+
+        if (group.filled) {
+            glDrawArraysInstancedARB(GL_TRIANGLE_FAN, m.fanFirst, m.segments + 2,
+                                     group.instances.size());
+        } else {
+            glDrawArraysInstancedARB(GL_LINE_LOOP, m.loopFirst, m.segments,
+                                     group.instances.size());
+        }
+
+        glVertexAttribDivisorARB(m_circleAttribute, 0);
+        glVertexAttribDivisorARB(m_colorAttribute, 0);
+        glDisableVertexAttribArray(m_unitAttribute);
+        glDisableVertexAttribArray(m_circleAttribute);
+        glDisableVertexAttribArray(m_colorAttribute);
+        glUseProgram(0);
+    }
+
+    void GLCircleRenderer::drawFallback(Group const & group, Mesh const & m)
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, nullptr);
+        glMatrixMode(GL_MODELVIEW);
+        for (auto const & instance : group.instances) {
+            glColor4ub(instance.rgba[0], instance.rgba[1], instance.rgba[2], instance.rgba[3]);
+            glPushMatrix();
+            glTranslatef(instance.cx, instance.cy, 0);
+            glScalef(instance.r, instance.r, 1);
+            if (group.filled) {
+                glDrawArrays(GL_TRIANGLE_FAN, m.fanFirst, m.segments + 2);
+            } else {
+                glDrawArrays(GL_LINE_LOOP, m.loopFirst, m.segments);
+            }
+            glPopMatrix();
+        }
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+}
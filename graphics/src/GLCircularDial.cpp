@@ -2,8 +2,8 @@
 
 #include "graphics/GLCircularDial.hpp"
 #include "graphics/RetinaScalar.hpp"
+#include <chrono>
 #include <cmath>
-#include <unistd.h>
 
 namespace {
     inline int deriveX(int const windowWidth, int const xLocation)
@@ -37,11 +37,11 @@ namespace graphics {
                    int yLocation,
                    double radius,
                    int const startLevel,
-                   detail::ThreadRunner & threadRunner)
+                   Scheduler & scheduler)
       : m_window(window) 
       , m_xLocation(xLocation)
       , m_yLocation(yLocation)
-      , m_threadRunner(threadRunner)
+      , m_scheduler(scheduler)
       , m_radius(radius)
       , m_entered(false)
       , m_opacity(0.3)
@@ -49,6 +49,8 @@ namespace graphics {
       , m_level(startLevel)
       , m_state(false)
       , m_handler()
+      , m_circles()
+      , m_fade(0)
     {
     }
 
@@ -63,30 +65,12 @@ namespace graphics {
         glTranslatef(m_derivedX, m_derivedY, 0);
         glRotatef(m_angle, 0.0, 0.0, 1.0);
 
-        // Outer dial circle
-        detail::lineWidth(3.0);
-        detail::setColor({10, 10, 150}, 0.3 /* opacity */);
-        glBegin(GL_LINE_LOOP);
-            for (double angle = 0; angle < 3.1415926f * 2; angle += 0.25) {
-                glVertex2f(::sin(angle) * m_radius, ::cos(angle) * m_radius);
-            }
-        glEnd();
-
-        // Inner fill
-        detail::setColor({130, 130, 150}, 0.3 /* opacity */);
-        glBegin(GL_POLYGON);
-            for (double angle = 0; angle < 3.1415926f * 2; angle += 0.25) {
-                glVertex2f(::sin(angle) * (m_radius - 1.0), ::cos(angle) * (m_radius - 1.0));
-            }
-        glEnd();
-
-        // Inner circular element
-        detail::setColor({10, 10, 150}, 0.3 /* opacity */);
-        glBegin(GL_POLYGON);
-            for (double angle = 0; angle < 3.1415926f * 2; angle += 0.25) {
-                glVertex2f(::sin(angle) * (m_radius / 5.0), ::cos(angle) * (m_radius / 5.0));
-            }
-        glEnd();
+        // Outer dial circle, inner fill and inner circular element
+        m_circles.begin();
+        m_circles.addCircle(0, 0, m_radius, {10, 10, 150}, 0.3, 25, false, 3.0);
+        m_circles.addCircle(0, 0, m_radius - 1.0, {130, 130, 150}, 0.3, 25, true);
+        m_circles.addCircle(0, 0, m_radius / 5.0, {10, 10, 150}, 0.3, 25, true);
+        m_circles.draw();
 
         // Dial pointer Pointer
         detail::lineWidth(3.0);
@@ -101,25 +85,23 @@ namespace graphics {
     /// fade in the button when hovering over
     void GLCircularDial::fadeIn()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity.load();
-            val += inc;
-            m_opacity.store(val);
-            usleep(10000);
-        }
+        fadeTo(1.2);
     }
 
     /// fade out the button on pointer exit
     void GLCircularDial::fadeOut()
     {
-        auto const inc = (0.9 / 30);
-        for(int i = 0; i < 30; ++i) {
-            auto val = m_opacity.load();
-            val -= inc;
-            m_opacity.store(val);
-            usleep(10000);
-        }
+        fadeTo(0.3);
+    }
+
+    void GLCircularDial::fadeTo(double const target)
+    {
+        m_scheduler.cancel(m_fade);
+        auto const start = m_opacity.load();
+        m_fade = m_scheduler.animate(std::chrono::milliseconds(300),
+                                     [this, start, target](double const progress) {
+            m_opacity.store(start + (target - start) * progress);
+        });
     }
 
     void GLCircularDial::mouseIsOver(int const x, int const y)
@@ -0,0 +1,73 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "graphics/GLStatsOverlay.hpp"
+#include "graphics/RetinaScalar.hpp"
+#include <chrono>
+
+namespace graphics {
+
+    GLStatsOverlay::GLStatsOverlay(Scheduler & scheduler)
+      : m_scheduler(scheduler)
+      , m_sampling(0)
+      , m_previous(instrument::snapshot())
+      , m_summaries()
+      , m_visible(false)
+      , m_text()
+      , m_textReady(false)
+      , m_lines()
+    {
+        m_sampling = m_scheduler.postEvery(std::chrono::milliseconds(500),
+                                           [this]{ sample(); });
+    }
+
+    GLStatsOverlay::~GLStatsOverlay()
+    {
+        m_scheduler.cancel(m_sampling);
+    }
+
+    void GLStatsOverlay::show()
+    {
+        m_visible = true;
+    }
+
+    void GLStatsOverlay::hide()
+    {
+        m_visible = false;
+    }
+
+    void GLStatsOverlay::sample()
+    {
+        auto current = instrument::snapshot();
+        m_summaries.back() = instrument::PerformanceSummary::between(m_previous, current);
+        m_summaries.publish();
+        m_previous = std::move(current);
+    }
+
+    instrument::PerformanceSummary const & GLStatsOverlay::latest()
+    {
+        if (m_summaries.consume()) {
+            m_lines.clear();
+            for (auto const & line : m_summaries.front().lines()) {
+                m_lines += line;
+                m_lines += '\n';
+            }
+        }
+        return m_summaries.front();
+    }
+
+    void GLStatsOverlay::draw(int const windowHeight)
+    {
+        if (!m_visible) {
+            return;
+        }
+        if (!m_textReady) {
+            m_text.init("../fonts/09809_COURIER.ttf", 12 * detail::retinaScalar());
+            m_textReady = true;
+        }
+        latest();
+        auto const scale = detail::retinaScalar();
+        m_text.begin();
+        m_text.add(10 * scale, (windowHeight - 20) * scale, m_lines, {70, 70, 70}, 0.9);
+        m_text.draw();
+    }
+}
@@ -0,0 +1,252 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "graphics/GLTextLayer.hpp"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+    /// Width of the atlas; its height grows to fit
+    int const ATLAS_WIDTH = 512;
+
+    /// Upper bound on cached layouts before the cache is dropped
+    std::size_t const MAX_LAYOUTS = 256;
+
+    int nextPowerOfTwo(int const value)
+    {
+        int p = 1;
+        while (p < value) {
+            p <<= 1;
+        }
+        return p;
+    }
+}
+
+namespace graphics {
+
+    GLTextLayer::GLTextLayer()
+      : m_glyphs()
+      , m_lineHeight(0)
+      , m_atlas()
+      , m_atlasWidth(0)
+      , m_atlasHeight(0)
+      , m_texture(0)
+      , m_layouts()
+      , m_vertices()
+    {
+    }
+
+    GLTextLayer::~GLTextLayer()
+    {
+        if (m_texture != 0) {
+            glDeleteTextures(1, &m_texture);
+        }
+    }
+
+    void GLTextLayer::init(std::string const & fontPath, unsigned int const height)
+    {
+        FT_Library library;
+        if (FT_Init_FreeType(&library)) {
+            throw std::runtime_error("GLTextLayer: FT_Init_FreeType failed");
+        }
+        FT_Face face;
+        if (FT_New_Face(library, fontPath.c_str(), 0, &face)) {
+            FT_Done_FreeType(library);
+            throw std::runtime_error("GLTextLayer: failed to load font " + fontPath);
+        }
+
+        // Same sizing as glfreetype so that text stays the same size
+        FT_Set_Char_Size(face, height << 6, height << 6, 96, 96);
+        m_lineHeight = height / 0.63f;
+
+        struct Bitmap
+        {
+            int width;
+            int rows;
+            std::vector<GLubyte> pixels;
+        };
+        std::vector<Bitmap> bitmaps;
+        m_glyphs.clear();
+        for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+            Glyph glyph{};
+            Bitmap bitmap{0, 0, {}};
+            if (!FT_Load_Char(face, c, FT_LOAD_RENDER)) {
+                auto const slot = face->glyph;
+                glyph.left = slot->bitmap_left;
+                glyph.top = slot->bitmap_top;
+                glyph.width = slot->bitmap.width;
+                glyph.height = slot->bitmap.rows;
+                glyph.advance = slot->advance.x >> 6;
+                bitmap.width = slot->bitmap.width;
+                bitmap.rows = slot->bitmap.rows;
+                for (int r = 0; r < bitmap.rows; ++r) {
+                    auto const * row = slot->bitmap.buffer + r * slot->bitmap.pitch;
+                    bitmap.pixels.insert(std::end(bitmap.pixels), row, row + bitmap.width);
+                }
+            }
+            m_glyphs.push_back(glyph);
+            bitmaps.push_back(std::move(bitmap));
+        }
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+
+        // Pack glyphs into shelves, with a pixel of padding to stop
+        // neighbours bleeding in under linear filtering
+        std::vector<std::pair<int, int>> origins;
+        int x = 1;
+        int y = 1;
+        int shelfHeight = 0;
+        for (auto const & bitmap : bitmaps) {
+            if (x + bitmap.width + 1 > ATLAS_WIDTH) {
+                x = 1;
+                y += shelfHeight + 1;
+                shelfHeight = 0;
+            }
+            origins.emplace_back(x, y);
+            x += bitmap.width + 1;
+            shelfHeight = std::max(shelfHeight, bitmap.rows);
+        }
+        m_atlasWidth = ATLAS_WIDTH;
+        m_atlasHeight = nextPowerOfTwo(y + shelfHeight + 1);
+        m_atlas.assign(m_atlasWidth * m_atlasHeight, 0);
+        for (std::size_t i = 0; i < bitmaps.size(); ++i) {
+            auto const & bitmap = bitmaps[i];
+            auto const ox = origins[i].first;
+            auto const oy = origins[i].second;
+            for (int r = 0; r < bitmap.rows; ++r) {
+                std::copy_n(&bitmap.pixels[r * bitmap.width], bitmap.width,
+                            &m_atlas[(oy + r) * m_atlasWidth + ox]);
+            }
+            auto & glyph = m_glyphs[i];
+            glyph.u0 = float(ox) / m_atlasWidth;
+            glyph.v0 = float(oy) / m_atlasHeight;
+            glyph.u1 = float(ox + bitmap.width) / m_atlasWidth;
+            glyph.v1 = float(oy + bitmap.rows) / m_atlasHeight;
+        }
+        m_layouts.clear();
+    }
+
+    void GLTextLayer::begin()
+    {
+        m_vertices.clear();
+    }
+
+    std::vector<GLTextLayer::GlyphQuad> const &
+    GLTextLayer::layout(std::string const & text)
+    {
+        auto found = m_layouts.find(text);
+        if (found != std::end(m_layouts)) {
+            return found->second;
+        }
+        if (m_layouts.size() >= MAX_LAYOUTS) {
+            m_layouts.clear();
+        }
+        auto & quads = m_layouts[text];
+        float penX = 0;
+        float penY = 0;
+        for (auto const ch : text) {
+            if (ch == '\n') {
+                penX = 0;
+                penY -= m_lineHeight;
+                continue;
+            }
+            auto const c = static_cast<unsigned char>(ch);
+            if (c < FIRST_CHAR || c > LAST_CHAR) {
+                continue;
+            }
+            auto const & glyph = m_glyphs[c - FIRST_CHAR];
+            if (glyph.width > 0 && glyph.height > 0) {
+
+                // Bitmap rows run top down, so v0 is the top edge
+                auto const x0 = penX + glyph.left;
+                auto const y1 = penY + glyph.top;
+                quads.push_back({x0, y1 - glyph.height, x0 + glyph.width, y1,
+                                 glyph.u0, glyph.v1, glyph.u1, glyph.v0});
+            }
+            penX += glyph.advance;
+        }
+        return quads;
+    }
+
+    void GLTextLayer::add(float const x, float const y,
+                          std::string const & text,
+                          Color const & color,
+                          double const opacity)
+    {
+        if (m_glyphs.empty()) {
+            return;
+        }
+        GLubyte const rgba[4] = {static_cast<GLubyte>(std::min(color.R, 255.0)),
+                                 static_cast<GLubyte>(std::min(color.G, 255.0)),
+                                 static_cast<GLubyte>(std::min(color.B, 255.0)),
+                                 static_cast<GLubyte>(std::max(0.0, std::min(opacity, 1.0)) * 255)};
+        for (auto const & q : layout(text)) {
+            m_vertices.push_back({x + q.x0, y + q.y0, q.u0, q.v0, {rgba[0], rgba[1], rgba[2], rgba[3]}});
+            m_vertices.push_back({x + q.x1, y + q.y0, q.u1, q.v0, {rgba[0], rgba[1], rgba[2], rgba[3]}});
+            m_vertices.push_back({x + q.x1, y + q.y1, q.u1, q.v1, {rgba[0], rgba[1], rgba[2], rgba[3]}});
+            m_vertices.push_back({x + q.x0, y + q.y1, q.u0, q.v1, {rgba[0], rgba[1], rgba[2], rgba[3]}});
+        }
+    }
+
+    void GLTextLayer::draw()
+    {
+        if (m_vertices.empty()) {
+            return;
+        }
+
+        if (m_texture == 0) {
+            glGenTextures(1, &m_texture);
+            glBindTexture(GL_TEXTURE_2D, m_texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_atlasWidth, m_atlasHeight, 0,
+                         GL_ALPHA, GL_UNSIGNED_BYTE, m_atlas.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            std::vector<GLubyte>().swap(m_atlas);
+        }
+
+        glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT | GL_TRANSFORM_BIT);
+
+        // Screen space in framebuffer pixels, as glfreetype sets up
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        glOrtho(viewport[0], viewport[2], viewport[1], viewport[3], -1, 1);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_TEXTURE_2D);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        auto const * base = reinterpret_cast<GLubyte const *>(m_vertices.data());
+        glVertexPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+        glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, u));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, rgba));
+        glDrawArrays(GL_QUADS, 0, m_vertices.size());
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+
+        glPopMatrix();
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopAttrib();
+    }
+}
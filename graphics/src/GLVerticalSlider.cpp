@@ -36,11 +36,11 @@ namespace graphics {
     GLVerticalSlider::GLVerticalSlider(GLFWwindow * window,
                      int windowOffset,
                      int width,
-                     detail::ThreadRunner & threadRunner)
+                     Scheduler & scheduler)
       : m_window(window) 
       , m_windowOffset(windowOffset)
       , m_width(width)
-      , m_threadRunner(threadRunner)
+      , m_scheduler(scheduler)
       , m_entered(false)
       , m_opacity(0.3)
       , m_sliderPosition(getWindowHeight(window) / 2)
@@ -4,9 +4,11 @@
 #include "graphics/GLVerticalSlider.hpp"
 #include "graphics/RetinaScalar.hpp"
 #include "graphics/SetScene.hpp"
+#include "instrument/Instrument.hpp"
 #include <OpenGL/gl.h>
 #include <OpenGL/glu.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
 
 namespace {
     void init() // Called before main loop to set up the program
@@ -32,12 +34,12 @@ namespace graphics {
     Graphics::Graphics(int & windowWidth,
                        int & windowHeight,
                        GLEnvironment & glEnviro,
-                       detail::ThreadRunner & threadRunner)
+                       Scheduler & scheduler)
       : m_windowWidth(windowWidth)
       , m_windowHeight(windowHeight)
       , m_glEnviro(glEnviro)
       , m_viewDistance(m_glEnviro.getViewDistance())
-      , m_threadRunner(threadRunner)
+      , m_scheduler(scheduler)
       , m_guiElements()
       , m_consoleOpacity(0)
       , m_console(m_windowWidth,
@@ -52,6 +54,8 @@ namespace graphics {
       , m_displayConsole(false)
       , m_consoleHasFocus(false)
       , m_trackAgent(false)
+      , m_consoleFade(0)
+      , m_stats(m_scheduler)
     {
         init();
         m_glEnviro.setZoomTrigger([this]{
@@ -67,8 +71,12 @@ namespace graphics {
 
     void Graphics::display()
     {
+        INSTRUMENT_TRACED_SCOPE("render.frame");
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // Fades and camera moves step once per frame
+        m_scheduler.advanceFrame();
+
         if(m_trackAgent.load()) {
             m_glEnviro.track();
         } else {
@@ -121,6 +129,7 @@ namespace graphics {
                     fadeInConsole();
                     m_consoleHasFocus = true;
                 } else {
+                    m_scheduler.cancel(m_consoleFade);
                     m_consoleOpacity = 0;
                 }
             } else if(key == 'T') {
@@ -212,6 +221,8 @@ namespace graphics {
             b->draw();
         }
 
+        m_stats.draw(m_windowHeight);
+
         // Draw the console, if enabled
         if(m_displayConsole.load()) {
             m_console.display();
@@ -242,17 +253,29 @@ namespace graphics {
 
     void Graphics::fadeInConsole()
     {
-        m_threadRunner.add([this]{
-            auto const inc = (0.8 / 20);
-            for(int i = 0; i < 20; ++i) {
-                auto val = m_consoleOpacity.load();
-                val += inc;
-                m_consoleOpacity.store(val);
-                ::usleep(5000);
-            }
+        m_scheduler.cancel(m_consoleFade);
+        m_consoleFade = m_scheduler.animate(std::chrono::milliseconds(100),
+                                            [this](double const progress) {
+            m_consoleOpacity.store(0.8 * progress);
         });
     }
 
+    void Graphics::showStats(bool const show)
+    {
+        if(show) {
+            m_stats.show();
+        } else {
+            m_stats.hide();
+        }
+    }
+
+    void Graphics::printStats(std::ostream & out)
+    {
+        for(auto const & line : m_stats.latest().lines()) {
+            out << line << std::endl;
+        }
+    }
+
     void Graphics::toggleAntennaeDraw()
     {
         m_glEnviro.toggleAntennaeDraw();
@@ -25,5 +25,10 @@ namespace graphics {  namespace detail {
     {
         glLineWidth(orig * retinaScalar());
     }
+
+    void pointSize(GLfloat orig)
+    {
+        glPointSize(orig * retinaScalar());
+    }
 }
 }
\ No newline at end of file
@@ -0,0 +1,199 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "graphics/Scheduler.hpp"
+#include "instrument/Instrument.hpp"
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <iostream>
+
+namespace graphics {
+
+    Scheduler::Scheduler()
+      : m_mutex()
+      , m_cond()
+      , m_due()
+      , m_tasks()
+      , m_nextId(1)
+      , m_shutdown(false)
+      , m_worker()
+      , m_newAnimations()
+      , m_cancelledAnimations()
+      , m_animations()
+    {
+        m_worker = std::thread(&Scheduler::run, this);
+    }
+
+    Scheduler::~Scheduler()
+    {
+        shutdown();
+    }
+
+    Scheduler::TaskId Scheduler::post(std::function<void()> task)
+    {
+        return schedule(Clock::now(), Clock::duration::zero(), std::move(task));
+    }
+
+    Scheduler::TaskId Scheduler::postAfter(Clock::duration const delay,
+                                           std::function<void()> task)
+    {
+        return schedule(Clock::now() + delay, Clock::duration::zero(), std::move(task));
+    }
+
+    Scheduler::TaskId Scheduler::postEvery(Clock::duration const period,
+                                           std::function<void()> task)
+    {
+        return schedule(Clock::now() + period, period, std::move(task));
+    }
+
+    Scheduler::TaskId Scheduler::schedule(Clock::time_point const due,
+                                          Clock::duration const period,
+                                          std::function<void()> task)
+    {
+        TaskId id;
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            id = m_nextId++;
+            m_tasks.emplace(id, Task{due, period, std::move(task)});
+            m_due.push({due, id});
+        }
+        m_cond.notify_one();
+        return id;
+    }
+
+    Scheduler::TaskId Scheduler::animate(Clock::duration const duration,
+                                         AnimationStep step)
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        auto const id = m_nextId++;
+        m_newAnimations.push_back({id, Clock::now(), duration, std::move(step)});
+        return id;
+    }
+
+    void Scheduler::cancel(TaskId const id)
+    {
+        if (id == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lg(m_mutex);
+        if (m_tasks.erase(id) > 0) {
+            return;
+        }
+        auto const fresh = std::find_if(std::begin(m_newAnimations),
+                                        std::end(m_newAnimations),
+                                        [id](Animation const & a) { return a.id == id; });
+        if (fresh != std::end(m_newAnimations)) {
+            m_newAnimations.erase(fresh);
+        } else {
+            m_cancelledAnimations.push_back(id);
+        }
+    }
+
+    void Scheduler::advanceFrame()
+    {
+        TRACE_SCOPE("scheduler.animations");
+        std::vector<TaskId> cancelled;
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            std::move(std::begin(m_newAnimations), std::end(m_newAnimations),
+                      std::back_inserter(m_animations));
+            m_newAnimations.clear();
+            cancelled.swap(m_cancelledAnimations);
+        }
+
+        // Steps run without the lock so that they can start or
+        // cancel animations; those take effect on the next frame
+        auto const now = Clock::now();
+        auto finished = [&](Animation & a) {
+            if (std::find(std::begin(cancelled), std::end(cancelled), a.id)
+                != std::end(cancelled)) {
+                return true;
+            }
+            auto progress = 1.0;
+            if (a.duration > Clock::duration::zero()) {
+                std::chrono::duration<double> const elapsed = now - a.start;
+                std::chrono::duration<double> const total = a.duration;
+                progress = std::min(1.0, elapsed.count() / total.count());
+            }
+            try {
+                a.step(progress);
+            } catch (std::exception const & e) {
+                std::cerr << "Scheduler: " << e.what() << std::endl;
+                return true;
+            }
+            return progress >= 1.0;
+        };
+        m_animations.erase(std::remove_if(std::begin(m_animations),
+                                          std::end(m_animations),
+                                          finished),
+                           std::end(m_animations));
+    }
+
+    void Scheduler::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_shutdown = true;
+        }
+        m_cond.notify_all();
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+    }
+
+    void Scheduler::run()
+    {
+        instrument::Tracer::instance().setThreadName("scheduler");
+        std::unique_lock<std::mutex> ul(m_mutex);
+        while (!m_shutdown) {
+            if (m_due.empty()) {
+                m_cond.wait(ul);
+                continue;
+            }
+            auto const next = m_due.top();
+            auto found = m_tasks.find(next.id);
+            if (found == std::end(m_tasks) || found->second.due != next.due) {
+                // Cancelled since it was queued
+                m_due.pop();
+                continue;
+            }
+            if (Clock::now() < next.due) {
+                m_cond.wait_until(ul, next.due);
+                continue;
+            }
+            m_due.pop();
+            auto func = std::move(found->second.func);
+            auto const period = found->second.period;
+            if (period == Clock::duration::zero()) {
+                m_tasks.erase(found);
+            }
+
+            // Outside of the lock so that the task may itself post or cancel
+            ul.unlock();
+            try {
+                TRACE_SCOPE("scheduler.task");
+                func();
+            } catch (std::exception const & e) {
+                std::cerr << "Scheduler: " << e.what() << std::endl;
+            }
+            ul.lock();
+
+            // A periodic task goes back in unless cancelled while it ran.
+            // If it has fallen more than a period behind, it skips
+            // the missed runs rather than running them back to back.
+            if (period != Clock::duration::zero()) {
+                found = m_tasks.find(next.id);
+                if (found != std::end(m_tasks)) {
+                    auto const now = Clock::now();
+                    auto due = next.due + period;
+                    if (due < now) {
+                        due = now + period;
+                    }
+                    found->second.due = due;
+                    found->second.func = std::move(func);
+                    m_due.push({due, next.id});
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Replaces the global operator new and delete with versions that count
+ * every allocation into instrument::allocationCount(). The replacements
+ * are ordinary (not inline) definitions, so include this from exactly
+ * one source file of an executable, e.g. the one holding main().
+ */
+
+#include "instrument/Allocations.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace instrument {
+    namespace detail {
+
+        inline void * countedAllocate(std::size_t const size)
+        {
+            countAllocation(size);
+            if (auto * p = std::malloc(size == 0 ? 1 : size)) {
+                return p;
+            }
+            throw std::bad_alloc();
+        }
+
+        inline void * countedAllocateAligned(std::size_t const size,
+                                             std::align_val_t const alignment)
+        {
+            countAllocation(size);
+            auto const align = static_cast<std::size_t>(alignment);
+            void * p = nullptr;
+            if (::posix_memalign(&p, align < sizeof(void *) ? sizeof(void *) : align,
+                                 size == 0 ? 1 : size) != 0) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+
+        /// Flags the counts as live during static initialisation
+        struct AllocationHookInstaller
+        {
+            AllocationHookInstaller() { markAllocationsCounted(); }
+        };
+        static AllocationHookInstaller const allocationHookInstaller;
+    }
+}
+
+void * operator new(std::size_t size) { return instrument::detail::countedAllocate(size); }
+void * operator new[](std::size_t size) { return instrument::detail::countedAllocate(size); }
+void * operator new(std::size_t size, std::align_val_t a) { return instrument::detail::countedAllocateAligned(size, a); }
+void * operator new[](std::size_t size, std::align_val_t a) { return instrument::detail::countedAllocateAligned(size, a); }
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t) noexcept { std::free(p); }
+void operator delete(void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,24 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace instrument {
+
+    /// Heap allocations made through operator new, and their total
+    /// size, since start-up. Only counted by executables that include
+    /// instrument/AllocationHook.hpp (simplay_bench always does, stest
+    /// when built with SIMPLAY_COUNT_ALLOCATIONS); otherwise both stay 0
+    /// and allocationsCounted() is false. Registry snapshots report them
+    /// as the memory.allocations and memory.allocated_bytes counters.
+    bool allocationsCounted();
+    std::uint64_t allocationCount();
+    std::uint64_t allocatedBytes();
+
+    namespace detail {
+        void countAllocation(std::size_t const bytes);
+        void markAllocationsCounted();
+    }
+}
@@ -0,0 +1,64 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Macros for timing and counting hot paths. Each looks its metric up in
+ * the Registry once, on first use, and caches the reference in a
+ * function static, so the steady-state cost is the clock reads and a few
+ * relaxed atomic adds.
+ *
+ *     INSTRUMENT_SCOPE("physics.update");      // times the enclosing scope
+ *     INSTRUMENT_TRACED_SCOPE("sim.tick");     // ... and traces it as a span
+ *     INSTRUMENT_COUNT("collision.checks", n); // adds n to a counter
+ *     TRACE_SCOPE("render.frame");             // traces a span, no timer
+ *     TRACE_INSTANT("evolution.mutate");       // traces a point event
+ *
+ * Tracing only records anything while the Tracer has been started.
+ *
+ * Building with SIMPLAY_NO_INSTRUMENTATION defined (the CMake option
+ * SIMPLAY_INSTRUMENTATION=OFF) compiles every use away to nothing.
+ */
+
+#ifndef SIMPLAY_NO_INSTRUMENTATION
+
+#include "instrument/Registry.hpp"
+#include "instrument/ScopedTimer.hpp"
+#include "instrument/Tracer.hpp"
+
+#define INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_IMPL(a, b)
+
+#define INSTRUMENT_SCOPE(name)                                                      \
+    static ::instrument::Histogram & INSTRUMENT_CONCAT(instrumentTimer_, __LINE__) = \
+        ::instrument::Registry::instance().timer(name);                             \
+    ::instrument::ScopedTimer INSTRUMENT_CONCAT(instrumentScope_, __LINE__)(        \
+        INSTRUMENT_CONCAT(instrumentTimer_, __LINE__))
+
+#define INSTRUMENT_TRACED_SCOPE(name)                                               \
+    static ::instrument::Histogram & INSTRUMENT_CONCAT(instrumentTimer_, __LINE__) = \
+        ::instrument::Registry::instance().timer(name);                             \
+    ::instrument::ScopedTimer INSTRUMENT_CONCAT(instrumentScope_, __LINE__)(        \
+        INSTRUMENT_CONCAT(instrumentTimer_, __LINE__), name)
+
+#define INSTRUMENT_COUNT(name, n)                                                   \
+    do {                                                                            \
+        static ::instrument::Counter & instrumentCounter =                          \
+            ::instrument::Registry::instance().counter(name);                       \
+        instrumentCounter.add(n);                                                   \
+    } while (false)
+
+#define TRACE_SCOPE(name)                                                           \
+    ::instrument::TraceScope INSTRUMENT_CONCAT(traceScope_, __LINE__)(name)
+
+#define TRACE_INSTANT(name) ::instrument::Tracer::instance().instant(name)
+
+#else
+
+#define INSTRUMENT_SCOPE(name) do {} while (false)
+#define INSTRUMENT_TRACED_SCOPE(name) do {} while (false)
+#define INSTRUMENT_COUNT(name, n) do {} while (false)
+#define TRACE_SCOPE(name) do {} while (false)
+#define TRACE_INSTANT(name) do {} while (false)
+
+#endif
@@ -0,0 +1,16 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstdint>
+
+namespace instrument {
+
+    /// Physical memory currently used by the process,
+    /// or 0 where the platform doesn't say
+    std::uint64_t residentBytes();
+
+    /// The most physical memory the process has used so far,
+    /// or 0 where the platform doesn't say
+    std::uint64_t peakResidentBytes();
+}
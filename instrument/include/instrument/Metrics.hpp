@@ -0,0 +1,76 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace instrument {
+
+    /// A named count that any thread can bump without locking
+    class Counter
+    {
+      public:
+        explicit Counter(std::string name);
+
+        void add(std::uint64_t const n = 1)
+        {
+            m_value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        std::uint64_t value() const
+        {
+            return m_value.load(std::memory_order_relaxed);
+        }
+
+        std::string const & name() const;
+
+      private:
+        std::string const m_name;
+        alignas(64) std::atomic<std::uint64_t> m_value;
+    };
+
+    /// Distribution of durations in nanoseconds. Bucket b holds values
+    /// in [2^(b-1), 2^b), with bucket 0 holding zero, so recording is a
+    /// couple of relaxed atomic adds and percentiles are good to within
+    /// a factor of two, interpolated inside the bucket.
+    class Histogram
+    {
+      public:
+        static int const BUCKETS = 64;
+        using Buckets = std::array<std::uint64_t, BUCKETS>;
+
+        explicit Histogram(std::string name);
+
+        void record(std::uint64_t const nanoseconds)
+        {
+            auto const bucket = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+            m_buckets[bucket < BUCKETS ? bucket : BUCKETS - 1].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_total.fetch_add(nanoseconds, std::memory_order_relaxed);
+            auto max = m_max.load(std::memory_order_relaxed);
+            while (nanoseconds > max &&
+                   !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+            }
+        }
+
+        std::string const & name() const;
+        std::uint64_t count() const;
+        std::uint64_t total() const;
+        std::uint64_t max() const;
+        Buckets buckets() const;
+
+        /// Estimated value below which the fraction q of
+        /// the recorded values lie, given bucket counts
+        static double percentile(Buckets const & buckets, double const q);
+
+      private:
+        std::string const m_name;
+        alignas(64) std::atomic<std::uint64_t> m_count;
+        std::atomic<std::uint64_t> m_total;
+        std::atomic<std::uint64_t> m_max;
+        std::array<std::atomic<std::uint64_t>, BUCKETS> m_buckets;
+    };
+}
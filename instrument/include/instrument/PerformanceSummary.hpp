@@ -0,0 +1,35 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "instrument/Snapshot.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace instrument {
+
+    /// The headline numbers for an interval between two snapshots,
+    /// as shown by the console `stats` command and the stats overlay
+    struct PerformanceSummary
+    {
+        double seconds = 0;
+        double ticksPerSecond = 0;
+        double substepsPerSecond = 0;
+        double agentStepsPerSecond = 0;
+        double meanTickMilliseconds = 0;
+        double p99TickMilliseconds = 0;
+        double framesPerSecond = 0;
+        double evaluationsPerSecond = 0;
+
+        /// Negative when allocations aren't being counted
+        double allocationsPerSecond = -1;
+        std::uint64_t residentBytes = 0;
+
+        static PerformanceSummary between(Snapshot const & earlier,
+                                          Snapshot const & later);
+
+        /// One "label  value" line per number
+        std::vector<std::string> lines() const;
+    };
+}
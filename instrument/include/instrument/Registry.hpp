@@ -0,0 +1,36 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "instrument/Metrics.hpp"
+#include "instrument/Snapshot.hpp"
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace instrument {
+
+    /// Owns every counter and timer in the process. Metrics are created
+    /// on first use and live until exit, so a reference to one can be
+    /// cached (the INSTRUMENT_ macros keep it in a function static) and
+    /// only the lookup ever takes the lock.
+    class Registry
+    {
+      public:
+        static Registry & instance();
+
+        Counter & counter(std::string const & name);
+        Histogram & timer(std::string const & name);
+
+        Snapshot snapshot() const;
+
+      private:
+        Registry() = default;
+
+        mutable std::mutex m_mutex;
+
+        /// Deques so that references stay valid as metrics are added
+        std::deque<Counter> m_counters;
+        std::deque<Histogram> m_timers;
+    };
+}
@@ -0,0 +1,42 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "instrument/Metrics.hpp"
+#include "instrument/Tracer.hpp"
+#include <cstdint>
+
+namespace instrument {
+
+    /// Records the time from construction to destruction. Given a
+    /// trace name, the same interval also goes to the Tracer as a span
+    /// whenever tracing is on, at no cost beyond a flag check when off.
+    class ScopedTimer
+    {
+      public:
+        explicit ScopedTimer(Histogram & histogram,
+                             char const * traceName = nullptr)
+          : m_histogram(histogram)
+          , m_traceName(traceName)
+          , m_start(Tracer::now())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            auto const elapsed = Tracer::now() - m_start;
+            m_histogram.record(elapsed);
+            if (m_traceName) {
+                Tracer::instance().complete(m_traceName, m_start, elapsed);
+            }
+        }
+
+        ScopedTimer(ScopedTimer const &) = delete;
+        ScopedTimer & operator=(ScopedTimer const &) = delete;
+
+      private:
+        Histogram & m_histogram;
+        char const * m_traceName;
+        std::uint64_t const m_start;
+    };
+}
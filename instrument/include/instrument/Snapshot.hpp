@@ -0,0 +1,58 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "instrument/Metrics.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace instrument {
+
+    struct CounterSample
+    {
+        std::string name;
+        std::uint64_t value;
+    };
+
+    struct TimerSample
+    {
+        std::string name;
+        std::uint64_t count;
+        std::uint64_t totalNanoseconds;
+
+        /// Largest duration ever recorded; not windowed by since()
+        std::uint64_t maxNanoseconds;
+        Histogram::Buckets buckets;
+
+        double meanNanoseconds() const;
+        double percentileNanoseconds(double const q) const;
+    };
+
+    /// Copy of every counter and timer at one moment. Values are totals
+    /// since start-up; since() turns two snapshots into the activity
+    /// in between, from which rates and recent percentiles follow.
+    struct Snapshot
+    {
+        /// When the snapshot was taken, in steady clock nanoseconds
+        std::uint64_t timestampNanoseconds;
+
+        /// Process memory when the snapshot was taken; not windowed
+        std::uint64_t residentBytes;
+        std::vector<CounterSample> counters;
+        std::vector<TimerSample> timers;
+
+        /// Null if there is no metric of that name
+        CounterSample const * counter(std::string const & name) const;
+        TimerSample const * timer(std::string const & name) const;
+
+        /// What happened between earlier and this snapshot
+        Snapshot since(Snapshot const & earlier) const;
+
+        /// Seconds between earlier and this snapshot
+        double secondsSince(Snapshot const & earlier) const;
+    };
+
+    /// Takes a snapshot of the global registry
+    Snapshot snapshot();
+}
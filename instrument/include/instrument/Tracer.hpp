@@ -0,0 +1,126 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace instrument {
+
+    namespace detail {
+        struct TraceBuffer;
+    }
+
+    /// Records a timeline of spans and instants from every thread and
+    /// streams it to a Chrome trace JSON file, which chrome://tracing
+    /// and ui.perfetto.dev both open.
+    ///
+    /// Each thread writes its events into its own lock-free ring, so
+    /// recording never blocks and threads never contend; a background
+    /// thread drains the rings to disk every 50ms. If a ring fills up
+    /// before it is drained, further events from that thread are
+    /// dropped and counted. When tracing is off, recording is a single
+    /// relaxed load.
+    ///
+    /// Event names are not copied and must outlive the trace; in
+    /// practice they are string literals. The file is written in the
+    /// JSON array format, which loads even if the process dies before
+    /// stop() closes it off.
+    class Tracer
+    {
+      public:
+        static Tracer & instance();
+
+        /// Starts writing a new trace to path, stopping
+        /// any trace in progress. Throws if path can't be opened.
+        void start(std::string const & path);
+
+        /// Flushes what remains and closes the file
+        void stop();
+
+        bool enabled() const
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        /// A span that began at startNanoseconds (see now())
+        void complete(char const * name,
+                      std::uint64_t const startNanoseconds,
+                      std::uint64_t const durationNanoseconds);
+
+        /// A point event at the current time
+        void instant(char const * name);
+
+        /// Labels the calling thread's row in the timeline
+        void setThreadName(std::string const & name);
+
+        /// Events lost to full rings since start
+        std::uint64_t droppedEvents() const;
+
+        /// Steady clock time in nanoseconds
+        static std::uint64_t now()
+        {
+            auto const t = std::chrono::steady_clock::now().time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+        }
+
+      private:
+        Tracer();
+
+        std::atomic<bool> m_enabled;
+
+        /// Trace timestamps are relative to when it started
+        std::uint64_t m_origin;
+
+        /// Serializes start and stop
+        std::mutex m_controlMutex;
+
+        /// Guards m_buffers and thread names
+        mutable std::mutex m_buffersMutex;
+        std::vector<std::unique_ptr<detail::TraceBuffer>> m_buffers;
+
+        std::mutex m_flushMutex;
+        std::condition_variable m_flushCond;
+        bool m_stopFlushing;
+        std::thread m_flusher;
+        std::ofstream m_out;
+        bool m_firstEvent;
+
+        detail::TraceBuffer & threadBuffer();
+        void flushLoop();
+        void drain();
+    };
+
+    /// Records its lifetime as a span, if tracing
+    class TraceScope
+    {
+      public:
+        explicit TraceScope(char const * name)
+          : m_name(name)
+          , m_start(Tracer::instance().enabled() ? Tracer::now() : 0)
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (m_start != 0) {
+                Tracer::instance().complete(m_name, m_start, Tracer::now() - m_start);
+            }
+        }
+
+        TraceScope(TraceScope const &) = delete;
+        TraceScope & operator=(TraceScope const &) = delete;
+
+      private:
+        char const * m_name;
+        std::uint64_t const m_start;
+    };
+}
@@ -0,0 +1,41 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Allocations.hpp"
+#include <atomic>
+
+namespace {
+    std::atomic<bool> g_counted{false};
+    std::atomic<std::uint64_t> g_allocations{0};
+    std::atomic<std::uint64_t> g_bytes{0};
+}
+
+namespace instrument {
+
+    bool allocationsCounted()
+    {
+        return g_counted.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t allocationCount()
+    {
+        return g_allocations.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t allocatedBytes()
+    {
+        return g_bytes.load(std::memory_order_relaxed);
+    }
+
+    namespace detail {
+        void countAllocation(std::size_t const bytes)
+        {
+            g_allocations.fetch_add(1, std::memory_order_relaxed);
+            g_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void markAllocationsCounted()
+        {
+            g_counted = true;
+        }
+    }
+}
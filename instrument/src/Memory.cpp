@@ -0,0 +1,58 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Memory.hpp"
+
+#include <sys/resource.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace instrument {
+
+    std::uint64_t residentBytes()
+    {
+#if defined(__APPLE__)
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                      reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+            return 0;
+        }
+        return info.resident_size;
+#elif defined(__linux__)
+        // Second field of statm is the resident page count
+        auto * statm = std::fopen("/proc/self/statm", "r");
+        if (!statm) {
+            return 0;
+        }
+        unsigned long size = 0;
+        unsigned long resident = 0;
+        auto const read = std::fscanf(statm, "%lu %lu", &size, &resident);
+        std::fclose(statm);
+        if (read != 2) {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(resident) * ::sysconf(_SC_PAGESIZE);
+#else
+        return 0;
+#endif
+    }
+
+    std::uint64_t peakResidentBytes()
+    {
+        rusage usage;
+        if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#if defined(__APPLE__)
+        // Bytes on macOS, kilobytes elsewhere
+        return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+}
@@ -0,0 +1,88 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Metrics.hpp"
+#include <cmath>
+#include <utility>
+
+namespace instrument {
+
+    Counter::Counter(std::string name)
+      : m_name(std::move(name))
+      , m_value(0)
+    {
+    }
+
+    std::string const & Counter::name() const
+    {
+        return m_name;
+    }
+
+    Histogram::Histogram(std::string name)
+      : m_name(std::move(name))
+      , m_count(0)
+      , m_total(0)
+      , m_max(0)
+    {
+        for (auto & bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::string const & Histogram::name() const
+    {
+        return m_name;
+    }
+
+    std::uint64_t Histogram::count() const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Histogram::total() const
+    {
+        return m_total.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Histogram::max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    Histogram::Buckets Histogram::buckets() const
+    {
+        Buckets out;
+        for (int b = 0; b < BUCKETS; ++b) {
+            out[b] = m_buckets[b].load(std::memory_order_relaxed);
+        }
+        return out;
+    }
+
+    double Histogram::percentile(Buckets const & buckets, double const q)
+    {
+        std::uint64_t count = 0;
+        for (auto const c : buckets) {
+            count += c;
+        }
+        if (count == 0) {
+            return 0;
+        }
+
+        auto const rank = q * count;
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            if (buckets[b] == 0) {
+                continue;
+            }
+            if (seen + buckets[b] >= rank) {
+                if (b == 0) {
+                    return 0;
+                }
+                auto const low = std::ldexp(1.0, b - 1);
+                auto const within = (rank - seen) / buckets[b];
+                return low + within * low;
+            }
+            seen += buckets[b];
+        }
+        return std::ldexp(1.0, BUCKETS - 1);
+    }
+}
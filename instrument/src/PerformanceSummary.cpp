@@ -0,0 +1,73 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/PerformanceSummary.hpp"
+#include <cstdio>
+
+namespace {
+
+    double counterRate(instrument::Snapshot const & delta,
+                       std::string const & name,
+                       double const seconds)
+    {
+        auto const * counter = delta.counter(name);
+        return counter ? counter->value / seconds : 0.0;
+    }
+
+    std::string line(char const * label, char const * format, double const value)
+    {
+        char buffer[64];
+        auto const n = std::snprintf(buffer, sizeof(buffer), "%-16s", label);
+        std::snprintf(buffer + n, sizeof(buffer) - n, format, value);
+        return buffer;
+    }
+}
+
+namespace instrument {
+
+    PerformanceSummary PerformanceSummary::between(Snapshot const & earlier,
+                                                   Snapshot const & later)
+    {
+        PerformanceSummary summary;
+        summary.residentBytes = later.residentBytes;
+        summary.seconds = later.secondsSince(earlier);
+        if (summary.seconds <= 0) {
+            return summary;
+        }
+
+        auto const delta = later.since(earlier);
+        summary.ticksPerSecond = counterRate(delta, "sim.ticks", summary.seconds);
+        summary.substepsPerSecond = counterRate(delta, "physics.substeps", summary.seconds);
+        summary.agentStepsPerSecond = counterRate(delta, "agent.steps", summary.seconds);
+        summary.evaluationsPerSecond = counterRate(delta, "evolution.evaluations", summary.seconds);
+        if (delta.counter("memory.allocations")) {
+            summary.allocationsPerSecond = counterRate(delta, "memory.allocations", summary.seconds);
+        }
+        if (auto const * tick = delta.timer("sim.tick")) {
+            summary.meanTickMilliseconds = tick->meanNanoseconds() / 1e6;
+            summary.p99TickMilliseconds = tick->percentileNanoseconds(0.99) / 1e6;
+        }
+        if (auto const * frame = delta.timer("render.frame")) {
+            summary.framesPerSecond = frame->count / summary.seconds;
+        }
+        return summary;
+    }
+
+    std::vector<std::string> PerformanceSummary::lines() const
+    {
+        std::vector<std::string> out;
+        out.push_back(line("ticks/s", "%.1f", ticksPerSecond));
+        out.push_back(line("substeps/s", "%.0f", substepsPerSecond));
+        out.push_back(line("agent steps/s", "%.0f", agentStepsPerSecond));
+        out.push_back(line("tick mean", "%.2f ms", meanTickMilliseconds));
+        out.push_back(line("tick p99", "%.2f ms", p99TickMilliseconds));
+        out.push_back(line("render fps", "%.1f", framesPerSecond));
+        out.push_back(line("evaluations/s", "%.1f", evaluationsPerSecond));
+        if (allocationsPerSecond < 0) {
+            out.emplace_back("allocs/s        not counted");
+        } else {
+            out.push_back(line("allocs/s", "%.0f", allocationsPerSecond));
+        }
+        out.push_back(line("resident", "%.1f MB", residentBytes / (1024.0 * 1024.0)));
+        return out;
+    }
+}
@@ -0,0 +1,74 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Registry.hpp"
+#include "instrument/Allocations.hpp"
+#include "instrument/Memory.hpp"
+#include <chrono>
+
+namespace instrument {
+
+    Registry & Registry::instance()
+    {
+        // Never destroyed, so that threads still running during
+        // static destruction can't count into a dead registry
+        static Registry * registry = new Registry;
+        return *registry;
+    }
+
+    Counter & Registry::counter(std::string const & name)
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        for (auto & counter : m_counters) {
+            if (counter.name() == name) {
+                return counter;
+            }
+        }
+        m_counters.emplace_back(name);
+        return m_counters.back();
+    }
+
+    Histogram & Registry::timer(std::string const & name)
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        for (auto & timer : m_timers) {
+            if (timer.name() == name) {
+                return timer;
+            }
+        }
+        m_timers.emplace_back(name);
+        return m_timers.back();
+    }
+
+    Snapshot Registry::snapshot() const
+    {
+        Snapshot snapshot;
+        auto const now = std::chrono::steady_clock::now().time_since_epoch();
+        snapshot.timestampNanoseconds =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+        snapshot.residentBytes = residentBytes();
+
+        std::lock_guard<std::mutex> lg(m_mutex);
+        snapshot.counters.reserve(m_counters.size() + 2);
+        for (auto const & counter : m_counters) {
+            snapshot.counters.push_back({counter.name(), counter.value()});
+        }
+        if (allocationsCounted()) {
+            snapshot.counters.push_back({"memory.allocations", allocationCount()});
+            snapshot.counters.push_back({"memory.allocated_bytes", allocatedBytes()});
+        }
+        snapshot.timers.reserve(m_timers.size());
+        for (auto const & timer : m_timers) {
+            snapshot.timers.push_back({timer.name(),
+                                       timer.count(),
+                                       timer.total(),
+                                       timer.max(),
+                                       timer.buckets()});
+        }
+        return snapshot;
+    }
+
+    Snapshot snapshot()
+    {
+        return Registry::instance().snapshot();
+    }
+}
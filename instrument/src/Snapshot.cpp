@@ -0,0 +1,66 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Snapshot.hpp"
+#include <algorithm>
+
+namespace instrument {
+
+    double TimerSample::meanNanoseconds() const
+    {
+        return count == 0 ? 0.0 : static_cast<double>(totalNanoseconds) / count;
+    }
+
+    double TimerSample::percentileNanoseconds(double const q) const
+    {
+        // Interpolating within a bucket can overshoot the true maximum
+        return std::min(Histogram::percentile(buckets, q),
+                        static_cast<double>(maxNanoseconds));
+    }
+
+    CounterSample const * Snapshot::counter(std::string const & name) const
+    {
+        for (auto const & counter : counters) {
+            if (counter.name == name) {
+                return &counter;
+            }
+        }
+        return nullptr;
+    }
+
+    TimerSample const * Snapshot::timer(std::string const & name) const
+    {
+        for (auto const & timer : timers) {
+            if (timer.name == name) {
+                return &timer;
+            }
+        }
+        return nullptr;
+    }
+
+    Snapshot Snapshot::since(Snapshot const & earlier) const
+    {
+        // Metrics are only ever added, so anything missing
+        // from the earlier snapshot started out at zero
+        Snapshot delta(*this);
+        for (auto & counter : delta.counters) {
+            if (auto const * before = earlier.counter(counter.name)) {
+                counter.value -= before->value;
+            }
+        }
+        for (auto & timer : delta.timers) {
+            if (auto const * before = earlier.timer(timer.name)) {
+                timer.count -= before->count;
+                timer.totalNanoseconds -= before->totalNanoseconds;
+                for (int b = 0; b < Histogram::BUCKETS; ++b) {
+                    timer.buckets[b] -= before->buckets[b];
+                }
+            }
+        }
+        return delta;
+    }
+
+    double Snapshot::secondsSince(Snapshot const & earlier) const
+    {
+        return (timestampNanoseconds - earlier.timestampNanoseconds) / 1e9;
+    }
+}
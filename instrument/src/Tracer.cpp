@@ -0,0 +1,237 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "instrument/Tracer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+namespace instrument {
+
+    namespace detail {
+
+        struct TraceEvent
+        {
+            char const * name;
+            std::uint64_t start;
+            std::uint64_t duration;
+            char phase;
+        };
+
+        /// One thread's events; that thread is the only producer
+        /// and the flushing thread the only consumer
+        struct TraceBuffer
+        {
+            static std::size_t const CAPACITY = 1 << 16;
+
+            explicit TraceBuffer(int const threadId)
+              : tid(threadId)
+              , events(CAPACITY)
+              , head(0)
+              , tail(0)
+              , dropped(0)
+            {
+            }
+
+            void push(TraceEvent const & event)
+            {
+                auto const h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                events[h & (CAPACITY - 1)] = event;
+                head.store(h + 1, std::memory_order_release);
+            }
+
+            int const tid;
+            std::vector<TraceEvent> events;
+
+            /// Guarded by Tracer::m_buffersMutex
+            std::string name;
+            std::string writtenName;
+
+            alignas(64) std::atomic<std::size_t> head;
+            alignas(64) std::atomic<std::size_t> tail;
+            std::atomic<std::uint64_t> dropped;
+        };
+    }
+
+    namespace {
+        thread_local detail::TraceBuffer * t_buffer = nullptr;
+    }
+
+    Tracer & Tracer::instance()
+    {
+        // Never destroyed, so that threads still running
+        // during static destruction can't record into a dead tracer
+        static Tracer * tracer = new Tracer;
+        return *tracer;
+    }
+
+    Tracer::Tracer()
+      : m_enabled(false)
+      , m_origin(0)
+      , m_buffers()
+      , m_stopFlushing(false)
+      , m_firstEvent(true)
+    {
+    }
+
+    detail::TraceBuffer & Tracer::threadBuffer()
+    {
+        if (!t_buffer) {
+            std::lock_guard<std::mutex> lg(m_buffersMutex);
+            auto const tid = static_cast<int>(m_buffers.size()) + 1;
+            m_buffers.push_back(std::make_unique<detail::TraceBuffer>(tid));
+            t_buffer = m_buffers.back().get();
+        }
+        return *t_buffer;
+    }
+
+    void Tracer::complete(char const * name,
+                          std::uint64_t const startNanoseconds,
+                          std::uint64_t const durationNanoseconds)
+    {
+        if (enabled()) {
+            threadBuffer().push({name, startNanoseconds, durationNanoseconds, 'X'});
+        }
+    }
+
+    void Tracer::instant(char const * name)
+    {
+        if (enabled()) {
+            threadBuffer().push({name, now(), 0, 'i'});
+        }
+    }
+
+    void Tracer::setThreadName(std::string const & name)
+    {
+        auto & buffer = threadBuffer();
+        std::lock_guard<std::mutex> lg(m_buffersMutex);
+        buffer.name = name;
+    }
+
+    std::uint64_t Tracer::droppedEvents() const
+    {
+        std::lock_guard<std::mutex> lg(m_buffersMutex);
+        std::uint64_t dropped = 0;
+        for (auto const & buffer : m_buffers) {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    void Tracer::start(std::string const & path)
+    {
+        stop();
+        std::lock_guard<std::mutex> control(m_controlMutex);
+        m_out.open(path, std::ios::trunc);
+        if (!m_out) {
+            throw std::runtime_error("Tracer: failed to open " + path);
+        }
+        m_out << "[";
+        m_firstEvent = true;
+        m_origin = now();
+
+        // Nothing is consuming at this point, so leftovers from a
+        // previous trace can be skipped by moving the tails up
+        {
+            std::lock_guard<std::mutex> lg(m_buffersMutex);
+            for (auto & buffer : m_buffers) {
+                buffer->tail.store(buffer->head.load(std::memory_order_acquire),
+                                   std::memory_order_release);
+                buffer->dropped.store(0, std::memory_order_relaxed);
+                buffer->writtenName.clear();
+            }
+        }
+
+        m_stopFlushing = false;
+        m_flusher = std::thread(&Tracer::flushLoop, this);
+        m_enabled.store(true, std::memory_order_release);
+    }
+
+    void Tracer::stop()
+    {
+        std::lock_guard<std::mutex> control(m_controlMutex);
+        if (!m_flusher.joinable()) {
+            return;
+        }
+        m_enabled.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lg(m_flushMutex);
+            m_stopFlushing = true;
+        }
+        m_flushCond.notify_all();
+        m_flusher.join();
+        drain();
+        m_out << "\n]\n";
+        m_out.close();
+    }
+
+    void Tracer::flushLoop()
+    {
+        std::unique_lock<std::mutex> ul(m_flushMutex);
+        while (!m_stopFlushing) {
+            m_flushCond.wait_for(ul, std::chrono::milliseconds(50),
+                                 [this]{ return m_stopFlushing; });
+            ul.unlock();
+            drain();
+            ul.lock();
+        }
+    }
+
+    void Tracer::drain()
+    {
+        std::vector<detail::TraceBuffer *> buffers;
+        std::vector<std::pair<int, std::string>> names;
+        {
+            std::lock_guard<std::mutex> lg(m_buffersMutex);
+            for (auto & buffer : m_buffers) {
+                buffers.push_back(buffer.get());
+                if (buffer->name != buffer->writtenName) {
+                    names.emplace_back(buffer->tid, buffer->name);
+                    buffer->writtenName = buffer->name;
+                }
+            }
+        }
+
+        char line[256];
+        auto const separator = [this]() -> char const * {
+            auto const first = m_firstEvent;
+            m_firstEvent = false;
+            return first ? "\n" : ",\n";
+        };
+        for (auto const & name : names) {
+            std::snprintf(line, sizeof(line),
+                          "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                          "\"args\":{\"name\":\"%s\"}}",
+                          separator(), name.first, name.second.c_str());
+            m_out << line;
+        }
+
+        for (auto * buffer : buffers) {
+            auto tail = buffer->tail.load(std::memory_order_relaxed);
+            auto const head = buffer->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                auto const & event = buffer->events[tail & (detail::TraceBuffer::CAPACITY - 1)];
+                auto const ts = (static_cast<double>(event.start) - m_origin) / 1000.0;
+                if (event.phase == 'X') {
+                    std::snprintf(line, sizeof(line),
+                                  "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                                  "\"pid\":1,\"tid\":%d}",
+                                  separator(), event.name, ts, event.duration / 1000.0,
+                                  buffer->tid);
+                } else {
+                    std::snprintf(line, sizeof(line),
+                                  "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,"
+                                  "\"pid\":1,\"tid\":%d}",
+                                  separator(), event.name, ts, buffer->tid);
+                }
+                m_out << line;
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+        m_out.flush();
+    }
+}
@@ -3,6 +3,8 @@
 #include "model/Animat.hpp"
 #include "model/AnimatWorld.hpp"
 #include "simulator/Agent.hpp"
+#include "simulator/Islands.hpp"
+#include "simulator/Replay.hpp"
 #include "simulator/Simulation.hpp"
 
 #include "graphics/GLEnvironment.hpp"
@@ -11,25 +13,35 @@
 #include "graphics/GLVerticalSlider.hpp"
 #include "graphics/GLCircularDial.hpp"
 #include "graphics/PauseOverlay.hpp"
-#include "graphics/ThreadRunner.hpp"
+#include "graphics/Scheduler.hpp"
 #include "graphics/RetinaScalar.hpp"
 #include "glfreetype/TextRenderer.hpp"
+#include "instrument/Tracer.hpp"
+
+#if defined(SIMPLAY_COUNT_ALLOCATIONS)
+#include "instrument/AllocationHook.hpp"
+#endif
 
 #include <GLFW/glfw3.h>
 
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unistd.h>
 
 int windowWidth = 800;
 int windowHeight = 800;
 int popSize = 20;
 
-// For running operations asynchronously
-graphics::detail::ThreadRunner threadRunner;
+// How often the simulation is checkpointed (in ticks) when
+// a checkpoint file is passed on the command line
+long checkpointEvery = 5000;
 
 std::unique_ptr<graphics::Graphics> graphix;
 
@@ -50,6 +62,50 @@ void clickHandler(GLFWwindow* , int button, int action, int mods)
 int main(int argc, char **argv)
 {
 
+    // Headless mode: no window is opened; instead the world is
+    // rendered in software to images in a directory every so
+    // many ticks, until the process is killed
+    if (argc > 2 && std::string(argv[1]) == "--headless") {
+        simulator::Simulation sim(popSize);
+        auto const everyN = argc > 3 ? std::atol(argv[3]) : 100L;
+        try {
+            sim.startFrameCapture(argv[2], everyN);
+        } catch (std::exception const & e) {
+            std::cout << e.what() << std::endl;
+            return -1;
+        }
+        sim.start();
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+
+    // Island mode: several populations evolve in worker processes,
+    // exchanging their fittest genomes now and then
+    if (argc > 2 && std::string(argv[1]) == "--islands") {
+        simulator::IslandOptions options;
+        options.islands = std::max(1, std::atoi(argv[2]));
+        options.popSize = popSize;
+        if (argc > 3) {
+            options.ticks = std::max(1L, std::atol(argv[3]));
+        }
+        if (argc > 4) {
+            options.migrateEvery = std::max(1L, std::atol(argv[4]));
+        }
+        try {
+            return simulator::runIslands(options, std::cout);
+        } catch (std::exception const & e) {
+            std::cout << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // For running operations asynchronously and animating the GUI.
+    // Made here, after the modes above, so that no thread exists
+    // when islands fork: a child forked while the scheduler thread
+    // is initialising the tracer would deadlock on it.
+    graphics::Scheduler scheduler;
+
     GLFWwindow* window;
 
     /* Initialize the library */
@@ -76,24 +132,44 @@ int main(int argc, char **argv)
 
     simulator::Simulation sim(popSize);
 
-    model::AnimatWorld & animatWorld = sim.animatWorld();
+    // Replay mode: play a recorded trajectory back
+    // instead of running the simulation
+    std::unique_ptr<simulator::Replay> replay;
+    if (argc > 2 && std::string(argv[1]) == "--replay") {
+        replay = std::make_unique<simulator::Replay>(argv[2]);
+    }
+
+    // Optional checkpoint file: restored from if it exists
+    // and periodically written to from then on. A .flat
+    // extension selects the memory-mapped flat format.
+    else if (argc > 1) {
+        std::string const checkpointPath(argv[1]);
+        if (sim.restore(checkpointPath)) {
+            std::cout << "Restored from " << checkpointPath << std::endl;
+        }
+        auto const flatSuffix = std::string(".flat");
+        auto const flat = checkpointPath.size() > flatSuffix.size() &&
+            checkpointPath.compare(checkpointPath.size() - flatSuffix.size(),
+                                   flatSuffix.size(), flatSuffix) == 0;
+        sim.enableCheckpointing(checkpointPath, checkpointEvery,
+                                flat ? simulator::CheckpointFormat::Flat
+                                     : simulator::CheckpointFormat::Stream);
+    }
+
+    model::AnimatWorld & animatWorld = replay ? replay->animatWorld()
+                                              : sim.animatWorld();
     auto viewDistance = 0.4;
     graphics::GLEnvironment glEnvironment(windowWidth, 
                                           windowHeight,
                                           viewDistance,
                                           animatWorld,
-                                          threadRunner);
-
-    animatWorld.setAnimatUpdatedObserver([&glEnvironment]
-        (int const index, std::shared_ptr<model::Animat> animat) {
-        glEnvironment.updateAnimat(index, std::move(animat));
-    });
+                                          scheduler);
 
     // GUI agnostics GL calls
     graphix.reset(new graphics::Graphics(windowWidth, 
                                          windowHeight, 
                                          glEnvironment,
-                                         threadRunner));
+                                         scheduler));
 
     // Callbacks
     glfwSetWindowSizeCallback(window, reshape);
@@ -107,10 +183,12 @@ int main(int argc, char **argv)
     auto button = std::make_shared<graphics::GLButton>(window,
                                                        20, 20,
                                                        80, 50,
-                                                       threadRunner);
+                                                       scheduler);
 
     button->installHandler([&](bool const state) {
-        if (state) {
+        if (replay) {
+            state ? replay->pause() : replay->resume();
+        } else if (state) {
             sim.pause();
         } else {
             sim.resume();
@@ -122,7 +200,7 @@ int main(int argc, char **argv)
     auto slider = std::make_shared<graphics::GLVerticalSlider>(window,
                                                                25, // offset from right
                                                                15, // bar width
-                                                               threadRunner);
+                                                               scheduler);
     slider->installHandler([&](double const value) {
 
         auto comp = 1.0 - (value + 0.1);
@@ -137,13 +215,19 @@ int main(int argc, char **argv)
     auto dial = std::make_shared<graphics::GLCircularDial>(window, 160, 45,
                                                            25.0, /* radius */
                                                            100, /* start level */
-                                                           threadRunner);
+                                                           scheduler);
     dial->installHandler([&](int const value) {
         if(value >= 0 && value <= 100) {
             auto actual = 100 - value;
             double ratio = static_cast<double>(actual) / 100.0;
             auto const toSet = static_cast<int>(ratio * 50000.0);
             sim.setSleepDuration(toSet);
+
+            // In replay the dial sets playback speed instead,
+            // fast-forwarding up to 100x the default rate
+            if (replay) {
+                replay->setSpeed(60.0 * std::max(value, 1));
+            }
         }
     });
 
@@ -151,7 +235,44 @@ int main(int argc, char **argv)
     graphix->addGUIElement(std::move(slider));
     graphix->addGUIElement(std::move(dial));
 
-    graphix->setGraphicsConsoleCallback([&sim](std::string command) {
+    graphix->setGraphicsConsoleCallback([&sim, &replay](std::string command) {
+        // Tracing and stats work the same in either mode
+        if(command.find("trace off") == 0) {
+            instrument::Tracer::instance().stop();
+            return;
+        } else if(command.find("trace ") == 0) {
+            try {
+                instrument::Tracer::instance().start(command.substr(6));
+            } catch (std::exception const & e) {
+                std::cout << e.what() << std::endl;
+            }
+            return;
+        } else if(command.find("stats on") == 0) {
+            graphix->showStats(true);
+            return;
+        } else if(command.find("stats off") == 0) {
+            graphix->showStats(false);
+            return;
+        } else if(command.find("stats") == 0) {
+            graphix->printStats(std::cout);
+            return;
+        }
+        if(replay) {
+            if(command.find("pause") == 0) {
+                replay->pause();
+            } else if(command.find("resume") == 0) {
+                replay->resume();
+            } else if(command.find("seek ") == 0) {
+                replay->seek(std::atol(command.c_str() + 5));
+            } else if(command.find("step ") == 0) {
+                replay->step(std::atol(command.c_str() + 5));
+            } else if(command.find("speed ") == 0) {
+                replay->setSpeed(std::atof(command.c_str() + 6));
+            } else if(command.find("ant") == 0) {
+                graphix->toggleAntennaeDraw();
+            }
+            return;
+        }
         if(command.find("pause") == 0) {
             sim.pause();
         } else if(command.find("resume") == 0) {
@@ -163,9 +284,31 @@ int main(int argc, char **argv)
         } else if(command.find("ant") == 0) {
             graphix->toggleAntennaeDraw();
         } else if(command.find("collisions on") == 0) {
-            sim.enableCollisionHandling();
+            try {
+                sim.enableCollisionHandling();
+            } catch (std::exception const & e) {
+                std::cout << e.what() << std::endl;
+            }
         } else if(command.find("collisions off") == 0) {
             sim.disableCollisionHandling();
+        } else if(command.find("save") == 0) {
+            sim.requestCheckpoint();
+        } else if(command.find("frames off") == 0) {
+            sim.stopFrameCapture();
+        } else if(command.find("frames ") == 0) {
+            try {
+                sim.startFrameCapture(command.substr(7));
+            } catch (std::exception const & e) {
+                std::cout << e.what() << std::endl;
+            }
+        } else if(command.find("record off") == 0) {
+            sim.stopRecording();
+        } else if(command.find("record ") == 0) {
+            try {
+                sim.startRecording(command.substr(7));
+            } catch (std::exception const & e) {
+                std::cout << e.what() << std::endl;
+            }
         }
     });
 
@@ -176,8 +319,14 @@ int main(int argc, char **argv)
     sy *= graphics::detail::retinaScalar();
     std::cout << sx << std::endl;
 
-    // Start the main simulation loop
-    sim.start();
+    // Start the main simulation loop, or playback
+    if (replay) {
+        replay->start();
+    } else {
+        sim.start();
+    }
+
+    instrument::Tracer::instance().setThreadName("render");
 
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window)) {
@@ -194,6 +343,8 @@ int main(int argc, char **argv)
         glfwPollEvents();
 
     }
+    scheduler.shutdown();
+    instrument::Tracer::instance().stop();
     glfwTerminate();
     return 0;
 }
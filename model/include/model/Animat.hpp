@@ -13,8 +13,15 @@
 #include <mutex>
 #include <memory>
 
+namespace serial {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace model {
 
+    struct WorldSnapshot;
+
     class Animat
     {
 
@@ -32,8 +39,8 @@ namespace model {
 
         void applyWaterForces();
 
-        /// Integrates animat physics
-        void update();
+        /// Integrates animat physics over timeStep
+        void update(double const timeStep = 0.1);
 
         /// To update the derived components (antenna, bounding circles etc.).
         /// Usually a call to this won't ne necessary as derivation will happen
@@ -68,6 +75,16 @@ namespace model {
         /// To reset the animat structure after bad physics
         void resetAnimatStructure();
 
+        /// Changes the number of blocks in place. The body is returned
+        /// to its initial structure, as if newly constructed, but the
+        /// physics storage is reused: layers common to both sizes keep
+        /// their point masses and nothing is reallocated up to
+        /// RESERVED_BLOCKS blocks.
+        void resize(int const blocks);
+
+        /// Storage for at least this many blocks is reserved up front
+        static constexpr int RESERVED_BLOCKS = 12;
+
         /// Retrieve the population ID of this animat
         int getID() const;
 
@@ -86,8 +103,30 @@ namespace model {
         /// Handle collisions
         bool checkForCollisionWithOther(std::shared_ptr<Animat> other, bool const resolve = true);
 
+        /// Checkpointing of physics state and species colour. The
+        /// animat being loaded into must have the same block count.
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Flat equivalents of save and load
+        void exportState(physics::PointMassState * masses,
+                         physics::SpringState * springs) const;
+        void importState(physics::PointMassState const * masses,
+                         physics::SpringState const * springs);
+
+        /// Appends this animat's geometry and colour to a render
+        /// snapshot. Must be called from the thread that updates the
+        /// animat, as positions are read without locking.
+        void appendToSnapshot(WorldSnapshot & snapshot);
+
       private:
         int m_id;
+        double m_blockWidth;
+        double m_blockHeight;
+
+        /// Blocks that the storage below has room for
+        int m_reservedBlocks;
+
         std::vector<AnimatLayer> m_layers;
         std::vector<AnimatBlock> m_blocks;
         physics::PhysicsEngine m_physicsEngine;
@@ -110,6 +149,14 @@ namespace model {
 
         void constructAntennae();
 
+        /// Reserves layer, block and bounding circle storage
+        void reserve(int const blocks);
+
+        /// Adds layers, blocks and bounding circles for a body of the
+        /// given size. The first existingLayers layers are built over
+        /// point masses already in the physics engine.
+        void build(int const blocks, int const existingLayers);
+
         /// Derived components are those whose geometry are calculated
         /// from pre-existing point mass information
         void doUpdateDerivedComponents();
@@ -28,6 +28,12 @@ namespace model {
                     double const width,
                     physics::PhysicsEngine & physicsEngine);
 
+        /// Rebuilds a layer over point masses already in the engine,
+        /// adding only the spring across it
+        AnimatLayer(int const indexLeft,
+                    int const indexRight,
+                    physics::PhysicsEngine & physicsEngine);
+
         AnimatLayer() = delete;
 
         int getIndexLeft() const;
@@ -6,7 +6,9 @@
 /// Responsible for initializing and updating the world.
 
 #include "Animat.hpp"
-#include <functional>
+#include "TripleBuffer.hpp"
+#include "WorldSnapshot.hpp"
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -14,7 +16,9 @@ namespace model {
     class AnimatWorld
     {
        public:
-         AnimatWorld(int const populationSize);
+         /// seed is for the random placement of animats; 0 seeds
+         /// from the clock
+         AnimatWorld(int const populationSize, unsigned const seed = 0);
          AnimatWorld() = delete;
 
          /// Randomizes individual placements with bounds
@@ -42,35 +46,53 @@ namespace model {
                                      double const boundX,
                                      double const boundY);
 
-         /// Rebuild a given animat with an updated number
-         /// of body segments.
+         /// Rebuild a given animat with an updated number of body
+         /// segments. The animat is resized in place, so anything
+         /// holding it stays bound; the renderer sees the new body
+         /// in the next published snapshot.
          void reconstructAnimat(int const index, int const segments);
 
-         /// The observer that gets triggered before and after updating
-         /// the physical morphology of a given animat so that the
-         /// graphics subsystem can be appropriately locked
-         void setAnimatUpdatedObserver
-         (std::function<void(int const, std::shared_ptr<Animat>)> func);
-
-         static std::vector<std::shared_ptr<std::mutex>> g_fuckers;
-
          void incrementOptimizationCount();
          long getOptimizationCount() const;
+         void setOptimizationCount(long const optimizations);
+
+         /// Checkpointing of every animat plus the optimization
+         /// count. On load, animats whose block count differs from
+         /// the saved one are reconstructed first.
+         void save(serial::BinaryWriter & writer) const;
+         void load(serial::BinaryReader & reader);
+
+         /// Copies the geometry of every animat into snapshot. Same
+         /// threading rules as publishSnapshot.
+         void fillSnapshot(WorldSnapshot & snapshot, long const tick);
+
+         /// Copies the geometry of every animat into a snapshot and
+         /// hands it to the renderer. Call from the thread that
+         /// updates the world, between updates; it never blocks.
+         void publishSnapshot(long const tick);
+
+         /// The renderer's end of the snapshot handoff; only
+         /// consume() and front() should be used from there
+         TripleBuffer<WorldSnapshot> & snapshots();
+
+         /// Called by a renderer once it reads snapshots. Until then
+         /// nothing does, so the simulation doesn't publish them
+         /// every tick. Safe to call from any thread.
+         void attachRenderer();
+         bool rendererAttached() const;
 
        private:
          std::vector<std::shared_ptr<model::Animat>> m_animats;
 
-         /// Before updating an animat's geometry, this function
-         /// should be called to lock the graphics observer
-         /// and called againt afterwards to unlock it
-         std::function<void(int const, std::shared_ptr<Animat>)> 
-         m_animatUpdatedObserver;
-
          /// Records the number of times the population
          /// has been optimized. Equivalent to the concept
          /// of 'generation'.
          long m_optimizations;
 
+         /// Per-tick render snapshots, passed lock-free to the renderer
+         TripleBuffer<WorldSnapshot> m_snapshots;
+         std::atomic<bool> m_rendererAttached;
+
          /// Move animat to new relative position in world
          void doTranslateAnimatPosition(int const index,
                                         double const x, 
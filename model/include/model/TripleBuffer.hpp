@@ -0,0 +1,78 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace model {
+
+    /// Hands values from one producer thread to one consumer thread
+    /// without locking. The producer fills the back slot and publishes
+    /// it, which swaps it with the middle slot; the consumer swaps the
+    /// middle slot with its front slot whenever something new has been
+    /// published. Neither side ever waits: the producer simply
+    /// overwrites a value the consumer never got round to taking, and
+    /// the consumer keeps its current value until a newer one arrives.
+    /// Slots are reused, so a T that keeps its capacity (e.g. vectors
+    /// that are cleared rather than freed) costs no allocation once warm.
+    template <typename T>
+    class TripleBuffer
+    {
+      public:
+        TripleBuffer()
+          : m_slots()
+          , m_back(0)
+          , m_middle(1)
+          , m_front(2)
+        {
+        }
+
+        TripleBuffer(TripleBuffer const &) = delete;
+        TripleBuffer & operator=(TripleBuffer const &) = delete;
+
+        /// Producer side: the slot to fill before calling publish
+        T & back()
+        {
+            return m_slots[m_back];
+        }
+
+        /// Producer side: makes the back slot the latest value
+        void publish()
+        {
+            auto const previous = m_middle.exchange(m_back | FRESH,
+                                                    std::memory_order_acq_rel);
+            m_back = previous & INDEX;
+        }
+
+        /// Consumer side: takes the latest published value, if there
+        /// is one. Returns false if nothing new has been published.
+        bool consume()
+        {
+            if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) {
+                return false;
+            }
+            auto const previous = m_middle.exchange(m_front,
+                                                    std::memory_order_acq_rel);
+            m_front = previous & INDEX;
+            return true;
+        }
+
+        /// Consumer side: the most recently consumed value
+        T const & front() const
+        {
+            return m_slots[m_front];
+        }
+
+      private:
+        static constexpr int INDEX = 3;
+        static constexpr int FRESH = 4;
+
+        std::array<T, 3> m_slots;
+
+        /// Each side's own index is kept on its own cache line
+        alignas(64) int m_back;
+        alignas(64) std::atomic<int> m_middle;
+        alignas(64) int m_front;
+    };
+}
@@ -0,0 +1,64 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace model {
+
+    /// Flat copy of what the renderer needs from the world at one
+    /// tick, so that drawing never touches the live physics. Per-block
+    /// arrays are indexed through blockOffsets; everything else is
+    /// indexed by animat. Positions are in world coordinates.
+    struct WorldSnapshot
+    {
+        long tick = 0;
+
+        /// Index of each animat's first block; one extra trailing
+        /// entry so that block counts are adjacent differences
+        std::vector<std::int32_t> blockOffsets;
+
+        /// Per block, the quad layer one left, layer one right, layer
+        /// two right, layer two left, as 8 floats (x, y pairs)
+        std::vector<float> blockCorners;
+
+        /// Per block bounding circle, as x, y, radius
+        std::vector<float> blockCircles;
+
+        /// Per animat central point and radius, as x, y, radius
+        std::vector<float> centralCircles;
+
+        /// Per animat left and right antenna tips, as 4 floats
+        std::vector<float> antennae;
+
+        /// Per animat species colour, as r, g, b
+        std::vector<std::uint8_t> colours;
+
+        /// Per animat ID
+        std::vector<std::int32_t> ids;
+
+        /// Empties every array but keeps its capacity
+        void clear()
+        {
+            tick = 0;
+            blockOffsets.assign(1, 0);
+            blockCorners.clear();
+            blockCircles.clear();
+            centralCircles.clear();
+            antennae.clear();
+            colours.clear();
+            ids.clear();
+        }
+
+        int animatCount() const
+        {
+            return blockOffsets.empty() ? 0 : static_cast<int>(blockOffsets.size()) - 1;
+        }
+
+        int blockCount(int const animat) const
+        {
+            return blockOffsets[animat + 1] - blockOffsets[animat];
+        }
+    };
+}
@@ -1,34 +1,58 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "model/Animat.hpp"
+#include "model/WorldSnapshot.hpp"
+#include "instrument/Instrument.hpp"
 #include "physics/Spring.hpp"
 #include "physics/PointMass.hpp"
 #include "physics/Vector3.hpp"
 #include "physics/WaterForceGenerator.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace model {
 
     Animat::Animat(int const id, AnimatProperties const & props)
       : m_id(id)
-      , m_physicsEngine((props.blocks+1) * 2 /* number of point masses */)
+      , m_blockWidth(props.blockWidth)
+      , m_blockHeight(props.blockHeight)
+      , m_reservedBlocks(std::max(props.blocks, RESERVED_BLOCKS))
+      , m_physicsEngine((m_reservedBlocks+1) * 2 /* number of point masses */)
       , m_antennaeMutex(std::make_shared<std::mutex>())
       , m_centralPointMutex(std::make_shared<std::mutex>())
       , m_physicsBecameUnstable(false)
       , m_speciesColour{ 197, 217, 200 }
+      , m_wrapped(false)
     {
-        auto const layers = props.blocks + 1;
+        reserve(m_reservedBlocks);
+        build(props.blocks, 0);
+    }
+
+    void Animat::reserve(int const blocks)
+    {
+        auto const layers = blocks + 1;
         m_layers.reserve(layers);
         m_blocks.reserve(layers + 1);
         m_boundingCircles.reserve(layers + 1);
+    }
 
-        // construct layers
-        auto const layerWidth = props.blockWidth;
-        auto const blockHeight = props.blockHeight;
+    void Animat::build(int const blocks, int const existingLayers)
+    {
+        auto const layers = blocks + 1;
+
+        // construct layers, the first existingLayers over point
+        // masses already in the physics engine
+        auto const layerWidth = m_blockWidth;
+        auto const blockHeight = m_blockHeight;
         auto yOffset = 0;
         auto xOffset = -(layerWidth / 2); // around zero
         for (int layer = 0; layer < layers; ++layer) {
-            m_layers.emplace_back(xOffset, yOffset, layerWidth, m_physicsEngine);
+            if (layer < existingLayers) {
+                m_layers.emplace_back(layer * 2, layer * 2 + 1, m_physicsEngine);
+            } else {
+                m_layers.emplace_back(xOffset, yOffset, layerWidth, m_physicsEngine);
+            }
             yOffset += blockHeight;
         }
 
@@ -44,7 +68,6 @@ namespace model {
         }
 
         // construct bounding circles
-        m_boundingCircles.reserve(layers - 1);
         for (int block = 0; block < m_layers.size() - 1; ++block) {
             m_boundingCircles.emplace_back(m_blocks[block].deriveBoundingCircle(m_physicsEngine));
         }
@@ -56,6 +79,35 @@ namespace model {
         updateCentralPoint();
     }
 
+    void Animat::resize(int const blocks)
+    {
+        auto const layers = blocks + 1;
+        auto existingLayers = std::min<int>(m_layers.size(), layers);
+
+        // Point masses that stay go back to where they were built, so
+        // that the springs recreated over them get the same rest
+        // lengths as in a freshly constructed body
+        resetAnimatStructure();
+
+        // Blocks refer to layers and springs to point masses, so
+        // everything built on top of the point masses is rebuilt
+        m_boundingCircles.clear();
+        m_blocks.clear();
+        m_layers.clear();
+        if (blocks > m_reservedBlocks) {
+            // Beyond the reserved room; start again from nothing
+            existingLayers = 0;
+            m_reservedBlocks = blocks;
+            m_physicsEngine.truncate(0, 0);
+            m_physicsEngine.reserve(layers * 2);
+            reserve(blocks);
+        } else {
+            m_physicsEngine.truncate(existingLayers * 2, 0);
+        }
+        build(blocks, existingLayers);
+        m_physicsBecameUnstable = false;
+    }
+
     int Animat::getID() const
     {
         return m_id;
@@ -169,6 +221,9 @@ namespace model {
 
     void Animat::applyWaterForces()
     {
+        // Timed as a whole; a single block is too quick to
+        // time on its own without the clock reads dominating
+        INSTRUMENT_SCOPE("physics.water");
         for (auto & block : m_blocks) {
             auto & layerOne = block.getLayerOne();
             auto & layerTwo = block.getLayerTwo();
@@ -196,9 +251,9 @@ namespace model {
         return m_boundingCircles[index];
     }
 
-    void Animat::update()
+    void Animat::update(double const timeStep)
     {
-        m_physicsEngine.update(0.1);
+        m_physicsEngine.update(timeStep);
         doUpdateDerivedComponents();
 
         // That is meant to be an assignment!
@@ -483,6 +538,64 @@ namespace model {
         }
         return collision;
     }
-}
 
+    void Animat::save(serial::BinaryWriter & writer) const
+    {
+        m_physicsEngine.save(writer);
+        writer.write(m_speciesColour);
+    }
+
+    void Animat::load(serial::BinaryReader & reader)
+    {
+        m_physicsEngine.load(reader);
+        reader.read(m_speciesColour);
+        doUpdateDerivedComponents();
+    }
+
+    void Animat::exportState(physics::PointMassState * masses,
+                             physics::SpringState * springs) const
+    {
+        m_physicsEngine.exportState(masses, springs);
+    }
+
+    void Animat::importState(physics::PointMassState const * masses,
+                             physics::SpringState const * springs)
+    {
+        m_physicsEngine.importState(masses, springs);
+        doUpdateDerivedComponents();
+    }
+
+    void Animat::appendToSnapshot(WorldSnapshot & snapshot)
+    {
+        for (int b = 0; b < m_blocks.size(); ++b) {
+            auto const & layerOne = m_layers[b];
+            auto const & layerTwo = m_layers[b + 1];
+            for (auto const index : {layerOne.getIndexLeft(), layerOne.getIndexRight(),
+                                     layerTwo.getIndexRight(), layerTwo.getIndexLeft()}) {
+                auto const & position = m_physicsEngine.getPointMassPositionRef(index);
+                snapshot.blockCorners.push_back(position.m_vec[0]);
+                snapshot.blockCorners.push_back(position.m_vec[1]);
+            }
+            auto const & circle = m_boundingCircles[b];
+            snapshot.blockCircles.push_back(circle.first.m_vec[0]);
+            snapshot.blockCircles.push_back(circle.first.m_vec[1]);
+            snapshot.blockCircles.push_back(circle.second);
+        }
+        snapshot.blockOffsets.push_back(snapshot.blockOffsets.back() + m_blocks.size());
+
+        snapshot.centralCircles.push_back(m_centralPoint.first.m_vec[0]);
+        snapshot.centralCircles.push_back(m_centralPoint.first.m_vec[1]);
+        snapshot.centralCircles.push_back(m_centralPoint.second);
 
+        snapshot.antennae.push_back(m_leftAntenna.m_vec[0]);
+        snapshot.antennae.push_back(m_leftAntenna.m_vec[1]);
+        snapshot.antennae.push_back(m_rightAntenna.m_vec[0]);
+        snapshot.antennae.push_back(m_rightAntenna.m_vec[1]);
+
+        snapshot.colours.push_back(static_cast<std::uint8_t>(m_speciesColour.R));
+        snapshot.colours.push_back(static_cast<std::uint8_t>(m_speciesColour.G));
+        snapshot.colours.push_back(static_cast<std::uint8_t>(m_speciesColour.B));
+
+        snapshot.ids.push_back(m_id);
+    }
+}
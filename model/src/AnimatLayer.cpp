@@ -28,6 +28,17 @@ namespace model {
         physicsEngine.createSpring(m_indexLeft, m_indexRight, constant, dampener);
     }
 
+    AnimatLayer::AnimatLayer(int const indexLeft,
+                             int const indexRight,
+                             physics::PhysicsEngine & physicsEngine)
+      : m_indexLeft(indexLeft)
+      , m_indexRight(indexRight)
+    {
+        auto constant = 100;
+        auto dampener = 0.9;
+        physicsEngine.createSpring(m_indexLeft, m_indexRight, constant, dampener);
+    }
+
     physics::Vector3
     AnimatLayer::getLeftToRightVector(physics::PhysicsEngine const & physicsEngine) const 
     {
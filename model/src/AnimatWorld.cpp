@@ -2,7 +2,8 @@
 
 #include "model/AnimatProperties.hpp"
 #include "model/AnimatWorld.hpp"
-#include "physics/Matrix.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
 #include <cstdlib> // rand
 #include <ctime> // time
 #include <cmath>
@@ -10,12 +11,11 @@
 
 namespace model {
 
-    std::vector<std::shared_ptr<std::mutex>> AnimatWorld::g_fuckers;
-
-    AnimatWorld::AnimatWorld(int const populationSize)
+    AnimatWorld::AnimatWorld(int const populationSize, unsigned const seed)
       : m_animats()
-      , m_animatUpdatedObserver()
       , m_optimizations(0)
+      , m_snapshots()
+      , m_rendererAttached(false)
     {
         m_animats.reserve(populationSize);
         auto blocks = 4;
@@ -35,12 +35,7 @@ namespace model {
         }
 
         // seed random generator for random pop placement
-        ::srand(::time(NULL));
-
-        if(g_fuckers.empty()) {
-            g_fuckers.push_back(std::make_shared<std::mutex>());
-        }
-
+        ::srand(seed ? seed : ::time(NULL));
     }
 
 
@@ -60,22 +55,7 @@ namespace model {
 
     void AnimatWorld::reconstructAnimat(int const index, int const segments)
     {
-        /*
-        if(m_animatUpdatedObserver) {
-            m_animatUpdatedObserver(index);
-        }*/
-        //std::lock_guard<std::mutex> lg(*g_fuckers[0]);
-        auto newAnimat = std::make_shared<Animat>(index, AnimatProperties{segments, 2.0, 4.0});
-        m_animats[index] = newAnimat;
-        if(m_animatUpdatedObserver) {
-            m_animatUpdatedObserver(index, m_animats[index]);
-        }
-    }
-
-    void AnimatWorld::setAnimatUpdatedObserver
-    (std::function<void(int const, std::shared_ptr<Animat>)> func)
-    {
-        m_animatUpdatedObserver = std::move(func);
+        m_animats[index]->resize(segments);
     }
 
     bool AnimatWorld::nearAnotherAnimat(int const index)
@@ -144,25 +124,18 @@ namespace model {
     void AnimatWorld::doSetHeading(int const index,
                                    double const angle)
     {
-        // Derive heading matrix given angle
-        physics::Matrix xAxis, yAxis, zAxis;
-        xAxis.toIdentity();
-        yAxis.toIdentity();
-        zAxis.toIdentity();
-        xAxis[1][1]=cos(0);
-        xAxis[1][2]=-sin(0);
-        xAxis[2][1]=sin(0);
-        xAxis[2][2]=cos(0);
-        yAxis[0][0]=cos(0);
-        yAxis[0][2]=sin(0);
-        yAxis[2][0]=-sin(0);
-        yAxis[2][2]=cos(0);
-        zAxis[0][0]=cos(angle);
-        zAxis[0][1]=-sin(angle);
-        zAxis[1][0]=sin(angle);
-        zAxis[1][1]=cos(angle);
-        auto zy = zAxis * yAxis;
-        auto headingMatrix = zy * xAxis;
+        // Heading is a rotation about z only. Applied directly (as the
+        // row vector product v * R that physics::Matrix performs) since
+        // building Matrix objects allocates, and this runs every time an
+        // agent is re-placed.
+        auto const cosAngle = cos(angle);
+        auto const sinAngle = sin(angle);
+        auto rotate = [cosAngle, sinAngle](physics::Vector3 & v) {
+            auto const x = v.m_vec[0];
+            auto const y = v.m_vec[1];
+            v.m_vec[0] = x * cosAngle + y * sinAngle;
+            v.m_vec[1] = y * cosAngle - x * sinAngle;
+        };
 
         // Rotate around zero so need to offset
         auto & animat = m_animats[index];
@@ -182,8 +155,8 @@ namespace model {
             auto const indexRight = layer.getIndexRight();
             auto & leftPos = physicsEngine.getPointMassPositionRef(indexLeft);
             auto & rightPos = physicsEngine.getPointMassPositionRef(indexRight);
-            leftPos *= headingMatrix;
-            rightPos *= headingMatrix;
+            rotate(leftPos);
+            rotate(rightPos);
         }
 
         // ...and translate back again
@@ -250,4 +223,68 @@ namespace model {
             doTranslateAnimatPosition(index, transX, transY);
         }
     }
-}
\ No newline at end of file
+
+    void AnimatWorld::setOptimizationCount(long const optimizations)
+    {
+        m_optimizations = optimizations;
+    }
+
+    void AnimatWorld::save(serial::BinaryWriter & writer) const
+    {
+        writer.write(static_cast<std::int64_t>(m_optimizations));
+        writer.write(static_cast<std::int32_t>(m_animats.size()));
+        for (auto const & animat : m_animats) {
+            writer.write(static_cast<std::int32_t>(animat->getBlockCount()));
+            animat->save(writer);
+        }
+    }
+
+    void AnimatWorld::load(serial::BinaryReader & reader)
+    {
+        m_optimizations = reader.read<std::int64_t>();
+        auto const popSize = reader.read<std::int32_t>();
+        if (popSize != m_animats.size()) {
+            throw std::runtime_error("AnimatWorld::load: population size mismatch");
+        }
+        for (int i = 0; i < popSize; ++i) {
+            auto const blocks = reader.read<std::int32_t>();
+            if (blocks < 2 || blocks > 64) {
+                throw std::runtime_error("AnimatWorld::load: bad block count");
+            }
+            if (blocks != m_animats[i]->getBlockCount()) {
+                reconstructAnimat(i, blocks);
+            }
+            m_animats[i]->load(reader);
+        }
+    }
+
+    void AnimatWorld::fillSnapshot(WorldSnapshot & snapshot, long const tick)
+    {
+        snapshot.clear();
+        snapshot.tick = tick;
+        for (auto & animat : m_animats) {
+            animat->appendToSnapshot(snapshot);
+        }
+    }
+
+    void AnimatWorld::publishSnapshot(long const tick)
+    {
+        fillSnapshot(m_snapshots.back(), tick);
+        m_snapshots.publish();
+    }
+
+    TripleBuffer<WorldSnapshot> & AnimatWorld::snapshots()
+    {
+        return m_snapshots;
+    }
+
+    void AnimatWorld::attachRenderer()
+    {
+        m_rendererAttached = true;
+    }
+
+    bool AnimatWorld::rendererAttached() const
+    {
+        return m_rendererAttached;
+    }
+}
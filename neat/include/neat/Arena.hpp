@@ -0,0 +1,106 @@
+// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace neat {
+
+    // A bump allocator owned by a single genome. Everything a genome
+    // builds (connection lists, its innovation map) is carved out of
+    // the arena, individual frees are ignored, and when the genome is
+    // replaced wholesale (e.g. by inheriting another) the arena is
+    // rewound in one go. Once an arena has grown to fit a genome,
+    // rebuilding it makes no calls to the heap at all.
+    class Arena
+    {
+      public:
+        explicit Arena(std::size_t const firstBlockBytes = 1024);
+        ~Arena();
+
+        Arena(Arena const &) = delete;
+        Arena & operator=(Arena const &) = delete;
+
+        void * allocate(std::size_t const bytes, std::size_t const alignment);
+
+        // Makes the whole arena available again. Anything allocated
+        // from it must already have been destroyed. If the last round
+        // spilled over into more than one block, they are merged into
+        // one big enough for all of it.
+        void reset();
+
+        // Total bytes held, used or not
+        std::size_t capacity() const;
+
+      private:
+        struct Block
+        {
+            char * data;
+            std::size_t size;
+        };
+        std::vector<Block> m_blocks;
+
+        // The block being allocated from, and how far into it
+        std::size_t m_current;
+        std::size_t m_offset;
+
+        std::size_t m_firstBlockBytes;
+
+        void addBlock(std::size_t const minimumBytes);
+    };
+
+    // Standard allocator interface onto an Arena, for containers.
+    // Containers keep the arena they were built with when assigned
+    // to, so a genome's containers always draw from its own arena.
+    template <typename T>
+    class ArenaAllocator
+    {
+      public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        explicit ArenaAllocator(Arena & arena) noexcept
+          : m_arena(&arena)
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator(ArenaAllocator<U> const & other) noexcept
+          : m_arena(other.arena())
+        {
+        }
+
+        T * allocate(std::size_t const n)
+        {
+            return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) noexcept
+        {
+        }
+
+        Arena * arena() const noexcept
+        {
+            return m_arena;
+        }
+
+      private:
+        Arena * m_arena;
+    };
+
+    template <typename T, typename U>
+    bool operator==(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) noexcept
+    {
+        return a.arena() == b.arena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(ArenaAllocator<T> const & a, ArenaAllocator<U> const & b) noexcept
+    {
+        return !(a == b);
+    }
+}
@@ -22,9 +22,9 @@ namespace neat {
                    int const innovationNumber,
                    double const weight);
 
-        // Since we have references as member vars,
-        // we need explicit copy and assignment operators.
-        // Applying rule of 4, also have the move equivalents.
+        // The end-points are held by pointer so that assignment
+        // (e.g. when erasing from a node's connection list) rebinds
+        // them rather than copying one node over another.
         Connection(Connection const & other);
         Connection(Connection && other);
         Connection & operator=(Connection const & other);
@@ -37,13 +37,16 @@ namespace neat {
         Node & getNodeRefB();
 
         double weight() const;
+        void setWeight(double const weight);
 
         int getInnovationNumber() const;
 
+        double getMutationProbability() const;
+
       private:
         /// The connection end-points
-        Node & m_nodeA;
-        Node & m_nodeB;
+        Node * m_nodeA;
+        Node * m_nodeB;
 
         /// Probability of weight changing when updated
         double m_mutationProbability;
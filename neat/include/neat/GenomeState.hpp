@@ -0,0 +1,53 @@
+// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Flat, pointer-free description of a neat::Network. Nodes are stored
+ * in network order, each followed (in a separate array) by its
+ * incoming connections, which refer to other nodes by position.
+ */
+
+#include "neat/MutationParameters.hpp"
+#include "neat/NodeFunction.hpp"
+#include "neat/NodeType.hpp"
+#include <cstdint>
+
+namespace neat {
+
+    // Room for the output node ids of a NetworkState
+    int const MAX_STATE_OUTPUTS = 8;
+
+    struct NetworkState
+    {
+        std::int32_t inputCount;
+        std::int32_t outputCount;
+
+        // Positions of the output nodes, the first outputCount used
+        std::int32_t outputIDs[MAX_STATE_OUTPUTS];
+        std::int32_t maxSize;
+        std::int32_t nodeCount;
+        std::int32_t connectionCount;
+        std::int32_t innovationCount;
+        MutationParameters muts;
+        double weightInitBound;
+    };
+
+    struct NodeState
+    {
+        std::int32_t index;
+        NodeType nodeType;
+        NodeFunction nodeFunction;
+        std::int32_t connectionCount;
+        double mutationProbability;
+        double externalInput;
+    };
+
+    struct ConnectionState
+    {
+        std::int32_t pre;
+        std::int32_t innovationNumber;
+        double weight;
+        double mutationProbability;
+    };
+}
@@ -2,12 +2,19 @@
 
 #pragma once
 
+#include "neat/Arena.hpp"
 #include "neat/Connection.hpp"
+#include "neat/GenomeState.hpp"
 #include "neat/MutationParameters.hpp"
 #include "neat/Node.hpp"
 #include <vector>
 #include <map>
 
+namespace serial {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace neat {
 
     struct InnovationInfo {
@@ -35,6 +42,11 @@ namespace neat {
         void setInput(int const i, double const value);
         double getOutput(int const i) const;
 
+        /// Output i for the given inputs, one per input node, rather
+        /// than those set with setInput, which are left untouched
+        double getOutput(int const i, double const * inputs) const;
+        int getOutputCount() const;
+
         /// Mutates the network -- modifies weights, adds connections
         /// add nodes in place of connections, modifies the node type etc.
         bool mutate();
@@ -45,8 +57,50 @@ namespace neat {
         /// calling the given function.
         Network crossWith(Network const & other) const;
 
+        /// Cross-over in place, for when this network is already a
+        /// copy of the fitter parent: each gene this network shares
+        /// with other takes other's weight with probability one half
+        void crossWeightsFrom(Network const & other);
+
         double measureDifference(Network const & other) const;
 
+        /// Checkpointing of this genome
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Checkpointing of the population-wide innovation
+        /// tracking (GLOBAL_INNOVATION_NUMBER and GLOBAL_INNOVATION_MAP)
+        static void saveGlobalInnovations(serial::BinaryWriter & writer);
+        static void loadGlobalInnovations(serial::BinaryReader & reader);
+
+        /// Flat export of this genome. The counts in the returned state
+        /// size the arrays that exportState writes to.
+        NetworkState getState() const;
+        void exportState(NodeState * nodes,
+                         ConnectionState * connections,
+                         InnovationInfo * innovations) const;
+
+        /// Rebuilds this genome from flat arrays, e.g. ones
+        /// living in a memory-mapped checkpoint
+        void importState(NetworkState const & state,
+                         NodeState const * nodes,
+                         ConnectionState const * connections,
+                         InnovationInfo const * innovations);
+
+        /// Renumbers this genome's innovations against the innovation
+        /// tracking of this process, for genomes that were evolved
+        /// elsewhere (e.g. migrating between island populations).
+        /// Innovations are matched by the nodes they join; ones not
+        /// seen here before are registered as new.
+        void adoptInnovations();
+
+        /// Flat access to the population-wide innovation tracking
+        static int getGlobalInnovationNumber();
+        static InnovationMap const & getGlobalInnovationMap();
+        static void setGlobalInnovations(int const innovationNumber,
+                                         InnovationInfo const * innovations,
+                                         int const count);
+
       private:
         int m_inputCount;
         int m_outputCount;
@@ -55,11 +109,19 @@ namespace neat {
         // Controls the rate at which the network changes
         MutationParameters m_muts;
         double m_weightInitBound;
+
+        /// Backs the node connection lists and the innovation
+        /// map. Declared ahead of both so that it outlives them,
+        /// and rewound whenever the genome is rebuilt wholesale.
+        Arena m_arena;
+
         std::vector<Node> m_nodes;
         std::vector<int> m_outputIDs;
 
         /// Tracks innovatations for this specific individual
-        InnovationMap m_innovationMap;
+        using ArenaInnovationMap = std::map<int, InnovationInfo, std::less<int>,
+                                            ArenaAllocator<InnovationMap::value_type>>;
+        ArenaInnovationMap m_innovationMap;
 
         /// Keeps track of new structural innovations accross
         /// the whole population.
@@ -81,8 +143,8 @@ namespace neat {
         /// connectivity from input to output nodes
         void assembleInitialInputToOutputConnectivity();
 
-        /// During cross-over, the new network is to be
-        /// constructed from a pre-computed innovation map
+        /// When the network is to be constructed from a
+        /// pre-computed innovation map
         void assembleFromInnovationMap();
 
         /// Loops over all connections going into output and
@@ -2,10 +2,17 @@
 
 #pragma once
 
+#include "Arena.hpp"
+#include "GenomeState.hpp"
 #include "NodeType.hpp"
 #include "NodeFunction.hpp"
 #include <vector>
 
+namespace serial {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace neat {
 
     class Connection;
@@ -13,14 +20,24 @@ namespace neat {
     class Node
     {
       public:
+        /// Incoming connections are allocated from arena,
+        /// which is owned by the network holding this node
         Node(int const index, 
              NodeType const & nodeType,
-             double const mutationProbability);
+             double const mutationProbability,
+             Arena & arena);
         Node() = delete;
 
+        /// Restores node properties from flat state without
+        /// touching rand(). Connections are added by importState.
+        Node(NodeState const & state, Arena & arena);
+
         /// Need to ensure that when nodes are copied,
         /// the vector of incoming connections which has
         /// references to other nodes gets omitted
+        Node(Node const & other, Arena & arena);
+
+        /// As above but allocating from the same arena as other
         Node(Node const & other);
         Node & operator=(Node const & other);
 
@@ -56,6 +73,11 @@ namespace neat {
         /// final output current should be
         double getOutput() const;
 
+        /// As above but with inputs[i] standing in for the external
+        /// input of input node i, leaving the set external inputs as
+        /// they are
+        double getOutput(double const * inputs) const;
+
         /// Retrieves the classic i,j type index of this node
         int getIndex() const;
 
@@ -73,6 +95,28 @@ namespace neat {
         /// Retrieve a reference to an incoming connection
         Connection & getConnectionFrom(int const i);
 
+        int getIncomingConnectionCount() const;
+
+        /// Checkpointing. Incoming connections are written as
+        /// positions in the owning network's node array and
+        /// wired back up against nodes on load.
+        void save(serial::BinaryWriter & writer,
+                  std::vector<Node> const & nodes) const;
+        void load(serial::BinaryReader & reader,
+                  std::vector<Node> & nodes,
+                  double const weightBound);
+
+        /// Flat export. Incoming connections are written to
+        /// connections, which must have room for all of them.
+        NodeState exportState(std::vector<Node> const & nodes,
+                              ConnectionState * connections) const;
+
+        /// Flat import, wiring connections against nodes
+        void importState(NodeState const & state,
+                         ConnectionState const * connections,
+                         std::vector<Node> & nodes,
+                         double const weightBound);
+
       private:
 
         /// Indexes node in typical matrix i,j fashion
@@ -88,7 +132,7 @@ namespace neat {
         NodeFunction m_nodeFunction;
 
         /// Describes all nodes connected to this node
-        mutable std::vector<Connection> m_incomingConnections;
+        mutable std::vector<Connection, ArenaAllocator<Connection>> m_incomingConnections;
 
         /// Input going into the node not coming
         /// from another node.
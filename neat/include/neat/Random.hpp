@@ -0,0 +1,33 @@
+// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <random>
+
+namespace neat {
+
+    // Where mutation and crossover get their random numbers. By default
+    // that is rand(), as it always was. While a RandomScope is alive on
+    // a thread, that thread draws from the scope's engine instead, so
+    // that several genomes can be bred concurrently, each from an
+    // engine seeded for it, and come out the same whichever thread
+    // breeds them.
+    class RandomScope
+    {
+      public:
+        explicit RandomScope(std::mt19937 & engine);
+        ~RandomScope();
+
+        RandomScope(RandomScope const &) = delete;
+        RandomScope & operator=(RandomScope const &) = delete;
+
+        // The engine of the innermost scope on this thread, or null
+        static std::mt19937 * current();
+
+      private:
+        std::mt19937 * m_previous;
+    };
+
+    // As rand(): uniform in [0, RAND_MAX]
+    int random();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2017-present Ben Jones
+
+#include "neat/Arena.hpp"
+#include <algorithm>
+#include <new>
+
+namespace neat {
+
+    Arena::Arena(std::size_t const firstBlockBytes)
+      : m_blocks()
+      , m_current(0)
+      , m_offset(0)
+      , m_firstBlockBytes(firstBlockBytes)
+    {
+    }
+
+    Arena::~Arena()
+    {
+        for (auto const & block : m_blocks) {
+            ::operator delete(block.data);
+        }
+    }
+
+    void * Arena::allocate(std::size_t const bytes, std::size_t const alignment)
+    {
+        while (m_current < m_blocks.size()) {
+            auto const & block = m_blocks[m_current];
+            auto const start = (m_offset + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= block.size) {
+                m_offset = start + bytes;
+                return block.data + start;
+            }
+            ++m_current;
+            m_offset = 0;
+        }
+        addBlock(bytes + alignment);
+        return allocate(bytes, alignment);
+    }
+
+    void Arena::reset()
+    {
+        if (m_blocks.size() > 1) {
+            auto const total = capacity();
+            for (auto const & block : m_blocks) {
+                ::operator delete(block.data);
+            }
+            m_blocks.clear();
+            addBlock(total);
+        }
+        m_current = 0;
+        m_offset = 0;
+    }
+
+    std::size_t Arena::capacity() const
+    {
+        std::size_t total = 0;
+        for (auto const & block : m_blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+
+    void Arena::addBlock(std::size_t const minimumBytes)
+    {
+        // Each new block at least doubles what's held, so a genome
+        // that keeps growing costs a logarithmic number of blocks
+        auto const size = std::max({minimumBytes, m_firstBlockBytes, capacity()});
+        m_blocks.push_back({static_cast<char *>(::operator new(size)), size});
+        m_current = m_blocks.size() - 1;
+        m_offset = 0;
+    }
+}
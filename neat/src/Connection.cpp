@@ -2,13 +2,14 @@
 
 #include "neat/Connection.hpp"
 #include "neat/Node.hpp"
+#include "neat/Random.hpp"
 #include <cstdlib>
 
 namespace {
     double initWeight(double const weightBound)
     {
-        auto weight = ((double) rand() / (RAND_MAX)) * weightBound;
-        if ((rand() / RAND_MAX) < 0.5) {
+        auto weight = ((double) neat::random() / (RAND_MAX)) * weightBound;
+        if ((neat::random() / RAND_MAX) < 0.5) {
             weight = -weight;
         }
         return weight;
@@ -22,8 +23,8 @@ namespace neat {
                            double const weightBound, 
                            double const mutationProbability,
                            int const innovationNumber)
-      : m_nodeA(nodeA)
-      , m_nodeB(nodeB)
+      : m_nodeA(&nodeA)
+      , m_nodeB(&nodeB)
       , m_mutationProbability(mutationProbability)
       , m_innovationNumber(innovationNumber)
       , m_weight(initWeight(weightBound))
@@ -36,8 +37,8 @@ namespace neat {
                            double const mutationProbability,
                            int const innovationNumber,
                            double const weight)
-      : m_nodeA(nodeA)
-      , m_nodeB(nodeB)
+      : m_nodeA(&nodeA)
+      , m_nodeB(&nodeB)
       , m_mutationProbability(mutationProbability)
       , m_innovationNumber(innovationNumber)
       , m_weight(weight)
@@ -93,19 +94,29 @@ namespace neat {
         return m_weight;
     }
 
+    void Connection::setWeight(double const weight)
+    {
+        m_weight = weight;
+    }
+
     int Connection::getInnovationNumber() const
     {
         return m_innovationNumber;
     }
 
+    double Connection::getMutationProbability() const
+    {
+        return m_mutationProbability;
+    }
+
     /// Mutates the weight value
     void Connection::perturbWeight(double const weightStep)
     {
-        if (((double) rand() / (RAND_MAX)) < m_mutationProbability) {
+        if (((double) neat::random() / (RAND_MAX)) < m_mutationProbability) {
             m_weight += initWeight(weightStep);
         }
     }
 
-    Node & Connection::getNodeRefA() { return m_nodeA; }
-    Node & Connection::getNodeRefB() { return m_nodeB; }
+    Node & Connection::getNodeRefA() { return *m_nodeA; }
+    Node & Connection::getNodeRefB() { return *m_nodeB; }
 }
\ No newline at end of file
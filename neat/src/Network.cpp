@@ -2,9 +2,14 @@
 
 #include "neat/Network.hpp"
 #include "neat/NodeType.hpp"
+#include "neat/Random.hpp"
+#include "instrument/Instrument.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
 #include <cstdlib>
 #include <utility>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <random>
 
@@ -12,7 +17,10 @@ namespace {
 
     std::random_device rd;
     std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> uni(0,2); // guaranteed unbiased
+
+    // Guards the global innovation tracking, which genomes mutated
+    // concurrently all add to
+    std::mutex globalInnovationMutex;
 
     void restoreConnectivity(std::vector<neat::Node> const & oldNodes,
                              std::vector<neat::Node> & newNodes,
@@ -34,7 +42,31 @@ namespace {
         }
     }
 
-    std::optional<int> containsInnovation(neat::Network::InnovationMap const & map,
+    template <typename Map>
+    void saveInnovationMap(Map const & map,
+                           serial::BinaryWriter & writer)
+    {
+        writer.write(static_cast<std::int32_t>(map.size()));
+        for (auto const & it : map) {
+            writer.write(static_cast<std::int32_t>(it.first));
+            writer.write(it.second);
+        }
+    }
+
+    template <typename Map>
+    void loadInnovationMap(Map & map,
+                           serial::BinaryReader & reader)
+    {
+        map.clear();
+        auto const count = reader.readCount(1 << 24);
+        for (int i = 0; i < count; ++i) {
+            auto const key = reader.read<std::int32_t>();
+            map.emplace(key, reader.read<neat::InnovationInfo>());
+        }
+    }
+
+    template <typename Map>
+    std::optional<int> containsInnovation(Map const & map,
                                           int const pre, int const post) {
         auto found = std::find_if(std::begin(map), std::end(map),
                                   [pre, post, &map](std::pair<int, neat::InnovationInfo> const & p) {
@@ -50,7 +82,9 @@ namespace {
 
 namespace neat {
 
-    int Network::GLOBAL_INNOVATION_NUMBER = 14;
+    // Innovations below this are the initial input to output
+    // connections of the 7 input, 3 output genomes agents use
+    int Network::GLOBAL_INNOVATION_NUMBER = 21;
     Network::InnovationMap Network::GLOBAL_INNOVATION_MAP;
 
     Network::Network(int const inputCount, 
@@ -64,7 +98,10 @@ namespace neat {
       , m_maxSize(maxSize)
       , m_muts(muts)
       , m_weightInitBound(weightInitBound)
-      , m_innovationMap(innovMap)
+      , m_arena(2048)
+      , m_innovationMap(std::begin(innovMap), std::end(innovMap),
+                        std::less<int>(),
+                        ArenaAllocator<InnovationMap::value_type>(m_arena))
     {
         m_nodes.reserve(maxSize);
         m_outputIDs.reserve(outputCount);
@@ -77,10 +114,20 @@ namespace neat {
       , m_maxSize(other.m_maxSize)
       , m_muts(other.m_muts)
       , m_weightInitBound(other.m_weightInitBound)
-      , m_nodes(other.m_nodes)
+      , m_arena(std::max(other.m_arena.capacity(), std::size_t(2048)))
+      , m_nodes()
       , m_outputIDs(other.m_outputIDs)
-      , m_innovationMap(other.m_innovationMap)
+      , m_innovationMap(std::begin(other.m_innovationMap), std::end(other.m_innovationMap),
+                        std::less<int>(),
+                        ArenaAllocator<InnovationMap::value_type>(m_arena))
     {
+        // Connections refer to nodes by reference so the node array
+        // must never reallocate once built; keep the full capacity
+        m_nodes.reserve(std::max(other.m_nodes.size(), std::size_t(m_maxSize)));
+        for (auto const & node : other.m_nodes) {
+            m_nodes.emplace_back(node, m_arena);
+        }
+
         // now restore connectivity
         restoreConnectivity(other.m_nodes, 
                             m_nodes, 
@@ -99,8 +146,20 @@ namespace neat {
         m_maxSize = other.m_maxSize;
         m_muts = other.m_muts;
         m_weightInitBound = other.m_weightInitBound;
-        m_nodes = other.m_nodes;
-        m_innovationMap = other.m_innovationMap;
+
+        // Everything allocated from the arena goes before it is
+        // rewound; the rebuild below then reuses that memory
+        m_nodes.clear();
+        m_innovationMap.clear();
+        m_arena.reset();
+
+        m_nodes.reserve(std::max(other.m_nodes.size(), std::size_t(m_maxSize)));
+        for (auto const & node : other.m_nodes) {
+            m_nodes.emplace_back(node, m_arena);
+        }
+        m_outputIDs = other.m_outputIDs;
+        m_innovationMap.insert(std::begin(other.m_innovationMap),
+                               std::end(other.m_innovationMap));
         // now restore connectivity
         restoreConnectivity(other.m_nodes, 
                             m_nodes, 
@@ -114,11 +173,11 @@ namespace neat {
         // Input and output node creation. 
         for (auto i = 0; i < m_inputCount; ++i) {
             m_nodes.emplace_back(i, NodeType::Input, 
-                                 m_muts.nodeFunctionChangeProb);
+                                 m_muts.nodeFunctionChangeProb, m_arena);
         }
         for (auto i = m_inputCount; i < m_inputCount + m_outputCount; ++i) {
             m_nodes.emplace_back(i, NodeType::Output, 
-                                 m_muts.nodeFunctionChangeProb);
+                                 m_muts.nodeFunctionChangeProb, m_arena);
             m_outputIDs.push_back(i);
         }
     }
@@ -163,13 +222,13 @@ namespace neat {
                 if(preNode >= m_nodes.size()) {
                     for (auto i = m_nodes.size(); i <= preNode; ++i) {
                         m_nodes.emplace_back(i, NodeType::Hidden, 
-                        m_muts.nodeFunctionChangeProb);
+                        m_muts.nodeFunctionChangeProb, m_arena);
                     }
                 }
                 if(postNode >= m_nodes.size()) {
                     for (auto i = m_nodes.size(); i <= postNode; ++i) {
                         m_nodes.emplace_back(i, NodeType::Hidden, 
-                        m_muts.nodeFunctionChangeProb);
+                        m_muts.nodeFunctionChangeProb, m_arena);
                     }
                 }
 
@@ -191,7 +250,7 @@ namespace neat {
             // Full initial connectivity
             assembleInitialInputToOutputConnectivity();
         } else {
-            // Innovation map was constructed during cross over
+            // Innovation map was given pre-computed
             assembleFromInnovationMap();
         }
     }
@@ -201,12 +260,23 @@ namespace neat {
         m_nodes[i].setExternalInput(value);
     }
 
+    int Network::getOutputCount() const
+    {
+        return m_outputCount;
+    }
+
     double Network::getOutput(int const i) const
     {
         auto outputIndex = m_outputIDs[i];
         return m_nodes[outputIndex].getOutput();
     }
 
+    double Network::getOutput(int const i, double const * inputs) const
+    {
+        auto outputIndex = m_outputIDs[i];
+        return m_nodes[outputIndex].getOutput(inputs);
+    }
+
     bool Network::addNewNodes()
     {
         // Ouput ID (the node index within the array of nodes)
@@ -219,7 +289,7 @@ namespace neat {
                     continue;
                 }
                 if(node.hasConnectionFrom(i) && i != j) {
-                    if (((double) rand() / (RAND_MAX)) < m_muts.nodeAdditionProb) {
+                    if (((double) neat::random() / (RAND_MAX)) < m_muts.nodeAdditionProb) {
                         auto & connection = node.getConnectionFrom(i);
                         return addNodeInPlaceOf(connection);
                     }
@@ -237,9 +307,12 @@ namespace neat {
         // is less than max permitted size
         auto id = m_nodes.size();
         if (id < m_maxSize) {
-            // Find out original connectivity
+            // Find out original connectivity. con lives in nodePost's
+            // connection list, which the removal below shifts, so take
+            // everything needed from it up front.
             auto & nodePre = con.getNodeRefA();
             auto & nodePost = con.getNodeRefB();
+            auto const weight = con.weight();
 
             // To prevent loops in the network, prevent any connections
             // between hidden nodes
@@ -249,7 +322,7 @@ namespace neat {
             }
 
             m_nodes.emplace_back(id, NodeType::Hidden, 
-                     m_muts.nodeFunctionChangeProb);
+                     m_muts.nodeFunctionChangeProb, m_arena);
 
             // Remove old connection from nodePre to nodePost
             auto nodePreIndex = nodePre.getIndex();
@@ -267,6 +340,7 @@ namespace neat {
 
             // Do we already have an innovation from nodePre to id?
             {
+                std::lock_guard<std::mutex> lock(globalInnovationMutex);
                 auto existsAlready = containsInnovation(GLOBAL_INNOVATION_MAP, nodePreIndex, id);
                 int innovationNum = GLOBAL_INNOVATION_NUMBER;
                 if(existsAlready) {
@@ -300,6 +374,7 @@ namespace neat {
             
             // Do we already have an innovation from id to nodePost?
             {
+                std::lock_guard<std::mutex> lock(globalInnovationMutex);
                 auto existsAlready = containsInnovation(GLOBAL_INNOVATION_MAP, id, nodePostIndex);
                 int innovationNum = GLOBAL_INNOVATION_NUMBER;
                 if(existsAlready) {
@@ -310,11 +385,11 @@ namespace neat {
                                                    m_weightInitBound, 
                                                    m_muts.weightChangeProb,
                                                    innovationNum,
-                                                   con.weight());
+                                                   weight);
                 auto innovation = InnovationInfo{innovationNum, 
                                                  static_cast<int>(id),
                                                  nodePost.getIndex(),
-                                                 con.weight(), 
+                                                 weight, 
                                                  true};
                 if(!existsAlready) {      
                     GLOBAL_INNOVATION_MAP.emplace(GLOBAL_INNOVATION_NUMBER, innovation);
@@ -342,9 +417,10 @@ namespace neat {
             for(; it != std::end(m_nodes); ++it) {
                 for (int i = 0; i < m_inputCount; ++i) {
                     if(!it->hasConnectionFrom(i)) {
-                        if (((double) rand() / (RAND_MAX)) < m_muts.connectionAdditionProb) {
+                        if (((double) neat::random() / (RAND_MAX)) < m_muts.connectionAdditionProb) {
                             // Do we already have an innovation from id to nodePost?
                             {
+                                std::lock_guard<std::mutex> lock(globalInnovationMutex);
                                 auto existsAlready = containsInnovation(GLOBAL_INNOVATION_MAP, i, it->getIndex());
                                 int innovationNum = GLOBAL_INNOVATION_NUMBER;
                                 if(existsAlready) {
@@ -387,12 +463,15 @@ namespace neat {
 
     bool Network::mutate()
     {
+        INSTRUMENT_SCOPE("neat.mutate");
 
         // Return true if a mutation led to a new species
         auto newCon = false;
         auto newNode = false;
         perturbWeights(m_weightInitBound / 4.0);
-        auto random_integer = uni(rng);
+        // Drawn from this thread's RandomScope if it has one
+        auto * const engine = RandomScope::current();
+        auto random_integer = std::uniform_int_distribution<int>(0, 2)(engine ? *engine : rng);
         
         if(random_integer == 0) {
             newCon = addConnectionToHiddenOrOutputNode();
@@ -406,38 +485,38 @@ namespace neat {
 
     Network Network::crossWith(Network const & other) const
     {
-        InnovationMap crossedMap;
+        // The child starts as a copy of the fittest, which is always
+        // the other network (this should have been taken into account
+        // when calling the crossWith function), so it has its nodes,
+        // node functions and excess and disjoint genes along with the
+        // weights they evolved
+        Network child(other);
+        child.crossWeightsFrom(*this);
+        return child;
+    }
 
-        // Iterate through map and find matching genes. A matching gene
-        // is chosen at random from either parent
-        for (auto const & innovation : m_innovationMap) {
-            // See if this innovation exists in the other map
-            auto found = other.m_innovationMap.find(innovation.second.innovationNumber);
-            if (found != std::end(other.m_innovationMap)) {
-                if (((double) rand() / (RAND_MAX)) < 0.5) {
-                    crossedMap.emplace(innovation.second.innovationNumber, innovation.second);
-                } else {
-                    crossedMap.emplace(innovation.second.innovationNumber, found->second);
+    void Network::crossWeightsFrom(Network const & other)
+    {
+        // A matching gene is a connection both networks have between
+        // the same nodes under the same innovation number. Its weight
+        // is chosen at random from either parent.
+        auto const nodeCount = static_cast<int>(std::min(m_nodes.size(), other.m_nodes.size()));
+        for (auto j = m_inputCount; j < nodeCount; ++j) {
+            auto & node = m_nodes[j];
+            auto const & otherNode = other.m_nodes[j];
+            for (auto i = 0; i < nodeCount; ++i) {
+                if (i == j || !node.hasConnectionFrom(i) || !otherNode.hasConnectionFrom(i)) {
+                    continue;
+                }
+                if (node.getInnovNumberForConnectionFrom(i) !=
+                    otherNode.getInnovNumberForConnectionFrom(i)) {
+                    continue;
+                }
+                if (((double) neat::random() / (RAND_MAX)) < 0.5) {
+                    node.getConnectionFrom(i).setWeight(otherNode.getConnectionWeightFrom(i));
                 }
             }
         }
-
-        // Genes that are excess or disjoint come from the fittest. The
-        // fittest is always the other network. This should have been
-        // taken into account when calling the crossWith function.
-        for (auto const & innovation : other.m_innovationMap) {
-            auto found = m_innovationMap.find(innovation.second.innovationNumber);
-            // If not found, means it is disjoint and should be added to crossed map
-            if(found == std::end(m_innovationMap)) {
-                crossedMap.emplace(innovation.second.innovationNumber, innovation.second);
-            }
-        }
-        return Network(m_inputCount,
-                       m_outputCount,
-                       m_maxSize,
-                       m_muts,
-                       m_weightInitBound,
-                       crossedMap);
     }
 
     double Network::measureDifference(Network const & other) const
@@ -458,20 +537,246 @@ namespace neat {
         //     }
         // }
 
-        for (auto const & innovation : other.m_innovationMap) {
-            auto found = m_innovationMap.find(innovation.second.innovationNumber);
-            // If not found, means it is disjoint and should be added to crossed map
-            if(found == std::end(m_innovationMap)) {
+        // Innovations that only one of the networks has. Both maps are
+        // ordered by innovation number so are walked together once.
+        auto a = std::begin(m_innovationMap);
+        auto b = std::begin(other.m_innovationMap);
+        auto const aEnd = std::end(m_innovationMap);
+        auto const bEnd = std::end(other.m_innovationMap);
+        while (a != aEnd && b != bEnd) {
+            if (a->first < b->first) {
                 difference += 1.0;
-            }
-        }
-        for (auto const & innovation : m_innovationMap) {
-            auto found = other.m_innovationMap.find(innovation.second.innovationNumber);
-            // If not found, means it is disjoint and should be added to crossed map
-            if(found == std::end(other.m_innovationMap)) {
+                ++a;
+            } else if (b->first < a->first) {
                 difference += 1.0;
+                ++b;
+            } else {
+                ++a;
+                ++b;
             }
         }
+        difference += std::distance(a, aEnd) + std::distance(b, bEnd);
         return difference;
     }
-}
\ No newline at end of file
+
+    void Network::save(serial::BinaryWriter & writer) const
+    {
+        writer.write(static_cast<std::int32_t>(m_inputCount));
+        writer.write(static_cast<std::int32_t>(m_outputCount));
+        writer.write(static_cast<std::int32_t>(m_maxSize));
+        writer.write(m_muts);
+        writer.write(m_weightInitBound);
+        writer.write(static_cast<std::int32_t>(m_nodes.size()));
+        for (auto const & node : m_nodes) {
+            node.save(writer, m_nodes);
+        }
+        writer.write(static_cast<std::int32_t>(m_outputIDs.size()));
+        for (auto const id : m_outputIDs) {
+            writer.write(static_cast<std::int32_t>(id));
+        }
+        saveInnovationMap(m_innovationMap, writer);
+    }
+
+    void Network::load(serial::BinaryReader & reader)
+    {
+        m_inputCount = reader.read<std::int32_t>();
+        m_outputCount = reader.read<std::int32_t>();
+        m_maxSize = reader.read<std::int32_t>();
+        reader.read(m_muts);
+        reader.read(m_weightInitBound);
+
+        // All nodes must exist before any are loaded since connections
+        // hold references to nodes anywhere in the array. Reserving
+        // up-front also guarantees that those references stay valid.
+        auto const nodeCount = reader.readCount(1 << 16);
+        m_nodes.clear();
+        m_innovationMap.clear();
+        m_arena.reset();
+        m_nodes.reserve(std::max(nodeCount, m_maxSize));
+        for (auto i = 0; i < nodeCount; ++i) {
+            m_nodes.emplace_back(i, NodeType::Hidden,
+                                 m_muts.nodeFunctionChangeProb, m_arena);
+        }
+        for (auto & node : m_nodes) {
+            node.load(reader, m_nodes, m_weightInitBound);
+        }
+
+        m_outputIDs.clear();
+        auto const outputCount = reader.readCount(nodeCount);
+        for (auto i = 0; i < outputCount; ++i) {
+            m_outputIDs.push_back(reader.read<std::int32_t>());
+        }
+        loadInnovationMap(m_innovationMap, reader);
+    }
+
+    void Network::saveGlobalInnovations(serial::BinaryWriter & writer)
+    {
+        std::lock_guard<std::mutex> lock(globalInnovationMutex);
+        writer.write(static_cast<std::int32_t>(GLOBAL_INNOVATION_NUMBER));
+        saveInnovationMap(GLOBAL_INNOVATION_MAP, writer);
+    }
+
+    void Network::loadGlobalInnovations(serial::BinaryReader & reader)
+    {
+        std::lock_guard<std::mutex> lock(globalInnovationMutex);
+        GLOBAL_INNOVATION_NUMBER = reader.read<std::int32_t>();
+        loadInnovationMap(GLOBAL_INNOVATION_MAP, reader);
+    }
+
+    NetworkState Network::getState() const
+    {
+        NetworkState state{};
+        state.inputCount = m_inputCount;
+        state.outputCount = m_outputCount;
+        if (m_outputIDs.size() > MAX_STATE_OUTPUTS) {
+            throw std::runtime_error("Network::getState: too many outputs");
+        }
+        for (auto i = 0; i < m_outputIDs.size(); ++i) {
+            state.outputIDs[i] = m_outputIDs[i];
+        }
+        state.maxSize = m_maxSize;
+        state.nodeCount = m_nodes.size();
+        state.connectionCount = 0;
+        for (auto const & node : m_nodes) {
+            state.connectionCount += node.getIncomingConnectionCount();
+        }
+        state.innovationCount = m_innovationMap.size();
+        state.muts = m_muts;
+        state.weightInitBound = m_weightInitBound;
+        return state;
+    }
+
+    void Network::exportState(NodeState * nodes,
+                              ConnectionState * connections,
+                              InnovationInfo * innovations) const
+    {
+        for (auto const & node : m_nodes) {
+            *nodes = node.exportState(m_nodes, connections);
+            connections += nodes->connectionCount;
+            ++nodes;
+        }
+        for (auto const & it : m_innovationMap) {
+            *innovations++ = it.second;
+        }
+    }
+
+    void Network::importState(NetworkState const & state,
+                              NodeState const * nodes,
+                              ConnectionState const * connections,
+                              InnovationInfo const * innovations)
+    {
+        m_inputCount = state.inputCount;
+        m_outputCount = state.outputCount;
+        m_maxSize = state.maxSize;
+        m_muts = state.muts;
+        m_weightInitBound = state.weightInitBound;
+
+        // As in load, every node must exist before connections are
+        // wired. Nothing here calls rand() so that several genomes
+        // can be imported concurrently.
+        m_nodes.clear();
+        m_innovationMap.clear();
+        m_arena.reset();
+        m_nodes.reserve(std::max(state.nodeCount, state.maxSize));
+        for (auto i = 0; i < state.nodeCount; ++i) {
+            m_nodes.emplace_back(nodes[i], m_arena);
+        }
+        auto remaining = state.connectionCount;
+        for (auto i = 0; i < state.nodeCount; ++i) {
+            if (nodes[i].connectionCount < 0 || nodes[i].connectionCount > remaining) {
+                throw std::runtime_error("Network::importState: bad connection count");
+            }
+            m_nodes[i].importState(nodes[i], connections, m_nodes, m_weightInitBound);
+            connections += nodes[i].connectionCount;
+            remaining -= nodes[i].connectionCount;
+        }
+
+        if (state.outputCount < 0 || state.outputCount > MAX_STATE_OUTPUTS) {
+            throw std::runtime_error("Network::importState: bad output count");
+        }
+        m_outputIDs.clear();
+        for (auto i = 0; i < state.outputCount; ++i) {
+            if (state.outputIDs[i] < 0 || state.outputIDs[i] >= state.nodeCount) {
+                throw std::runtime_error("Network::importState: bad output id");
+            }
+            m_outputIDs.push_back(state.outputIDs[i]);
+        }
+
+        for (auto i = 0; i < state.innovationCount; ++i) {
+            m_innovationMap.emplace_hint(std::end(m_innovationMap),
+                                         innovations[i].innovationNumber,
+                                         innovations[i]);
+        }
+    }
+
+    void Network::adoptInnovations()
+    {
+        auto const state = getState();
+        std::vector<NodeState> nodes(state.nodeCount);
+        std::vector<ConnectionState> connections(state.connectionCount);
+        std::vector<InnovationInfo> innovations(state.innovationCount);
+        exportState(nodes.data(), connections.data(), innovations.data());
+
+        // Initial input to output connections are numbered the same
+        // way by every genome so are left alone; anything else takes
+        // the local number for the same end-points
+        auto const localNumber = [&state](int const pre, int const post,
+                                          int const number, double const weight) {
+            auto const initial = pre * state.outputCount + (post - state.inputCount);
+            if (pre < state.inputCount &&
+                post >= state.inputCount && post < state.inputCount + state.outputCount &&
+                number == initial) {
+                return number;
+            }
+            if (auto const existing = containsInnovation(GLOBAL_INNOVATION_MAP, pre, post)) {
+                return *existing;
+            }
+            auto const fresh = GLOBAL_INNOVATION_NUMBER++;
+            GLOBAL_INNOVATION_MAP.emplace(fresh, InnovationInfo{fresh, pre, post, weight, true});
+            return fresh;
+        };
+
+        std::unique_lock<std::mutex> lock(globalInnovationMutex);
+        for (auto & innovation : innovations) {
+            innovation.innovationNumber = localNumber(innovation.preNode,
+                                                      innovation.postNode,
+                                                      innovation.innovationNumber,
+                                                      innovation.weight);
+        }
+        auto connection = std::begin(connections);
+        for (auto post = 0; post < state.nodeCount; ++post) {
+            for (auto c = 0; c < nodes[post].connectionCount; ++c, ++connection) {
+                connection->innovationNumber = localNumber(connection->pre, post,
+                                                           connection->innovationNumber,
+                                                           connection->weight);
+            }
+        }
+        lock.unlock();
+        importState(state, nodes.data(), connections.data(), innovations.data());
+    }
+
+    int Network::getGlobalInnovationNumber()
+    {
+        std::lock_guard<std::mutex> lock(globalInnovationMutex);
+        return GLOBAL_INNOVATION_NUMBER;
+    }
+
+    Network::InnovationMap const & Network::getGlobalInnovationMap()
+    {
+        return GLOBAL_INNOVATION_MAP;
+    }
+
+    void Network::setGlobalInnovations(int const innovationNumber,
+                                       InnovationInfo const * innovations,
+                                       int const count)
+    {
+        std::lock_guard<std::mutex> lock(globalInnovationMutex);
+        GLOBAL_INNOVATION_NUMBER = innovationNumber;
+        GLOBAL_INNOVATION_MAP.clear();
+        for (auto i = 0; i < count; ++i) {
+            GLOBAL_INNOVATION_MAP.emplace_hint(std::end(GLOBAL_INNOVATION_MAP),
+                                               innovations[i].innovationNumber,
+                                               innovations[i]);
+        }
+    }
+}
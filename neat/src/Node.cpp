@@ -2,7 +2,10 @@
 
 #include "neat/Node.hpp"
 #include "neat/Connection.hpp"
-#include <cstdlib> // rand()
+#include "neat/Random.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
+#include <cstdlib>
 #include <algorithm>
 #include <cmath>
 #include <cassert>
@@ -17,7 +20,7 @@ namespace {
         //if(nodeType == neat::NodeType::Output || nodeType == neat::NodeType::Input) {
             //return neat::NodeFunction::Transfer;
         //} else {
-            return static_cast<neat::NodeFunction>(rand() % 8);
+            return static_cast<neat::NodeFunction>(neat::random() % 8);
         //}
     }
 
@@ -46,25 +49,44 @@ namespace {
 namespace neat {
     Node::Node(int const index, 
                NodeType const & nodeType,
-               double const mutationProbability)
+               double const mutationProbability,
+               Arena & arena)
       : m_index(index)
       , m_nodeType(nodeType)
       , m_mutationProbability(mutationProbability)
       , m_nodeFunction(initNodeFunction(nodeType))
+      , m_incomingConnections(ArenaAllocator<Connection>(arena))
       , m_externalInput(0)
     {
-        m_incomingConnections.reserve(50);
     }
 
-    Node::Node(Node const & other)
+    Node::Node(NodeState const & state, Arena & arena)
+      : m_index(state.index)
+      , m_nodeType(state.nodeType)
+      , m_mutationProbability(state.mutationProbability)
+      , m_nodeFunction(state.nodeFunction)
+      , m_incomingConnections(ArenaAllocator<Connection>(arena))
+      , m_externalInput(state.externalInput)
+    {
+    }
+
+    Node::Node(Node const & other, Arena & arena)
       : m_index(other.m_index)
       , m_nodeType(other.m_nodeType)
       , m_mutationProbability(other.m_mutationProbability)
       , m_nodeFunction(other.m_nodeFunction)
+      , m_incomingConnections(ArenaAllocator<Connection>(arena))
       , m_externalInput(other.m_externalInput)
-      , m_incomingConnections()
     {
-        m_incomingConnections.reserve(50);
+        // Connections are restored by the owning network; reserve
+        // for exactly those since the arena never gets back what
+        // a growing vector leaves behind
+        m_incomingConnections.reserve(other.m_incomingConnections.size());
+    }
+
+    Node::Node(Node const & other)
+      : Node(other, *other.m_incomingConnections.get_allocator().arena())
+    {
     }
 
     Node & Node::operator=(Node const & other)
@@ -78,7 +100,7 @@ namespace neat {
         m_nodeFunction = other.m_nodeFunction;
         m_externalInput = other.m_externalInput;
         m_incomingConnections.clear();
-        m_incomingConnections.reserve(50);
+        m_incomingConnections.reserve(other.m_incomingConnections.size());
         return *this;
     }
 
@@ -196,9 +218,14 @@ namespace neat {
         return *theConnection;
     }
 
+    int Node::getIncomingConnectionCount() const
+    {
+        return m_incomingConnections.size();
+    }
+
     void Node::perturbNodeFunction()
     {
-        if (((double) rand() / (RAND_MAX)) < m_mutationProbability) {
+        if (((double) neat::random() / (RAND_MAX)) < m_mutationProbability) {
             m_nodeFunction = initNodeFunction(m_nodeType);
         }
     }
@@ -209,6 +236,11 @@ namespace neat {
     }
 
     double Node::getOutput() const
+    {
+        return getOutput(nullptr);
+    }
+
+    double Node::getOutput(double const * inputs) const
     {
         // back-tracks over all nodes to get final output
         double accumulator = 0;
@@ -218,9 +250,13 @@ namespace neat {
                 continue;
             }
             //std::cout<<con.getNodeRefA().getIndex()<<"\t"<<con.getNodeRefB().getIndex()<<std::endl;
-            accumulator += nodeRef.getOutput() * con.weight();
+            accumulator += nodeRef.getOutput(inputs) * con.weight();
+        }
+        if(inputs && m_nodeType == NodeType::Input) {
+            accumulator += inputs[m_index];
+        } else {
+            accumulator += m_externalInput;
         }
-        accumulator += m_externalInput;
         return applyNodeFunction(m_nodeFunction, accumulator);
     }
 
@@ -230,4 +266,100 @@ namespace neat {
             con.perturbWeight(byAmount);
         }
     }
-}
\ No newline at end of file
+
+    void Node::save(serial::BinaryWriter & writer,
+                    std::vector<Node> const & nodes) const
+    {
+        writer.write(static_cast<std::int32_t>(m_index));
+        writer.write(m_nodeType);
+        writer.write(m_mutationProbability);
+        writer.write(m_nodeFunction);
+        writer.write(m_externalInput);
+        writer.write(static_cast<std::int32_t>(m_incomingConnections.size()));
+        for (auto & con : m_incomingConnections) {
+            // Position rather than getIndex(), so that the exact
+            // node the connection refers to is restored
+            auto const pre = &con.getNodeRefA() - nodes.data();
+            writer.write(static_cast<std::int32_t>(pre));
+            writer.write(static_cast<std::int32_t>(con.getInnovationNumber()));
+            writer.write(con.weight());
+            writer.write(con.getMutationProbability());
+        }
+    }
+
+    void Node::load(serial::BinaryReader & reader,
+                    std::vector<Node> & nodes,
+                    double const weightBound)
+    {
+        m_index = reader.read<std::int32_t>();
+        reader.read(m_nodeType);
+        reader.read(m_mutationProbability);
+        reader.read(m_nodeFunction);
+        reader.read(m_externalInput);
+        m_incomingConnections.clear();
+        auto const connectionCount = reader.readCount(1 << 16);
+        m_incomingConnections.reserve(connectionCount);
+        for (int c = 0; c < connectionCount; ++c) {
+            auto const pre = reader.read<std::int32_t>();
+            auto const innovNumber = reader.read<std::int32_t>();
+            auto const weight = reader.read<double>();
+            auto const mutProb = reader.read<double>();
+            if (pre < 0 || pre >= nodes.size()) {
+                throw std::runtime_error("Node::load: connection out of bounds");
+            }
+            m_incomingConnections.emplace_back(nodes[pre],
+                                               *this,
+                                               weightBound,
+                                               mutProb,
+                                               innovNumber,
+                                               weight);
+        }
+    }
+
+    NodeState Node::exportState(std::vector<Node> const & nodes,
+                                ConnectionState * connections) const
+    {
+        NodeState state{};
+        state.index = m_index;
+        state.nodeType = m_nodeType;
+        state.nodeFunction = m_nodeFunction;
+        state.connectionCount = m_incomingConnections.size();
+        state.mutationProbability = m_mutationProbability;
+        state.externalInput = m_externalInput;
+        for (auto & con : m_incomingConnections) {
+            ConnectionState conState{};
+            conState.pre = &con.getNodeRefA() - nodes.data();
+            conState.innovationNumber = con.getInnovationNumber();
+            conState.weight = con.weight();
+            conState.mutationProbability = con.getMutationProbability();
+            *connections++ = conState;
+        }
+        return state;
+    }
+
+    void Node::importState(NodeState const & state,
+                           ConnectionState const * connections,
+                           std::vector<Node> & nodes,
+                           double const weightBound)
+    {
+        m_index = state.index;
+        m_nodeType = state.nodeType;
+        m_nodeFunction = state.nodeFunction;
+        m_mutationProbability = state.mutationProbability;
+        m_externalInput = state.externalInput;
+        m_incomingConnections.clear();
+        m_incomingConnections.reserve(state.connectionCount);
+        for (int c = 0; c < state.connectionCount; ++c) {
+            auto const & con = connections[c];
+            if (con.pre < 0 || con.pre >= nodes.size()) {
+                throw std::runtime_error("Node::importState: connection out of bounds");
+            }
+            m_incomingConnections.emplace_back(nodes[con.pre],
+                                               *this,
+                                               weightBound,
+                                               con.mutationProbability,
+                                               con.innovationNumber,
+                                               con.weight);
+        }
+    }
+}
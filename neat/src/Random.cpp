@@ -0,0 +1,35 @@
+// Copyright (c) 2017-present Ben Jones
+
+#include "neat/Random.hpp"
+#include <cstdlib>
+
+namespace {
+    thread_local std::mt19937 * scopedEngine = nullptr;
+}
+
+namespace neat {
+
+    RandomScope::RandomScope(std::mt19937 & engine)
+      : m_previous(scopedEngine)
+    {
+        scopedEngine = &engine;
+    }
+
+    RandomScope::~RandomScope()
+    {
+        scopedEngine = m_previous;
+    }
+
+    std::mt19937 * RandomScope::current()
+    {
+        return scopedEngine;
+    }
+
+    int random()
+    {
+        if (scopedEngine) {
+            return std::uniform_int_distribution<int>(0, RAND_MAX)(*scopedEngine);
+        }
+        return ::rand();
+    }
+}
@@ -1,7 +1,10 @@
 /// Copyright (c) 2017 Ben Jones
 #pragma once
 
+#include "PhysicsState.hpp"
 #include "Spring.hpp"
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace physics {
@@ -12,9 +15,22 @@ namespace physics {
     class PhysicsEngine
     {
       public:
+        /// Reserves room for pointCount point masses and the springs
+        /// of a body that size
         explicit PhysicsEngine(int const pointCount);
         PhysicsEngine() = delete;
 
+        /// Grows the reserved room to pointCount point masses, position
+        /// mutexes included. Springs refer to point masses by
+        /// reference, so only call this while the engine is empty.
+        void reserve(int const pointCount);
+
+        /// Drops every point mass from pointCount on and every spring
+        /// from springCount on, keeping the storage and position
+        /// mutexes for reuse. Springs
+        /// kept must not refer to any point mass dropped.
+        void truncate(int const pointCount, int const springCount);
+
         /// returns index of added mass point
         int addPointMass(Vector3 const & position, 
                          double const mass, 
@@ -53,12 +69,31 @@ namespace physics {
         /// Resets a point mass's position
         void pointMassToInitialPosition(int const i);
 
+        /// Checkpointing. The engine being loaded into must already
+        /// have the same topology (point mass and spring counts)
+        /// as the one that was saved.
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        int getPointMassCount() const;
+        int getSpringCount() const;
+
+        /// Flat export and import of the whole engine state. The
+        /// arrays hold getPointMassCount() and getSpringCount() entries.
+        void exportState(PointMassState * masses, SpringState * springs) const;
+        void importState(PointMassState const * masses, SpringState const * springs);
+
       private:
         /// Collection of point masses
         mutable std::vector<PointMass> m_masses;
 
         /// Collection of springs
         std::vector<Spring> m_springs;
+
+        /// Position mutexes, one per reserved point mass, handed to the
+        /// point mass built at the same index so that rebuilding a body
+        /// within its reserved size doesn't allocate
+        std::vector<std::shared_ptr<std::mutex>> m_positionMutexes;
     };
 
 }
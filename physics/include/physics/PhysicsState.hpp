@@ -0,0 +1,37 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Flat, pointer-free copies of point mass and spring state. These
+ * can be written to disk as-is and read back in place, e.g. straight
+ * out of a memory-mapped checkpoint.
+ */
+
+#include <cstdint>
+
+namespace physics {
+
+    struct PointMassState
+    {
+        double position[3];
+        double initialPosition[3];
+        double velocity[3];
+        double acceleration[3];
+        double forceAccum[3];
+        double mass;
+        std::int32_t frozen;
+        std::int32_t padding;
+    };
+
+    struct SpringState
+    {
+        double springConstant;
+        double dampener;
+        double restLength;
+        double compressForceP0[3];
+        double compressForceP1[3];
+        std::int32_t fixedP0;
+        std::int32_t fixedP1;
+    };
+}
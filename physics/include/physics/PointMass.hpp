@@ -5,12 +5,18 @@
  * Based on code found at http://resumbrae.com/ub/dms424_s03/
  */
 
+#include "PhysicsState.hpp"
 #include "Vector3.hpp"
 
 #include <vector>
 #include <mutex>
 #include <memory>
 
+namespace serial {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
 namespace physics {
 
     class PointMass
@@ -21,6 +27,13 @@ namespace physics {
                   double const mass = 1.0,
                   bool const frozen = false);
 
+        /// As above but sharing an already allocated position mutex,
+        /// so that building a point mass doesn't allocate
+        PointMass(Vector3 const & pos,
+                  double const mass,
+                  bool const frozen,
+                  std::shared_ptr<std::mutex> positionMutex);
+
         void accumulateForce(const Vector3 & force);
         void applyForce();
         void update(double const dt);
@@ -42,6 +55,14 @@ namespace physics {
 
         void toInitialPosition();
 
+        /// Checkpointing of the full integration state
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Flat copy of the integration state
+        PointMassState state() const;
+        void setState(PointMassState const & state);
+
       private:
 
         Vector3 m_position;
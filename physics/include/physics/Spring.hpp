@@ -31,6 +31,15 @@ namespace physics {
         void compress(double const forceMagnitude);
         void relax();
 
+        /// Checkpointing of spring parameters and any
+        /// outstanding contraction force
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Flat copy of the spring parameters
+        SpringState state() const;
+        void setState(SpringState const & state);
+
       private:
         PointMass & m_p0;
         PointMass & m_p1;
@@ -1,27 +1,56 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "physics/PhysicsEngine.hpp"
+#include "instrument/Instrument.hpp"
 #include "physics/PointMass.hpp"
 #include "physics/Vector3.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
 
 namespace physics {
 
     PhysicsEngine::PhysicsEngine(int const pointCount)
     : m_masses()
     , m_springs()
+    , m_positionMutexes()
     {
+        reserve(pointCount);
+    }
+
+    void PhysicsEngine::reserve(int const pointCount)
+    {
+        if (!m_masses.empty()) {
+            throw std::runtime_error("PhysicsEngine::reserve: engine not empty");
+        }
         auto const blockCount = (pointCount / 2) - 1;
         auto const springCount = ((blockCount * 4) + blockCount + 1);
         m_masses.reserve(pointCount);
         m_springs.reserve(springCount);
+        while (m_positionMutexes.size() < pointCount) {
+            m_positionMutexes.push_back(std::make_shared<std::mutex>());
+        }
+    }
+
+    void PhysicsEngine::truncate(int const pointCount, int const springCount)
+    {
+        while (m_springs.size() > springCount) {
+            m_springs.pop_back();
+        }
+        while (m_masses.size() > pointCount) {
+            m_masses.pop_back();
+        }
     }
 
     int PhysicsEngine::addPointMass(Vector3 const & position,
                                     double const mass, 
                                     bool const fixed)
     {
-        m_masses.emplace_back(position, mass, fixed);
-        return m_masses.size() - 1;
+        auto const index = m_masses.size();
+        if (index >= m_positionMutexes.size()) {
+            m_positionMutexes.push_back(std::make_shared<std::mutex>());
+        }
+        m_masses.emplace_back(position, mass, fixed, m_positionMutexes[index]);
+        return index;
     }
 
     void PhysicsEngine::setPointForceExternal(int const i,  Vector3 const & force)
@@ -103,6 +132,8 @@ namespace physics {
 
     void PhysicsEngine::update(double const dv)
     {
+        INSTRUMENT_SCOPE("physics.update");
+        INSTRUMENT_COUNT("physics.substeps", 1);
         std::for_each(std::begin(m_springs), 
                       std::end(m_springs), 
                       [](Spring & s) { s.apply(); });
@@ -123,4 +154,61 @@ namespace physics {
     {
         m_masses[i].toInitialPosition();
     }
+
+    void PhysicsEngine::save(serial::BinaryWriter & writer) const
+    {
+        writer.write(static_cast<std::int32_t>(m_masses.size()));
+        writer.write(static_cast<std::int32_t>(m_springs.size()));
+        for (auto const & pm : m_masses) {
+            pm.save(writer);
+        }
+        for (auto const & s : m_springs) {
+            s.save(writer);
+        }
+    }
+
+    void PhysicsEngine::load(serial::BinaryReader & reader)
+    {
+        auto const massCount = reader.read<std::int32_t>();
+        auto const springCount = reader.read<std::int32_t>();
+        if (massCount != m_masses.size() || springCount != m_springs.size()) {
+            throw std::runtime_error("PhysicsEngine::load: topology mismatch");
+        }
+        for (auto & pm : m_masses) {
+            pm.load(reader);
+        }
+        for (auto & s : m_springs) {
+            s.load(reader);
+        }
+    }
+
+    int PhysicsEngine::getPointMassCount() const
+    {
+        return m_masses.size();
+    }
+
+    int PhysicsEngine::getSpringCount() const
+    {
+        return m_springs.size();
+    }
+
+    void PhysicsEngine::exportState(PointMassState * masses, SpringState * springs) const
+    {
+        for (auto const & pm : m_masses) {
+            *masses++ = pm.state();
+        }
+        for (auto const & s : m_springs) {
+            *springs++ = s.state();
+        }
+    }
+
+    void PhysicsEngine::importState(PointMassState const * masses, SpringState const * springs)
+    {
+        for (auto & pm : m_masses) {
+            pm.setState(*masses++);
+        }
+        for (auto & s : m_springs) {
+            s.setState(*springs++);
+        }
+    }
 }
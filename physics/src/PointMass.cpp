@@ -1,6 +1,8 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "physics/PointMass.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace physics {
@@ -17,6 +19,19 @@ namespace physics {
 
     }
 
+    PointMass::PointMass(Vector3 const & position,
+                         double const mass,
+                         bool const frozen,
+                         std::shared_ptr<std::mutex> positionMutex)
+    : m_position(position)
+    , m_initialPosition(position)
+    , m_mass(mass)
+    , m_frozen(frozen)
+    , m_positionMutex(std::move(positionMutex))
+    {
+
+    }
+
     Vector3 const &
     PointMass::getForceAccum()
     {
@@ -127,4 +142,58 @@ namespace physics {
         m_forceAccum.toZero();
         m_velocity.toZero();
     }
+
+    void PointMass::save(serial::BinaryWriter & writer) const
+    {
+        std::lock_guard<std::mutex> lg(*m_positionMutex);
+        writer.write(m_position.m_vec);
+        writer.write(m_initialPosition.m_vec);
+        writer.write(m_mass);
+        writer.write(m_frozen);
+        writer.write(m_velocity.m_vec);
+        writer.write(m_acceleration.m_vec);
+        writer.write(m_forceAccum.m_vec);
+    }
+
+    void PointMass::load(serial::BinaryReader & reader)
+    {
+        std::lock_guard<std::mutex> lg(*m_positionMutex);
+        reader.read(m_position.m_vec);
+        reader.read(m_initialPosition.m_vec);
+        reader.read(m_mass);
+        reader.read(m_frozen);
+        reader.read(m_velocity.m_vec);
+        reader.read(m_acceleration.m_vec);
+        reader.read(m_forceAccum.m_vec);
+    }
+
+    PointMassState PointMass::state() const
+    {
+        PointMassState state{};
+        {
+            std::lock_guard<std::mutex> lg(*m_positionMutex);
+            std::copy(m_position.m_vec, m_position.m_vec + 3, state.position);
+        }
+        std::copy(m_initialPosition.m_vec, m_initialPosition.m_vec + 3, state.initialPosition);
+        std::copy(m_velocity.m_vec, m_velocity.m_vec + 3, state.velocity);
+        std::copy(m_acceleration.m_vec, m_acceleration.m_vec + 3, state.acceleration);
+        std::copy(m_forceAccum.m_vec, m_forceAccum.m_vec + 3, state.forceAccum);
+        state.mass = m_mass;
+        state.frozen = m_frozen;
+        return state;
+    }
+
+    void PointMass::setState(PointMassState const & state)
+    {
+        {
+            std::lock_guard<std::mutex> lg(*m_positionMutex);
+            m_position = Vector3(state.position);
+        }
+        m_initialPosition = Vector3(state.initialPosition);
+        m_velocity = Vector3(state.velocity);
+        m_acceleration = Vector3(state.acceleration);
+        m_forceAccum = Vector3(state.forceAccum);
+        m_mass = state.mass;
+        m_frozen = state.frozen != 0;
+    }
 }
@@ -1,6 +1,8 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "physics/Spring.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 
@@ -84,4 +86,50 @@ namespace physics {
         auto v = m_p1.lockedPosition() - m_p0.lockedPosition();
         return m_restLength - v.length();
     }
+
+    void Spring::save(serial::BinaryWriter & writer) const
+    {
+        writer.write(m_springConstant);
+        writer.write(m_dampener);
+        writer.write(m_restLength);
+        writer.write(m_fixedP0);
+        writer.write(m_fixedP1);
+        writer.write(m_compressForceP0.m_vec);
+        writer.write(m_compressForceP1.m_vec);
+    }
+
+    void Spring::load(serial::BinaryReader & reader)
+    {
+        reader.read(m_springConstant);
+        reader.read(m_dampener);
+        reader.read(m_restLength);
+        reader.read(m_fixedP0);
+        reader.read(m_fixedP1);
+        reader.read(m_compressForceP0.m_vec);
+        reader.read(m_compressForceP1.m_vec);
+    }
+
+    SpringState Spring::state() const
+    {
+        SpringState state{};
+        state.springConstant = m_springConstant;
+        state.dampener = m_dampener;
+        state.restLength = m_restLength;
+        std::copy(m_compressForceP0.m_vec, m_compressForceP0.m_vec + 3, state.compressForceP0);
+        std::copy(m_compressForceP1.m_vec, m_compressForceP1.m_vec + 3, state.compressForceP1);
+        state.fixedP0 = m_fixedP0;
+        state.fixedP1 = m_fixedP1;
+        return state;
+    }
+
+    void Spring::setState(SpringState const & state)
+    {
+        m_springConstant = state.springConstant;
+        m_dampener = state.dampener;
+        m_restLength = state.restLength;
+        m_compressForceP0 = Vector3(state.compressForceP0);
+        m_compressForceP1 = Vector3(state.compressForceP1);
+        m_fixedP0 = state.fixedP0 != 0;
+        m_fixedP1 = state.fixedP1 != 0;
+    }
 }
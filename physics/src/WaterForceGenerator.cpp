@@ -1,6 +1,7 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "physics/WaterForceGenerator.hpp"
+#include "instrument/Instrument.hpp"
 
 namespace physics {
 
@@ -77,6 +78,7 @@ namespace physics {
 
     void WaterForceGenerator::apply()
     {
+        INSTRUMENT_COUNT("physics.water_applies", 1);
         // Coefficients
         auto nFactor(5);
         auto tFactor(0.0875);
@@ -0,0 +1,83 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Trajectory files are a FileHeader followed by self-contained
+ * chunks. A chunk holds consecutive frames sharing one layout,
+ * stored column by column (each value of each agent across the
+ * chunk's ticks) so that slowly changing values sit together. Each
+ * column is delta-encoded by XOR-ing successive float bit patterns,
+ * the resulting words are byte-shuffled so that the mostly-zero high
+ * bytes form long runs, and the lot is zlib-compressed. The first
+ * frame of every chunk is stored against zero, which makes every
+ * chunk a keyframe that can be decoded on its own.
+ */
+
+#include "TickFrame.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace recorder {
+
+    std::uint32_t const TRAJECTORY_MAGIC = 0x52545053; // "SPTR"
+    std::uint32_t const TRAJECTORY_VERSION = 2;
+    std::uint32_t const CHUNK_MAGIC = 0x4b484354; // "TCHK"
+
+    struct FileHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+    };
+
+    struct ChunkHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t frameCount;
+        std::int64_t firstTick;
+        std::int64_t lastTick;
+        std::int32_t agentCount;
+        std::int32_t motorCount;
+        std::int32_t pointCount;
+        std::uint32_t rawSize;
+        std::uint32_t compressedSize;
+        std::uint32_t padding;
+    };
+
+    /// Accumulates frames and encodes them into chunks
+    class ChunkEncoder
+    {
+      public:
+        explicit ChunkEncoder(int const maxFrames);
+        ChunkEncoder() = delete;
+
+        /// False if the chunk is full or frame has a different layout
+        bool accepts(TickFrame const & frame) const;
+        void append(TickFrame const & frame);
+
+        int frameCount() const;
+
+        /// Appends header and compressed payload to out
+        /// and starts a new, empty chunk
+        void encode(std::vector<char> & out);
+
+      private:
+        int const m_maxFrames;
+        TickFrame m_layout;
+        std::vector<std::int64_t> m_ticks;
+
+        /// Frame-major words, transposed to columns on encode
+        std::vector<std::uint32_t> m_words;
+        std::size_t m_wordsPerFrame;
+
+        /// Scratch buffers kept between chunks
+        std::vector<std::uint32_t> m_columns;
+        std::vector<unsigned char> m_raw;
+    };
+
+    /// Decodes the payload following header into frames
+    /// (replacing whatever frames held). Throws on corrupt data.
+    void decodeChunk(ChunkHeader const & header,
+                     char const * compressed,
+                     std::vector<TickFrame> & frames);
+}
@@ -0,0 +1,73 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Image.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "SpscRing.hpp"
+#include "model/WorldSnapshot.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace recorder {
+
+    /// Writes a numbered image of the world every so many ticks, for
+    /// time-lapses of headless runs. The simulation thread only copies
+    /// a snapshot into a small lock-free ring; a writer thread renders
+    /// it with the software rasterizer, encodes it and writes
+    /// <directory>/frame_<tick>.<ext>. If the writer falls behind,
+    /// frames are dropped rather than ever blocking the simulation.
+    class FrameCapture
+    {
+      public:
+        /// queueSize must be a power of two. Throws if directory
+        /// doesn't exist.
+        FrameCapture(std::string directory,
+                     long const everyN = 100,
+                     ImageFormat const format = ImageFormat::PNG,
+                     int const width = 800,
+                     int const height = 800,
+                     View const & view = View(),
+                     int const queueSize = 4);
+        FrameCapture() = delete;
+
+        /// Closes and waits for queued frames to be written
+        ~FrameCapture();
+
+        /// Simulation thread: a snapshot to fill in for tick, or
+        /// nullptr if tick isn't sampled or the queue is full.
+        /// Every non-null snapshot must be followed by commitFrame().
+        model::WorldSnapshot * beginFrame(long const tick);
+        void commitFrame();
+
+        /// Stops accepting frames; does not block
+        void close();
+
+        std::uint64_t droppedFrames() const;
+        std::uint64_t writtenFrames() const;
+
+      private:
+        std::string m_directory;
+        long const m_everyN;
+        ImageFormat const m_format;
+        View const m_view;
+        SpscRing<model::WorldSnapshot> m_ring;
+
+        /// Only touched by the writer thread
+        SoftwareRasterizer m_rasterizer;
+        ImageEncoder m_encoder;
+        Image m_image;
+        std::vector<char> m_encoded;
+
+        std::atomic<bool> m_closed;
+        std::atomic<std::uint64_t> m_dropped;
+        std::atomic<std::uint64_t> m_written;
+        std::thread m_writerThread;
+
+        void run();
+        void writeFrame(model::WorldSnapshot const & snapshot);
+    };
+}
@@ -0,0 +1,49 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace recorder {
+
+    /// 8-bit RGB pixels, rows top to bottom
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<std::uint8_t> rgb;
+
+        void resize(int const w, int const h)
+        {
+            width = w;
+            height = h;
+            rgb.resize(static_cast<std::size_t>(w) * h * 3);
+        }
+    };
+
+    enum class ImageFormat { PPM, PNG };
+
+    /// Encodes images to PPM or PNG. Holds its scratch space
+    /// so that encoding a sequence doesn't allocate per frame.
+    class ImageEncoder
+    {
+      public:
+        ImageEncoder();
+
+        /// Replaces the contents of out with the encoded image.
+        /// Throws std::runtime_error if compression fails.
+        void encode(Image const & image,
+                    ImageFormat const format,
+                    std::vector<char> & out);
+
+        /// File extension for format, including the dot
+        static char const * extension(ImageFormat const format);
+
+      private:
+        std::vector<std::uint8_t> m_filtered;
+        std::vector<std::uint8_t> m_compressed;
+
+        void encodePNG(Image const & image, std::vector<char> & out);
+    };
+}
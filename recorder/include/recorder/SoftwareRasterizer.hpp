@@ -0,0 +1,52 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Image.hpp"
+#include "model/WorldSnapshot.hpp"
+#include <cstdint>
+
+namespace recorder {
+
+    /// What part of the world a rendered frame shows, with the
+    /// same meaning as the arguments to graphics::detail::setScene
+    struct View
+    {
+        double viewDistance = 0.4;
+        double centerX = 0;
+        double centerY = 0;
+    };
+
+    /// Draws a world snapshot into an RGB image on the CPU, with no
+    /// GL context, in the style of GLEnvironment: species-coloured
+    /// segments with dark outlines and bounding circles, simplified
+    /// to a line or a dot when animats are small. Not anti-aliased.
+    class SoftwareRasterizer
+    {
+      public:
+        SoftwareRasterizer(int const width, int const height);
+        SoftwareRasterizer() = delete;
+
+        void render(model::WorldSnapshot const & snapshot,
+                    View const & view,
+                    Image & image);
+
+      private:
+        int m_width;
+        int m_height;
+        Image * m_image;
+
+        /// World to pixel transform for the current render
+        double m_scale;
+        double m_offsetX;
+        double m_offsetY;
+
+        void toPixel(float const wx, float const wy, double & px, double & py) const;
+        void plot(int const x, int const y, std::uint8_t const * rgb);
+        void fillQuad(double const * xs, double const * ys, std::uint8_t const * rgb);
+        void drawLine(double x0, double y0, double x1, double y1,
+                      double const width, std::uint8_t const * rgb);
+        void drawCircle(double const cx, double const cy, double const r,
+                        std::uint8_t const * rgb);
+    };
+}
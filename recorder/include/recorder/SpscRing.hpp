@@ -0,0 +1,75 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace recorder {
+
+    /// A bounded, lock-free, single-producer single-consumer ring of
+    /// preallocated slots. Slots are filled and drained in place so
+    /// that whatever they own (e.g. vector capacity) is reused.
+    template <typename T>
+    class SpscRing
+    {
+      public:
+        /// capacity must be a power of two
+        explicit SpscRing(std::size_t const capacity)
+          : m_slots(capacity)
+          , m_mask(capacity - 1)
+          , m_head(0)
+          , m_tail(0)
+        {
+            if (capacity == 0 || (capacity & m_mask) != 0) {
+                throw std::runtime_error("SpscRing: capacity must be a power of two");
+            }
+        }
+        SpscRing() = delete;
+
+        /// Producer: the next free slot, or nullptr if the ring is full
+        T * acquire()
+        {
+            auto const head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) == m_slots.size()) {
+                return nullptr;
+            }
+            return &m_slots[head & m_mask];
+        }
+
+        /// Producer: hands the acquired slot to the consumer
+        void publish()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+        }
+
+        /// Consumer: the oldest published slot, or nullptr if empty
+        T * front()
+        {
+            auto const tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return &m_slots[tail & m_mask];
+        }
+
+        /// Consumer: returns the front slot to the producer
+        void release()
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+        }
+
+      private:
+        std::vector<T> m_slots;
+        std::size_t const m_mask;
+
+        /// Kept on separate cache lines so that producer
+        /// and consumer don't contend
+        alignas(64) std::atomic<std::size_t> m_head;
+        alignas(64) std::atomic<std::size_t> m_tail;
+    };
+}
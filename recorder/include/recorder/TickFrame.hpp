@@ -0,0 +1,59 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace recorder {
+
+    /// The state of every agent at one tick. Per-agent scalars are
+    /// indexed by agent; motors and point masses are appended agent
+    /// by agent, with blockCounts giving each agent's share
+    /// (2 * blocks motors and 2 * (blocks + 1) point masses).
+    /// Positions are recorded in the x-y plane that the world lives in.
+    struct TickFrame
+    {
+        std::int64_t tick;
+        std::vector<std::int32_t> blockCounts;
+        std::vector<float> centralX;
+        std::vector<float> centralY;
+        std::vector<float> heading;
+        std::vector<float> fitness;
+        std::vector<float> distance;
+        std::vector<float> speciesR;
+        std::vector<float> speciesG;
+        std::vector<float> speciesB;
+        std::vector<float> motors;
+        std::vector<float> pointX;
+        std::vector<float> pointY;
+
+        int agentCount() const
+        {
+            return blockCounts.size();
+        }
+
+        /// Empties all columns but keeps their capacity
+        void clear()
+        {
+            blockCounts.clear();
+            centralX.clear();
+            centralY.clear();
+            heading.clear();
+            fitness.clear();
+            distance.clear();
+            speciesR.clear();
+            speciesG.clear();
+            speciesB.clear();
+            motors.clear();
+            pointX.clear();
+            pointY.clear();
+        }
+
+        /// Two frames with the same layout can share a chunk
+        bool sameLayoutAs(TickFrame const & other) const
+        {
+            return blockCounts == other.blockCounts;
+        }
+    };
+}
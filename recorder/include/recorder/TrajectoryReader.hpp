@@ -0,0 +1,45 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "ChunkCodec.hpp"
+#include "TickFrame.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace recorder {
+
+    /// Random access to a trajectory file. Opening scans chunk
+    /// headers (skipping payloads) to build an index; chunks are
+    /// then decoded on demand.
+    class TrajectoryReader
+    {
+      public:
+        struct ChunkInfo
+        {
+            std::uint64_t offset;
+            ChunkHeader header;
+        };
+
+        /// Throws if path isn't a trajectory file. A truncated
+        /// final chunk (e.g. after a crash) is ignored.
+        explicit TrajectoryReader(std::string const & path);
+        TrajectoryReader() = delete;
+
+        std::vector<ChunkInfo> const & chunks() const;
+
+        /// Index of the chunk holding tick, or of the nearest chunk
+        /// before it; -1 if there are no chunks
+        int findChunk(long const tick) const;
+
+        /// Decodes chunk index into frames
+        void readChunk(int const index, std::vector<TickFrame> & frames);
+
+      private:
+        std::ifstream m_in;
+        std::vector<ChunkInfo> m_chunks;
+        std::vector<char> m_compressed;
+    };
+}
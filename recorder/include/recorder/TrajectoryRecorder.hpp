@@ -0,0 +1,65 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "ChunkCodec.hpp"
+#include "SpscRing.hpp"
+#include "TickFrame.hpp"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace recorder {
+
+    /// Streams per-tick agent state to a trajectory file. The
+    /// simulation thread fills frames in a lock-free ring; a writer
+    /// thread drains it, encodes chunks and does all file I/O. If the
+    /// writer falls behind, frames are dropped rather than ever
+    /// blocking the simulation.
+    class TrajectoryRecorder
+    {
+      public:
+        /// Records every everyN ticks in chunks of up to ticksPerChunk
+        /// frames. ringSize must be a power of two. Throws if path
+        /// can't be opened.
+        TrajectoryRecorder(std::string const & path,
+                           long const everyN = 1,
+                           int const ticksPerChunk = 64,
+                           int const ringSize = 256);
+        TrajectoryRecorder() = delete;
+
+        /// Closes and waits for everything to be written
+        ~TrajectoryRecorder();
+
+        /// Simulation thread: a cleared frame to fill in for tick,
+        /// or nullptr if tick isn't sampled or the ring is full.
+        /// Every non-null frame must be followed by commitFrame().
+        TickFrame * beginFrame(long const tick);
+        void commitFrame();
+
+        /// Stops accepting frames. The writer thread finishes the
+        /// file in the background; does not block.
+        void close();
+
+        std::uint64_t droppedFrames() const;
+
+      private:
+        std::ofstream m_out;
+        long const m_everyN;
+        SpscRing<TickFrame> m_ring;
+        ChunkEncoder m_encoder;
+
+        /// Encoded chunks waiting to be written
+        std::vector<char> m_chunkBuffer;
+
+        std::atomic<bool> m_closed;
+        std::atomic<std::uint64_t> m_dropped;
+        std::thread m_writerThread;
+
+        void run();
+        void writeChunk();
+    };
+}
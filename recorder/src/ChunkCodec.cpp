@@ -0,0 +1,269 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/ChunkCodec.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace {
+
+    /// Per-agent scalar columns: central x, central y, heading,
+    /// fitness, distance and the three species colour components
+    int const SCALAR_COLUMNS = 8;
+
+    std::size_t wordsPerFrame(int const agents, int const motors, int const points)
+    {
+        return SCALAR_COLUMNS * agents + motors + 2 * points;
+    }
+
+    /// Whether every column of frame is sized for its block counts
+    bool consistent(recorder::TickFrame const & frame)
+    {
+        std::size_t const agents = frame.agentCount();
+        std::size_t motors = 0;
+        std::size_t points = 0;
+        for (auto const blocks : frame.blockCounts) {
+            motors += 2 * blocks;
+            points += 2 * (blocks + 1);
+        }
+        for (auto const column : {&frame.centralX, &frame.centralY, &frame.heading,
+                                  &frame.fitness, &frame.distance, &frame.speciesR,
+                                  &frame.speciesG, &frame.speciesB}) {
+            if (column->size() != agents) {
+                return false;
+            }
+        }
+        return frame.motors.size() == motors &&
+               frame.pointX.size() == points &&
+               frame.pointY.size() == points;
+    }
+
+    void appendWords(std::vector<std::uint32_t> & words, std::vector<float> const & values)
+    {
+        auto const offset = words.size();
+        words.resize(offset + values.size());
+        std::memcpy(words.data() + offset, values.data(), values.size() * sizeof(float));
+    }
+
+    void takeWords(std::uint32_t const *& words, std::vector<float> & values, std::size_t const count)
+    {
+        values.resize(count);
+        std::memcpy(values.data(), words, count * sizeof(float));
+        words += count;
+    }
+}
+
+namespace recorder {
+
+    ChunkEncoder::ChunkEncoder(int const maxFrames)
+      : m_maxFrames(maxFrames)
+      , m_layout()
+      , m_ticks()
+      , m_words()
+      , m_wordsPerFrame(0)
+      , m_columns()
+      , m_raw()
+    {
+    }
+
+    bool ChunkEncoder::accepts(TickFrame const & frame) const
+    {
+        return m_ticks.empty() ||
+               (m_ticks.size() < m_maxFrames && frame.sameLayoutAs(m_layout));
+    }
+
+    void ChunkEncoder::append(TickFrame const & frame)
+    {
+        // Checked before anything changes, so that a bad frame
+        // leaves the chunk as it was
+        if (!consistent(frame)) {
+            throw std::runtime_error("ChunkEncoder: inconsistent frame");
+        }
+        if (!accepts(frame)) {
+            throw std::runtime_error("ChunkEncoder: frame doesn't fit chunk");
+        }
+        if (m_ticks.empty()) {
+            m_layout.blockCounts = frame.blockCounts;
+            m_wordsPerFrame = wordsPerFrame(frame.agentCount(),
+                                            frame.motors.size(),
+                                            frame.pointX.size());
+        }
+        m_ticks.push_back(frame.tick);
+        appendWords(m_words, frame.centralX);
+        appendWords(m_words, frame.centralY);
+        appendWords(m_words, frame.heading);
+        appendWords(m_words, frame.fitness);
+        appendWords(m_words, frame.distance);
+        appendWords(m_words, frame.speciesR);
+        appendWords(m_words, frame.speciesG);
+        appendWords(m_words, frame.speciesB);
+        appendWords(m_words, frame.motors);
+        appendWords(m_words, frame.pointX);
+        appendWords(m_words, frame.pointY);
+    }
+
+    int ChunkEncoder::frameCount() const
+    {
+        return m_ticks.size();
+    }
+
+    void ChunkEncoder::encode(std::vector<char> & out)
+    {
+        if (m_ticks.empty()) {
+            return;
+        }
+        auto const frames = m_ticks.size();
+        auto const agents = m_layout.blockCounts.size();
+        auto const wordCount = m_words.size();
+
+        // Transpose to columns and delta each column against
+        // its previous tick; the first tick is kept as-is
+        m_columns.resize(wordCount);
+        for (std::size_t t = 0; t < frames; ++t) {
+            for (std::size_t c = 0; c < m_wordsPerFrame; ++c) {
+                m_columns[c * frames + t] = m_words[t * m_wordsPerFrame + c];
+            }
+        }
+        for (std::size_t c = 0; c < m_wordsPerFrame; ++c) {
+            auto const column = m_columns.data() + c * frames;
+            for (auto t = frames - 1; t > 0; --t) {
+                column[t] ^= column[t - 1];
+            }
+        }
+
+        auto const prefix = (agents + frames) * sizeof(std::int32_t);
+        m_raw.resize(prefix + wordCount * sizeof(std::uint32_t));
+        auto raw = m_raw.data();
+        for (auto const blocks : m_layout.blockCounts) {
+            std::memcpy(raw, &blocks, sizeof(blocks));
+            raw += sizeof(blocks);
+        }
+        for (auto const tick : m_ticks) {
+            auto const delta = static_cast<std::uint32_t>(tick - m_ticks.front());
+            std::memcpy(raw, &delta, sizeof(delta));
+            raw += sizeof(delta);
+        }
+
+        // Byte shuffle: all low bytes, then all second bytes, etc.
+        for (std::size_t i = 0; i < wordCount; ++i) {
+            auto const word = m_columns[i];
+            raw[i] = word & 0xff;
+            raw[wordCount + i] = (word >> 8) & 0xff;
+            raw[2 * wordCount + i] = (word >> 16) & 0xff;
+            raw[3 * wordCount + i] = (word >> 24) & 0xff;
+        }
+
+        int motors = 0;
+        int points = 0;
+        for (auto const blocks : m_layout.blockCounts) {
+            motors += 2 * blocks;
+            points += 2 * (blocks + 1);
+        }
+
+        ChunkHeader header{};
+        header.magic = CHUNK_MAGIC;
+        header.frameCount = frames;
+        header.firstTick = m_ticks.front();
+        header.lastTick = m_ticks.back();
+        header.agentCount = agents;
+        header.motorCount = motors;
+        header.pointCount = points;
+        header.rawSize = m_raw.size();
+
+        auto const offset = out.size();
+        auto bound = ::compressBound(m_raw.size());
+        out.resize(offset + sizeof(header) + bound);
+        auto const dest = reinterpret_cast<Bytef *>(out.data() + offset + sizeof(header));
+        if (::compress2(dest, &bound, m_raw.data(), m_raw.size(), Z_BEST_SPEED) != Z_OK) {
+            throw std::runtime_error("ChunkEncoder: compression failed");
+        }
+        header.compressedSize = bound;
+        std::memcpy(out.data() + offset, &header, sizeof(header));
+        out.resize(offset + sizeof(header) + bound);
+
+        m_ticks.clear();
+        m_words.clear();
+    }
+
+    void decodeChunk(ChunkHeader const & header,
+                     char const * compressed,
+                     std::vector<TickFrame> & frames)
+    {
+        if (header.magic != CHUNK_MAGIC ||
+            header.agentCount < 0 || header.motorCount < 0 || header.pointCount < 0) {
+            throw std::runtime_error("decodeChunk: bad chunk header");
+        }
+        std::size_t const frameCount = header.frameCount;
+        std::size_t const agents = header.agentCount;
+        auto const perFrame = wordsPerFrame(header.agentCount,
+                                            header.motorCount,
+                                            header.pointCount);
+        auto const wordCount = perFrame * frameCount;
+        auto const prefix = (agents + frameCount) * sizeof(std::int32_t);
+        if (header.rawSize != prefix + wordCount * sizeof(std::uint32_t)) {
+            throw std::runtime_error("decodeChunk: size mismatch");
+        }
+
+        std::vector<unsigned char> raw(header.rawSize);
+        uLongf rawSize = raw.size();
+        if (::uncompress(raw.data(), &rawSize,
+                         reinterpret_cast<Bytef const *>(compressed),
+                         header.compressedSize) != Z_OK || rawSize != raw.size()) {
+            throw std::runtime_error("decodeChunk: decompression failed");
+        }
+
+        std::vector<std::int32_t> blockCounts(agents);
+        std::memcpy(blockCounts.data(), raw.data(), agents * sizeof(std::int32_t));
+        int motors = 0;
+        int points = 0;
+        for (auto const blocks : blockCounts) {
+            motors += 2 * blocks;
+            points += 2 * (blocks + 1);
+        }
+        if (motors != header.motorCount || points != header.pointCount) {
+            throw std::runtime_error("decodeChunk: layout mismatch");
+        }
+        std::vector<std::uint32_t> tickDeltas(frameCount);
+        std::memcpy(tickDeltas.data(), raw.data() + agents * sizeof(std::int32_t),
+                    frameCount * sizeof(std::uint32_t));
+
+        // Undo the shuffle and the deltas, then transpose back to frames
+        auto const planes = raw.data() + prefix;
+        std::vector<std::uint32_t> columns(wordCount);
+        for (std::size_t i = 0; i < wordCount; ++i) {
+            columns[i] = std::uint32_t(planes[i]) |
+                         std::uint32_t(planes[wordCount + i]) << 8 |
+                         std::uint32_t(planes[2 * wordCount + i]) << 16 |
+                         std::uint32_t(planes[3 * wordCount + i]) << 24;
+        }
+        for (std::size_t c = 0; c < perFrame; ++c) {
+            auto const column = columns.data() + c * frameCount;
+            for (std::size_t t = 1; t < frameCount; ++t) {
+                column[t] ^= column[t - 1];
+            }
+        }
+        std::vector<std::uint32_t> words(perFrame);
+
+        frames.resize(frameCount);
+        for (std::size_t t = 0; t < frameCount; ++t) {
+            for (std::size_t c = 0; c < perFrame; ++c) {
+                words[c] = columns[c * frameCount + t];
+            }
+            auto & frame = frames[t];
+            frame.tick = header.firstTick + tickDeltas[t];
+            frame.blockCounts = blockCounts;
+            std::uint32_t const * in = words.data();
+            takeWords(in, frame.centralX, agents);
+            takeWords(in, frame.centralY, agents);
+            takeWords(in, frame.heading, agents);
+            takeWords(in, frame.fitness, agents);
+            takeWords(in, frame.distance, agents);
+            takeWords(in, frame.speciesR, agents);
+            takeWords(in, frame.speciesG, agents);
+            takeWords(in, frame.speciesB, agents);
+            takeWords(in, frame.motors, motors);
+            takeWords(in, frame.pointX, points);
+            takeWords(in, frame.pointY, points);
+        }
+    }
+}
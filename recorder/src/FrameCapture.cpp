@@ -0,0 +1,114 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/FrameCapture.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace recorder {
+
+    FrameCapture::FrameCapture(std::string directory,
+                               long const everyN,
+                               ImageFormat const format,
+                               int const width,
+                               int const height,
+                               View const & view,
+                               int const queueSize)
+      : m_directory(std::move(directory))
+      , m_everyN(std::max(everyN, 1L))
+      , m_format(format)
+      , m_view(view)
+      , m_ring(queueSize)
+      , m_rasterizer(width, height)
+      , m_encoder()
+      , m_image()
+      , m_encoded()
+      , m_closed(false)
+      , m_dropped(0)
+      , m_written(0)
+    {
+        struct stat info;
+        if (::stat(m_directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+            throw std::runtime_error("FrameCapture: no such directory " + m_directory);
+        }
+        m_writerThread = std::thread(&FrameCapture::run, this);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        close();
+        m_writerThread.join();
+    }
+
+    model::WorldSnapshot * FrameCapture::beginFrame(long const tick)
+    {
+        if (m_closed || tick % m_everyN != 0) {
+            return nullptr;
+        }
+        auto const snapshot = m_ring.acquire();
+        if (!snapshot) {
+            ++m_dropped;
+        }
+        return snapshot;
+    }
+
+    void FrameCapture::commitFrame()
+    {
+        m_ring.publish();
+    }
+
+    void FrameCapture::close()
+    {
+        m_closed = true;
+    }
+
+    std::uint64_t FrameCapture::droppedFrames() const
+    {
+        return m_dropped;
+    }
+
+    std::uint64_t FrameCapture::writtenFrames() const
+    {
+        return m_written;
+    }
+
+    void FrameCapture::run()
+    {
+        while (true) {
+            auto const snapshot = m_ring.front();
+            if (!snapshot) {
+                if (m_closed && !m_ring.front()) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            try {
+                writeFrame(*snapshot);
+            } catch (std::exception const & e) {
+                std::cerr << "FrameCapture: " << e.what() << std::endl;
+            }
+            m_ring.release();
+        }
+    }
+
+    void FrameCapture::writeFrame(model::WorldSnapshot const & snapshot)
+    {
+        m_rasterizer.render(snapshot, m_view, m_image);
+        m_encoder.encode(m_image, m_format, m_encoded);
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%010ld", snapshot.tick);
+        auto const path = m_directory + name + ImageEncoder::extension(m_format);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(m_encoded.data(), m_encoded.size());
+        if (!out) {
+            throw std::runtime_error("failed to write " + path);
+        }
+        ++m_written;
+    }
+}
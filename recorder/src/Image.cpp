@@ -0,0 +1,100 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/Image.hpp"
+#include <zlib.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+    void appendBigEndian(std::vector<char> & out, std::uint32_t const value)
+    {
+        out.push_back(static_cast<char>(value >> 24));
+        out.push_back(static_cast<char>(value >> 16));
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value));
+    }
+
+    /// Length, type, data and a CRC over type and data
+    void appendChunk(std::vector<char> & out,
+                     char const * type,
+                     std::uint8_t const * data,
+                     std::size_t const size)
+    {
+        appendBigEndian(out, static_cast<std::uint32_t>(size));
+        auto const start = out.size();
+        out.insert(std::end(out), type, type + 4);
+        out.insert(std::end(out), data, data + size);
+        auto const crc = ::crc32(0L,
+                                 reinterpret_cast<Bytef const *>(out.data() + start),
+                                 static_cast<uInt>(size + 4));
+        appendBigEndian(out, static_cast<std::uint32_t>(crc));
+    }
+}
+
+namespace recorder {
+
+    ImageEncoder::ImageEncoder()
+      : m_filtered()
+      , m_compressed()
+    {
+    }
+
+    char const * ImageEncoder::extension(ImageFormat const format)
+    {
+        return format == ImageFormat::PNG ? ".png" : ".ppm";
+    }
+
+    void ImageEncoder::encode(Image const & image,
+                              ImageFormat const format,
+                              std::vector<char> & out)
+    {
+        out.clear();
+        if (format == ImageFormat::PNG) {
+            encodePNG(image, out);
+            return;
+        }
+        auto const header = "P6\n" + std::to_string(image.width) + " " +
+                            std::to_string(image.height) + "\n255\n";
+        out.insert(std::end(out), std::begin(header), std::end(header));
+        out.insert(std::end(out), std::begin(image.rgb), std::end(image.rgb));
+    }
+
+    void ImageEncoder::encodePNG(Image const & image, std::vector<char> & out)
+    {
+        // Every row gets filter type 0 (none); the image is mostly
+        // flat background, which zlib handles well enough unfiltered
+        auto const rowBytes = static_cast<std::size_t>(image.width) * 3;
+        m_filtered.resize((rowBytes + 1) * image.height);
+        for (int y = 0; y < image.height; ++y) {
+            auto * row = &m_filtered[y * (rowBytes + 1)];
+            row[0] = 0;
+            std::memcpy(row + 1, &image.rgb[y * rowBytes], rowBytes);
+        }
+        auto bound = ::compressBound(m_filtered.size());
+        m_compressed.resize(bound);
+        if (::compress2(m_compressed.data(), &bound,
+                        m_filtered.data(), m_filtered.size(), Z_BEST_SPEED) != Z_OK) {
+            throw std::runtime_error("ImageEncoder: compression failed");
+        }
+
+        static char const signature[] = {'\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n'};
+        out.insert(std::end(out), signature, signature + sizeof(signature));
+
+        std::uint8_t header[13];
+        auto const putBigEndian = [](std::uint8_t * p, std::uint32_t const v) {
+            p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+        };
+        putBigEndian(header, image.width);
+        putBigEndian(header + 4, image.height);
+        header[8] = 8;  // bit depth
+        header[9] = 2;  // truecolour
+        header[10] = 0; // deflate
+        header[11] = 0; // adaptive filtering
+        header[12] = 0; // not interlaced
+        appendChunk(out, "IHDR", header, sizeof(header));
+        appendChunk(out, "IDAT", m_compressed.data(), bound);
+        appendChunk(out, "IEND", nullptr, 0);
+    }
+}
@@ -0,0 +1,187 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/SoftwareRasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // Same as Graphics' clear colour and GLAnimat's basic colour
+    std::uint8_t const BACKGROUND[3] = {230, 230, 250};
+    std::uint8_t const OUTLINE[3] = {87, 89, 92};
+}
+
+namespace recorder {
+
+    SoftwareRasterizer::SoftwareRasterizer(int const width, int const height)
+      : m_width(width)
+      , m_height(height)
+      , m_image(nullptr)
+      , m_scale(1)
+      , m_offsetX(0)
+      , m_offsetY(0)
+    {
+    }
+
+    void SoftwareRasterizer::toPixel(float const wx, float const wy,
+                                     double & px, double & py) const
+    {
+        px = wx * m_scale + m_offsetX;
+        py = m_offsetY - wy * m_scale;
+    }
+
+    void SoftwareRasterizer::plot(int const x, int const y, std::uint8_t const * rgb)
+    {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return;
+        }
+        auto * pixel = &m_image->rgb[(static_cast<std::size_t>(y) * m_width + x) * 3];
+        pixel[0] = rgb[0];
+        pixel[1] = rgb[1];
+        pixel[2] = rgb[2];
+    }
+
+    void SoftwareRasterizer::fillQuad(double const * xs, double const * ys,
+                                      std::uint8_t const * rgb)
+    {
+        auto const minX = std::max(0, static_cast<int>(std::floor(*std::min_element(xs, xs + 4))));
+        auto const maxX = std::min(m_width - 1, static_cast<int>(std::ceil(*std::max_element(xs, xs + 4))));
+        auto const minY = std::max(0, static_cast<int>(std::floor(*std::min_element(ys, ys + 4))));
+        auto const maxY = std::min(m_height - 1, static_cast<int>(std::ceil(*std::max_element(ys, ys + 4))));
+
+        // Inside a convex quad, the pixel centre is on the same
+        // side of all four edges, whichever way round they wind
+        for (int y = minY; y <= maxY; ++y) {
+            for (int x = minX; x <= maxX; ++x) {
+                auto const px = x + 0.5;
+                auto const py = y + 0.5;
+                auto positive = 0;
+                auto negative = 0;
+                for (int e = 0; e < 4; ++e) {
+                    auto const n = (e + 1) % 4;
+                    auto const side = (xs[n] - xs[e]) * (py - ys[e]) -
+                                      (ys[n] - ys[e]) * (px - xs[e]);
+                    if (side > 0) {
+                        ++positive;
+                    } else if (side < 0) {
+                        ++negative;
+                    }
+                }
+                if (positive == 0 || negative == 0) {
+                    plot(x, y, rgb);
+                }
+            }
+        }
+    }
+
+    void SoftwareRasterizer::drawLine(double x0, double y0, double x1, double y1,
+                                      double const width, std::uint8_t const * rgb)
+    {
+        auto const dx = x1 - x0;
+        auto const dy = y1 - y0;
+        auto const length = std::sqrt(dx * dx + dy * dy);
+        if (length < 1e-6) {
+            plot(static_cast<int>(x0), static_cast<int>(y0), rgb);
+            return;
+        }
+
+        // A thick line is a quad around the centre line
+        auto const nx = -dy / length * width / 2;
+        auto const ny = dx / length * width / 2;
+        double const xs[4] = {x0 + nx, x1 + nx, x1 - nx, x0 - nx};
+        double const ys[4] = {y0 + ny, y1 + ny, y1 - ny, y0 - ny};
+        fillQuad(xs, ys, rgb);
+    }
+
+    void SoftwareRasterizer::drawCircle(double const cx, double const cy, double const r,
+                                        std::uint8_t const * rgb)
+    {
+        // Midpoint circle, one pixel wide
+        int x = static_cast<int>(std::lround(r));
+        int y = 0;
+        int error = 1 - x;
+        auto const ix = static_cast<int>(std::lround(cx));
+        auto const iy = static_cast<int>(std::lround(cy));
+        while (x >= y) {
+            plot(ix + x, iy + y, rgb); plot(ix - x, iy + y, rgb);
+            plot(ix + x, iy - y, rgb); plot(ix - x, iy - y, rgb);
+            plot(ix + y, iy + x, rgb); plot(ix - y, iy + x, rgb);
+            plot(ix + y, iy - x, rgb); plot(ix - y, iy - x, rgb);
+            ++y;
+            if (error < 0) {
+                error += 2 * y + 1;
+            } else {
+                --x;
+                error += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    void SoftwareRasterizer::render(model::WorldSnapshot const & snapshot,
+                                    View const & view,
+                                    Image & image)
+    {
+        image.resize(m_width, m_height);
+        for (std::size_t i = 0; i < image.rgb.size(); i += 3) {
+            image.rgb[i] = BACKGROUND[0];
+            image.rgb[i + 1] = BACKGROUND[1];
+            image.rgb[i + 2] = BACKGROUND[2];
+        }
+        m_image = &image;
+        m_scale = 1.0 / view.viewDistance;
+        m_offsetX = m_width / 2.0 - view.centerX * m_scale;
+        m_offsetY = m_height / 2.0 + view.centerY * m_scale;
+
+        for (int a = 0; a < snapshot.animatCount(); ++a) {
+            auto const * central = &snapshot.centralCircles[3 * a];
+            double cx, cy;
+            toPixel(central[0], central[1], cx, cy);
+            auto const radius = central[2] * m_scale;
+            if (cx + radius < 0 || cx - radius >= m_width ||
+                cy + radius < 0 || cy - radius >= m_height) {
+                continue;
+            }
+
+            auto const first = snapshot.blockOffsets[a];
+            auto const last = snapshot.blockOffsets[a + 1];
+            if (radius < 2.0) {
+                plot(static_cast<int>(cx), static_cast<int>(cy), OUTLINE);
+                continue;
+            }
+            if (radius < 8.0) {
+                auto const * tail = &snapshot.blockCorners[8 * first];
+                auto const * head = &snapshot.blockCorners[8 * (last - 1)];
+                double x0, y0, x1, y1;
+                toPixel((tail[0] + tail[2]) / 2, (tail[1] + tail[3]) / 2, x0, y0);
+                toPixel((head[4] + head[6]) / 2, (head[5] + head[7]) / 2, x1, y1);
+                drawLine(x0, y0, x1, y1, 2.0, OUTLINE);
+                continue;
+            }
+
+            auto const * colour = &snapshot.colours[3 * a];
+            for (int b = first; b < last; ++b) {
+                auto const * q = &snapshot.blockCorners[8 * b];
+                double xs[4], ys[4];
+                for (int c = 0; c < 4; ++c) {
+                    toPixel(q[2 * c], q[2 * c + 1], xs[c], ys[c]);
+                }
+                fillQuad(xs, ys, colour);
+                for (int e = 0; e < 4; ++e) {
+                    auto const n = (e + 1) % 4;
+                    drawLine(xs[e], ys[e], xs[n], ys[n], 2.0, OUTLINE);
+                }
+            }
+
+            // Block circles only once they're big enough to make out
+            if (m_scale >= 2.0) {
+                for (int b = first; b < last; ++b) {
+                    auto const * circle = &snapshot.blockCircles[3 * b];
+                    double px, py;
+                    toPixel(circle[0], circle[1], px, py);
+                    drawCircle(px, py, circle[2] * m_scale, OUTLINE);
+                }
+            }
+        }
+        m_image = nullptr;
+    }
+}
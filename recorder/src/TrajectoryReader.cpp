@@ -0,0 +1,71 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/TrajectoryReader.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace recorder {
+
+    TrajectoryReader::TrajectoryReader(std::string const & path)
+      : m_in(path, std::ios::binary)
+      , m_chunks()
+      , m_compressed()
+    {
+        FileHeader fileHeader{};
+        m_in.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader));
+        if (!m_in || fileHeader.magic != TRAJECTORY_MAGIC) {
+            throw std::runtime_error("TrajectoryReader: not a trajectory file: " + path);
+        }
+        if (fileHeader.version != TRAJECTORY_VERSION) {
+            throw std::runtime_error("TrajectoryReader: unsupported version");
+        }
+
+        m_in.seekg(0, std::ios::end);
+        std::uint64_t const fileSize = m_in.tellg();
+        std::uint64_t offset = sizeof(fileHeader);
+        while (offset + sizeof(ChunkHeader) <= fileSize) {
+            ChunkInfo info{offset, {}};
+            m_in.seekg(offset);
+            m_in.read(reinterpret_cast<char *>(&info.header), sizeof(ChunkHeader));
+            if (!m_in || info.header.magic != CHUNK_MAGIC) {
+                break;
+            }
+            offset += sizeof(ChunkHeader) + info.header.compressedSize;
+            if (offset > fileSize) {
+                break;
+            }
+            m_chunks.push_back(info);
+        }
+        m_in.clear();
+    }
+
+    std::vector<TrajectoryReader::ChunkInfo> const & TrajectoryReader::chunks() const
+    {
+        return m_chunks;
+    }
+
+    int TrajectoryReader::findChunk(long const tick) const
+    {
+        auto const it = std::upper_bound(std::begin(m_chunks), std::end(m_chunks), tick,
+                                         [](long const t, ChunkInfo const & info) {
+                                             return t < info.header.firstTick;
+                                         });
+        if (it == std::begin(m_chunks)) {
+            return m_chunks.empty() ? -1 : 0;
+        }
+        return std::distance(std::begin(m_chunks), it) - 1;
+    }
+
+    void TrajectoryReader::readChunk(int const index, std::vector<TickFrame> & frames)
+    {
+        auto const & info = m_chunks.at(index);
+        m_compressed.resize(info.header.compressedSize);
+        m_in.seekg(info.offset + sizeof(ChunkHeader));
+        m_in.read(m_compressed.data(), m_compressed.size());
+        if (!m_in) {
+            m_in.clear();
+            throw std::runtime_error("TrajectoryReader: failed to read chunk");
+        }
+        decodeChunk(info.header, m_compressed.data(), frames);
+    }
+}
@@ -0,0 +1,106 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "recorder/TrajectoryRecorder.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace recorder {
+
+    TrajectoryRecorder::TrajectoryRecorder(std::string const & path,
+                                           long const everyN,
+                                           int const ticksPerChunk,
+                                           int const ringSize)
+      : m_out(path, std::ios::binary | std::ios::trunc)
+      , m_everyN(std::max(everyN, 1L))
+      , m_ring(ringSize)
+      , m_encoder(ticksPerChunk)
+      , m_chunkBuffer()
+      , m_closed(false)
+      , m_dropped(0)
+    {
+        if (!m_out) {
+            throw std::runtime_error("TrajectoryRecorder: failed to open " + path);
+        }
+        FileHeader const header{TRAJECTORY_MAGIC, TRAJECTORY_VERSION};
+        m_out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        m_writerThread = std::thread(&TrajectoryRecorder::run, this);
+    }
+
+    TrajectoryRecorder::~TrajectoryRecorder()
+    {
+        close();
+        m_writerThread.join();
+    }
+
+    TickFrame * TrajectoryRecorder::beginFrame(long const tick)
+    {
+        if (m_closed || tick % m_everyN != 0) {
+            return nullptr;
+        }
+        auto const frame = m_ring.acquire();
+        if (!frame) {
+            ++m_dropped;
+            return nullptr;
+        }
+        frame->clear();
+        frame->tick = tick;
+        return frame;
+    }
+
+    void TrajectoryRecorder::commitFrame()
+    {
+        m_ring.publish();
+    }
+
+    void TrajectoryRecorder::close()
+    {
+        m_closed = true;
+    }
+
+    std::uint64_t TrajectoryRecorder::droppedFrames() const
+    {
+        return m_dropped;
+    }
+
+    void TrajectoryRecorder::run()
+    {
+        while (true) {
+            auto const frame = m_ring.front();
+            if (!frame) {
+                // Checked before the ring is re-examined so that a
+                // frame committed just before closing is still written
+                if (m_closed && !m_ring.front()) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                continue;
+            }
+            try {
+                if (!m_encoder.accepts(*frame)) {
+                    writeChunk();
+                }
+                m_encoder.append(*frame);
+            } catch (std::exception const & e) {
+                std::cerr << "TrajectoryRecorder: " << e.what() << std::endl;
+            }
+            m_ring.release();
+        }
+        try {
+            writeChunk();
+        } catch (std::exception const & e) {
+            std::cerr << "TrajectoryRecorder: " << e.what() << std::endl;
+        }
+        m_out.flush();
+    }
+
+    void TrajectoryRecorder::writeChunk()
+    {
+        m_chunkBuffer.clear();
+        m_encoder.encode(m_chunkBuffer);
+        m_out.write(m_chunkBuffer.data(), m_chunkBuffer.size());
+        if (!m_out) {
+            throw std::runtime_error("failed to write chunk");
+        }
+    }
+}
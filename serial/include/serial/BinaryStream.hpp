@@ -0,0 +1,113 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * Minimal binary writer and reader used for checkpointing. Values
+ * are copied out as raw bytes in host byte order; checkpoints are
+ * meant to be restored on the machine (or same kind of machine)
+ * that wrote them.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace serial {
+
+    class BinaryWriter
+    {
+      public:
+        /// Appends to buffer. The buffer is not cleared so that
+        /// its capacity can be reused from one write to the next.
+        explicit BinaryWriter(std::vector<char> & buffer)
+          : m_buffer(buffer)
+        {
+        }
+        BinaryWriter() = delete;
+
+        template <typename T>
+        void write(T const & value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "BinaryWriter: type must be trivially copyable");
+            writeBytes(&value, sizeof(T));
+        }
+
+        void writeBytes(void const * data, std::size_t const size)
+        {
+            auto const offset = m_buffer.size();
+            m_buffer.resize(offset + size);
+            std::memcpy(m_buffer.data() + offset, data, size);
+        }
+
+        std::size_t size() const
+        {
+            return m_buffer.size();
+        }
+
+      private:
+        std::vector<char> & m_buffer;
+    };
+
+    class BinaryReader
+    {
+      public:
+        BinaryReader(char const * data, std::size_t const size)
+          : m_data(data)
+          , m_size(size)
+          , m_offset(0)
+        {
+        }
+        BinaryReader() = delete;
+
+        template <typename T>
+        void read(T & value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "BinaryReader: type must be trivially copyable");
+            readBytes(&value, sizeof(T));
+        }
+
+        template <typename T>
+        T read()
+        {
+            T value;
+            read(value);
+            return value;
+        }
+
+        void readBytes(void * data, std::size_t const size)
+        {
+            if (size > m_size - m_offset) {
+                throw std::runtime_error("BinaryReader: unexpected end of data");
+            }
+            std::memcpy(data, m_data + m_offset, size);
+            m_offset += size;
+        }
+
+        /// Reads a count and checks it against an upper bound so that
+        /// a corrupt stream can't trigger a huge allocation
+        int readCount(int const bound)
+        {
+            auto const count = read<std::int32_t>();
+            if (count < 0 || count > bound) {
+                throw std::runtime_error("BinaryReader: count out of range");
+            }
+            return count;
+        }
+
+        bool atEnd() const
+        {
+            return m_offset == m_size;
+        }
+
+      private:
+        char const * m_data;
+        std::size_t m_size;
+        std::size_t m_offset;
+    };
+}
@@ -3,12 +3,15 @@
 #pragma once
 
 #include "Controller.hpp"
+#include "FlatCheckpointLayout.hpp"
 #include "model/Animat.hpp"
 #include "model/SpeciesColour.hpp"
 #include "neat/Network.hpp"
 #include "physics/Vector3.hpp"
+#include "recorder/TickFrame.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace simulator {
 
@@ -23,6 +26,10 @@ namespace simulator {
         /// Returns 0 on success, -1 if problem
         int update(std::vector<Agent> & otherAgents);
 
+        /// As above but without collisions, touching nothing but this
+        /// agent, so that agents can be updated concurrently
+        int update();
+
         /// Mutates the NEAT architecture
         void mutateNeat();
 
@@ -30,6 +37,10 @@ namespace simulator {
         void inheritNeat(Agent const & other);
         void inheritNeat(neat::Network const & net);
 
+        /// Inherits a cross-over of two agents' genomes: fitter's,
+        /// with each gene it shares with mate taking either's weight
+        void inheritNeat(Agent const & fitter, Agent const & mate);
+
         /// Set the current central starting
         void recordStartPosition();
 
@@ -41,7 +52,16 @@ namespace simulator {
 
         void resetController();
 
-        neat::Network getNeatNet() const;
+        neat::Network const & getNeatNet() const;
+
+        /// The number of body segments genome encodes, or -1 for
+        /// genomes from before the segment output existed. The
+        /// genome is evaluated against fixed inputs so that the answer
+        /// depends on the genome alone; its own inputs are untouched.
+        static int segmentCount(neat::Network const & genome);
+
+        /// segmentCount of this agent's genome
+        int segmentCount() const;
 
         /// An agent is considered 'bad' if its physics
         /// became unstable during the simulation process.
@@ -64,6 +84,30 @@ namespace simulator {
 
         void enableCollisionHandling();
         void disableCollisionHandling();
+        bool handlesCollisions() const;
+
+        /// Rebind to a (possibly reconstructed) animat
+        void updateAnimat(std::shared_ptr<model::Animat> animat);
+
+        /// Checkpointing of genome, age and fitness bookkeeping.
+        /// The controller is rebuilt from the genome on load.
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Flat checkpointing. exportRecord fills in everything but
+        /// the record offsets, which are assigned by the caller, and
+        /// writes the genome to arrays sized by record.genome.
+        FlatAgent exportRecord() const;
+        void exportGenome(neat::NodeState * nodes,
+                          neat::ConnectionState * connections,
+                          neat::InnovationInfo * innovations) const;
+        void importState(FlatAgent const & record,
+                         neat::NodeState const * nodes,
+                         neat::ConnectionState const * connections,
+                         neat::InnovationInfo const * innovations);
+
+        /// Appends this agent's current state to a trajectory frame
+        void recordFrame(recorder::TickFrame & frame) const;
 
       private:
 
@@ -77,6 +121,11 @@ namespace simulator {
         /// Controls the animat agent, it's movements etc.
         std::shared_ptr<Controller> m_controller;
 
+        /// Every controller built so far, indexed by the block count
+        /// it was built for, so that a body changing size and back
+        /// again reuses the controller it had
+        std::vector<std::shared_ptr<Controller>> m_controllers;
+
         /// stores start position to compute distance travelled
         physics::Vector3 m_startPosition;
 
@@ -95,5 +144,8 @@ namespace simulator {
         /// Should we do collision detection?
         bool m_handleCollisions;
 
+        /// otherAgents is null to skip collision handling
+        int step(std::vector<Agent> * otherAgents);
+
     };
 }
\ No newline at end of file
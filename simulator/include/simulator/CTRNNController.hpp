@@ -2,6 +2,8 @@
 
 #pragma once
 #include "Controller.hpp"
+#include "ctrnn/FixedNetwork.hpp"
+#include "instrument/Instrument.hpp"
 #include "ctrnn/Network.hpp"
 #include "model/NeuralSubstrate.hpp"
 #include "neat/Network.hpp"
@@ -9,25 +11,34 @@
 #include "neat/Connection.hpp"
 #include <cstdlib>
 #include <cmath>
+#include <memory>
 
 namespace simulator {
-    class CTRNNController : public Controller
+
+    /// Controller driving an animat from a CTRNN whose weights and
+    /// time constants are derived from a neat genome. Parameterized
+    /// on the network type so that the common block counts can use
+    /// a compile-time sized ctrnn::FixedNetwork.
+    template <typename CTRNN>
+    class BasicCTRNNController : public Controller
     {
       public:
-        explicit CTRNNController(int const blockCount,
-                                 neat::Network & neatNet)
+        explicit BasicCTRNNController(int const blockCount,
+                                      neat::Network & neatNet)
           : m_blockCount(blockCount)
           , m_neatNet(neatNet)
+          , m_neuralSubstrate(blockCount)
           , m_ctrnn(blockCount * 4, 15.0)
         {
             set();
         }
 
-        CTRNNController() = delete;
+        BasicCTRNNController() = delete;
 
         void set() override
         {
-            model::NeuralSubstrate neuralSubstrate(m_blockCount);
+            INSTRUMENT_SCOPE("ctrnn.set");
+            auto const & neuralSubstrate = m_neuralSubstrate;
 
             int const nodeCount = m_blockCount * 4;
 
@@ -76,12 +87,50 @@ namespace simulator {
         }
         void update() override
         {
+            INSTRUMENT_SCOPE("ctrnn.update");
             m_ctrnn.update();
         }
+        void reset() override
+        {
+            // In place: set() rewrites every weight and time constant
+            // it ever wrote, and the rest are still zero
+            m_ctrnn.resetState();
+            set();
+        }
       private:
         int const m_blockCount;
         neat::Network & m_neatNet;
-        mutable ctrnn::Network m_ctrnn;
+
+        /// Neuron coordinates; fixed by the block count, so built once
+        /// rather than on every set()
+        model::NeuralSubstrate const m_neuralSubstrate;
+
+        mutable CTRNN m_ctrnn;
 
     };
+
+    /// The general, dynamically sized controller
+    using CTRNNController = BasicCTRNNController<ctrnn::Network>;
+
+    template <int N>
+    using FixedCTRNNController = BasicCTRNNController<ctrnn::FixedNetwork<N>>;
+
+    /// Builds the controller for an animat of blockCount blocks. Block
+    /// counts animats can have (5 to 12) get a fixed-size network;
+    /// anything else falls back to the dynamic one.
+    inline std::shared_ptr<Controller>
+    makeCTRNNController(int const blockCount, neat::Network & neatNet)
+    {
+        switch (blockCount) {
+            case 5: return std::make_shared<FixedCTRNNController<20>>(blockCount, neatNet);
+            case 6: return std::make_shared<FixedCTRNNController<24>>(blockCount, neatNet);
+            case 7: return std::make_shared<FixedCTRNNController<28>>(blockCount, neatNet);
+            case 8: return std::make_shared<FixedCTRNNController<32>>(blockCount, neatNet);
+            case 9: return std::make_shared<FixedCTRNNController<36>>(blockCount, neatNet);
+            case 10: return std::make_shared<FixedCTRNNController<40>>(blockCount, neatNet);
+            case 11: return std::make_shared<FixedCTRNNController<44>>(blockCount, neatNet);
+            case 12: return std::make_shared<FixedCTRNNController<48>>(blockCount, neatNet);
+            default: return std::make_shared<CTRNNController>(blockCount, neatNet);
+        }
+    }
 }
\ No newline at end of file
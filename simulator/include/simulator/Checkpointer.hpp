@@ -0,0 +1,81 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace serial {
+    class BinaryWriter;
+    class BinaryReader;
+}
+
+namespace simulator {
+
+    /// Stream checkpoints are compact and portable across layout
+    /// changes; flat checkpoints are larger but are restored by
+    /// memory-mapping the file and reading records in place.
+    enum class CheckpointFormat
+    {
+        Stream,
+        Flat
+    };
+
+    /// Writes serialized simulation checkpoints to disk on a
+    /// background thread. The simulation thread only pays for
+    /// serializing into memory; file I/O never blocks it.
+    class Checkpointer
+    {
+      public:
+        explicit Checkpointer(std::string path);
+        Checkpointer() = delete;
+        ~Checkpointer();
+
+        /// Hands a serialized checkpoint over to the writer thread.
+        /// The contents of buffer are swapped with a previously
+        /// written buffer so that its capacity can be reused. If the
+        /// writer is still busy, an older pending checkpoint is
+        /// superseded by this one.
+        void submit(std::vector<char> & buffer);
+
+        /// Blocks until everything submitted so far is on disk
+        void flush();
+
+        std::string const & path() const;
+
+        /// Checkpoints begin with a magic number and format version
+        static void writeHeader(serial::BinaryWriter & writer);
+        static void readHeader(serial::BinaryReader & reader);
+
+        /// Reads a whole checkpoint file. Returns an empty
+        /// buffer if the file does not exist.
+        static std::vector<char> readFile(std::string const & path);
+
+      private:
+        std::string m_path;
+
+        /// The most recently submitted, not yet written checkpoint
+        std::vector<char> m_pending;
+
+        /// The checkpoint currently being written
+        std::vector<char> m_writing;
+
+        bool m_hasPending;
+        bool m_busy;
+        bool m_shutdown;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::thread m_writerThread;
+
+        void run();
+
+        /// Writes to a temporary file first and renames so that
+        /// a crash mid-write never corrupts the last good checkpoint
+        void writeFile(std::vector<char> const & data) const;
+    };
+}
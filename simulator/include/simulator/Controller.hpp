@@ -12,5 +12,8 @@ namespace simulator {
         virtual double getRightMotorOutput(int const i) const = 0;
         virtual void update() = 0;
         virtual void set() = 0;
+
+        /// Returns the controller to the state it was constructed in
+        virtual void reset() = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "FlatCheckpointLayout.hpp"
+#include "Population.hpp"
+#include "model/AnimatWorld.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace simulator {
+
+    /// A read-only, memory-mapped view of a flat checkpoint. Records
+    /// are used straight out of the mapping; nothing is copied or
+    /// parsed until restore rebuilds the live objects from them.
+    class FlatCheckpoint
+    {
+      public:
+        /// Maps the file at path. Throws if it can't be mapped
+        /// or isn't a well-formed flat checkpoint.
+        explicit FlatCheckpoint(std::string const & path);
+        FlatCheckpoint() = delete;
+        FlatCheckpoint(FlatCheckpoint const &) = delete;
+        FlatCheckpoint & operator=(FlatCheckpoint const &) = delete;
+        ~FlatCheckpoint();
+
+        FlatHeader const & header() const;
+        FlatAgent const * agents() const;
+        neat::NodeState const * nodes() const;
+        neat::ConnectionState const * connections() const;
+        neat::InnovationInfo const * innovations() const;
+        neat::InnovationInfo const * globalInnovations() const;
+        physics::PointMassState const * pointMasses() const;
+        physics::SpringState const * springs() const;
+
+        /// Rebuilds world and population from the mapped records and
+        /// returns the checkpointed tick. Animats are resized
+        /// serially where needed; agents are then restored in
+        /// parallel across threads.
+        long restore(model::AnimatWorld & animatWorld,
+                     Population & population) const;
+
+        /// Lays out the whole simulation into buffer, which is
+        /// resized but keeps its capacity between calls; records
+        /// is scratch space for the agent records, likewise reused
+        static void write(std::vector<char> & buffer,
+                          std::vector<FlatAgent> & records,
+                          long const tick,
+                          model::AnimatWorld & animatWorld,
+                          Population & population);
+
+        /// Cheap check of a file's magic number
+        static bool isFlatCheckpoint(std::string const & path);
+
+      private:
+        char const * m_data;
+        std::size_t m_size;
+
+        template <typename T>
+        T const * section(FlatSection const & s) const
+        {
+            return reinterpret_cast<T const *>(m_data + s.offset);
+        }
+
+        /// Bounds and alignment checks of every section
+        /// and every agent's slices of them
+        void validate() const;
+    };
+}
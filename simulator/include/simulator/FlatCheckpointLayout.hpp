@@ -0,0 +1,68 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+/**
+ * On-disk layout of a flat checkpoint. The file is a FlatHeader
+ * followed by arrays of plain records, each starting on a cache
+ * line boundary, so that a memory-mapped file can be read in place
+ * without any parsing. Agent records index into the shared arrays.
+ */
+
+#include "neat/GenomeState.hpp"
+#include "physics/PhysicsState.hpp"
+#include <cstdint>
+
+namespace simulator {
+
+    /// A contiguous run of records in the file
+    struct FlatSection
+    {
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    struct FlatAgent
+    {
+        std::int32_t blockCount;
+        std::int32_t bad;
+        std::int32_t handleCollisions;
+        std::int32_t padding;
+        std::int64_t age;
+        double adjustedFitness;
+        double distanceMoved;
+        double startPosition[3];
+        double speciesColour[3];
+        neat::NetworkState genome;
+
+        /// Where this agent's records begin in each shared array
+        std::uint64_t firstNode;
+        std::uint64_t firstConnection;
+        std::uint64_t firstInnovation;
+        std::uint64_t firstPointMass;
+        std::uint64_t firstSpring;
+        std::int32_t pointMassCount;
+        std::int32_t springCount;
+    };
+
+    struct FlatHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::int64_t tick;
+        std::int64_t optimizations;
+        std::int32_t agentCount;
+        std::int32_t globalInnovationNumber;
+        std::int32_t evoOn;
+        std::int32_t eliteIndex;
+        std::int32_t generationTicks;
+        std::int32_t generationAge;
+        FlatSection agents;
+        FlatSection nodes;
+        FlatSection connections;
+        FlatSection innovations;
+        FlatSection globalInnovations;
+        FlatSection pointMasses;
+        FlatSection springs;
+    };
+}
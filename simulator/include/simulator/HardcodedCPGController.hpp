@@ -67,6 +67,18 @@ namespace simulator {
 
         void set() override {}
 
+        void reset() override
+        {
+            for (auto & actuator : m_leftActuators) {
+                actuator.counter = 0;
+                actuator.output = false;
+            }
+            for (auto & actuator : m_rightActuators) {
+                actuator.counter = 0;
+                actuator.output = false;
+            }
+        }
+
       private:
         int m_phaseOffset;
         int m_waveLength;
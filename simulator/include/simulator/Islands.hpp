@@ -0,0 +1,47 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <ostream>
+
+namespace simulator {
+
+    struct IslandOptions
+    {
+        /// One worker process per island
+        int islands = 4;
+        int popSize = 20;
+
+        /// Ticks run by each island
+        long ticks = 20000;
+
+        /// Every so many ticks each island sends copies of its
+        /// fittest genomes on to the next island in the ring
+        long migrateEvery = 500;
+        int migrants = 2;
+
+        /// Updates per generation for generational evolution; 0 for
+        /// steady-state. Either way each island runs on one thread.
+        int generationTicks = 0;
+
+        /// Island i is seeded with seed + i; 0 seeds from the clock
+        unsigned seed = 0;
+
+        /// How often the coordinator reports progress
+        double reportSeconds = 1;
+
+        /// Islands still running after this long without any of them
+        /// completing a tick are killed and counted as failed
+        double stallSeconds = 60;
+    };
+
+    /// Island-model evolution. Forks one headless Simulation per
+    /// island, each evolving its own population on its own core.
+    /// Islands are connected in a ring: island i sends migrants to
+    /// island (i + 1) % islands through a ring of serialized genomes
+    /// in shared memory, and immigrants replace its weakest agents.
+    /// The calling process coordinates, reporting aggregate stats to
+    /// out until every island is done. Call before any threads are
+    /// started. Returns 0 if every island ran to completion.
+    int runIslands(IslandOptions const & options, std::ostream & out);
+}
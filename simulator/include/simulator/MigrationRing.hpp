@@ -0,0 +1,54 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace simulator {
+
+    /// A fixed-size ring of serialized genomes with one producer and
+    /// one consumer, which may be different processes. It holds no
+    /// pointers so can be placed in memory shared between processes
+    /// (e.g. an anonymous shared mapping made before forking).
+    class MigrationRing
+    {
+      public:
+        /// Each genome must fit in one slot
+        static constexpr std::size_t SLOT_BYTES = 32 * 1024;
+        static constexpr std::size_t SLOTS = 16;
+
+        MigrationRing();
+        MigrationRing(MigrationRing const &) = delete;
+        MigrationRing & operator=(MigrationRing const &) = delete;
+
+        /// Copies size bytes into the next free slot. Returns false,
+        /// leaving the ring unchanged, if the ring is full or the data
+        /// doesn't fit in a slot. Producer only.
+        bool push(char const * data, std::size_t const size);
+
+        /// Moves the oldest genome into data, replacing its contents.
+        /// Returns false if the ring is empty. Consumer only.
+        bool pop(std::vector<char> & data);
+
+      private:
+        struct Slot
+        {
+            std::uint32_t size;
+            char data[SLOT_BYTES - sizeof(std::uint32_t)];
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                      "MigrationRing: shared counters must be lock-free");
+
+        /// Count of genomes popped; written by the consumer only
+        std::atomic<std::uint64_t> m_head;
+
+        /// Count of genomes pushed; written by the producer only
+        std::atomic<std::uint64_t> m_tail;
+
+        Slot m_slots[SLOTS];
+    };
+}
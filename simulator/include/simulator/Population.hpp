@@ -3,8 +3,17 @@
 #pragma once
 
 #include "Agent.hpp"
+#include "CompatibilityMatrix.hpp"
+#include "Prescreener.hpp"
+#include "WorkerPool.hpp"
 #include "model/AnimatWorld.hpp"
+#include "model/SpeciesColour.hpp"
+#include "recorder/TrajectoryRecorder.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace simulator {
@@ -21,8 +30,70 @@ namespace simulator {
         void activateEvolution();
         void deactivateEvolution();
 
+        /// Evolution is steady-state rtNEAT by default, one agent being
+        /// judged and replaced at a time as agents come of age. This
+        /// switches to generational evolution instead: every agent is
+        /// stepped for generationTicks updates, concurrently across
+        /// the worker pool and with no evolution in between, after
+        /// which the whole population is speciated and its weaker half
+        /// replaced by offspring of the stronger, bred across the pool
+        /// too. Agents are stepped in isolation, so this throws if any
+        /// has collision handling on. Must be called from the thread
+        /// that calls update.
+        void setGenerational(int const generationTicks);
+        void setSteadyState();
+
+        /// Threads used for speciation and generational stepping; 0
+        /// (the default) for one per core, 1 to keep everything on
+        /// the thread that calls update
+        void setWorkers(int const workers);
+
+        /// Offspring are first swum briefly on their own by a
+        /// Prescreener, and those doing clearly worse than offspring
+        /// so far are bred again from the same parent (up to
+        /// options.attempts times) before they take a population slot.
+        /// Off by default.
+        void setPrescreen(PrescreenOptions const & options);
+        void disablePrescreen();
+
+        /// Call after agents' genomes have been replaced other than by
+        /// the population itself (e.g. restoring a flat checkpoint)
+        void genomesChanged();
+
         std::vector<simulator::Agent> & getAgents();
 
+        /// Writes the indices of the count agents with the highest
+        /// adjusted fitness to indices, fittest first
+        void fittest(int const count, std::vector<int> & indices) const;
+
+        /// Replaces the agent with the lowest adjusted fitness with
+        /// one carrying genome, e.g. a migrant from another population.
+        /// The newcomer is given the mean adjusted fitness so that
+        /// it isn't immediately replaced by the next one.
+        void immigrate(neat::Network const & genome);
+
+        /// Checkpointing. The animat world must have been
+        /// loaded first so that agents rebind to the right animats.
+        void save(serial::BinaryWriter & writer) const;
+        void load(serial::BinaryReader & reader);
+
+        /// Used by flat checkpointing, which restores agents directly
+        bool evolutionActive() const;
+        int getEliteIndex() const;
+        void setEliteIndex(int const eliteIndex);
+
+        /// Generation length (0 when steady-state) and updates so far
+        /// in the current generation. Setting them carries on a
+        /// restored run mid-generation, leaving agents as they are.
+        int getGenerationTicks() const;
+        int getGenerationAge() const;
+        void setGenerationState(int const generationTicks, int const generationAge);
+
+        /// Records agent state at the end of every update; pass
+        /// nullptr to stop. Must be called from the thread that
+        /// calls update.
+        void setRecorder(std::shared_ptr<recorder::TrajectoryRecorder> trajectoryRecorder);
+
       private:
 
         /// The size of the population
@@ -40,6 +111,112 @@ namespace simulator {
         /// For controlling if evolution is activated or not
         bool m_evoOn;
 
+        /// (agent index, adjusted fitness), kept between updates so
+        /// that ranking the population doesn't allocate each tick
+        std::vector<std::pair<int, double>> m_fitnesses;
+
+        /// Optional trajectory recording
+        std::shared_ptr<recorder::TrajectoryRecorder> m_recorder;
+
+        /// Updates per generation in generational mode; 0 when steady-state
+        int m_generationTicks;
+
+        /// Updates so far in the current generation
+        int m_generationAge;
+
+        /// Shared by speciation and generational mode
+        std::unique_ptr<WorkerPool> m_pool;
+
+        /// Which agents are of the same species; brought up to date
+        /// at the start of every update
+        CompatibilityMatrix m_species;
+
+        /// Per-agent scratch for generational mode, sized once so that
+        /// a generation doesn't allocate. Each entry is only written
+        /// by the worker handling that agent.
+        std::vector<char> m_broken;
+        std::vector<model::SpeciesColour> m_speciesColours;
+
+        /// An agent to be replaced in the reproduce phase, the
+        /// survivors its genome comes from (parent the fitter, and the
+        /// same as mate when there is no cross-over) and whether its
+        /// body changed size
+        struct Offspring
+        {
+            int index;
+            int parent;
+            int mate;
+            bool resized;
+        };
+        std::vector<Offspring> m_offspring;
+
+        /// One per worker, reseeded for each offspring bred
+        std::vector<std::mt19937> m_engines;
+
+        /// Drawn from rand() once per reproduce phase; offspring
+        /// engines are seeded from it
+        std::uint32_t m_breedSeed;
+
+        /// Null unless prescreening; has a scratch body per worker
+        std::unique_ptr<Prescreener> m_prescreener;
+
+        /// Offspring (indices into m_offspring) still to pass the
+        /// prescreen in generational mode, and their scores
+        std::vector<int> m_pending;
+        std::vector<double> m_scores;
+
+        void recordTrajectories(long const tick);
+
+        /// Sizes the generational scratch below
+        void reserveGenerational();
+
+        /// Distance moved divided by species size; also gives the
+        /// agent's species its colour
+        double sharedFitness(int const index);
+
+        /// Rebuilds the animat and controller of the agent at index
+        /// from its genome, after the genome has changed
+        void rebuildAgent(int const index);
+
+        /// Resizes the body of the agent at index to suit its genome
+        /// if need be, returning whether it did. Touches that body
+        /// alone so can run concurrently with other agents.
+        bool resizeAgent(int const index);
+
+        /// Puts the agent at index somewhere clear of the others, as
+        /// after its body has been resized. Looks at every other body
+        /// and draws from rand(), so can't run concurrently.
+        void placeAgent(int const index);
+
+        /// Whether the genome at index gets past the prescreen
+        bool prescreen(int const index);
+
+        /// Prescreens every entry of m_offspring, breeding failures
+        /// again from their parents
+        void prescreenOffspring();
+
+        /// The engine of worker, seeded for attempt at breeding
+        /// offspring o of the current reproduce phase
+        std::mt19937 & seedEngine(int const worker, int const o, int const attempt);
+
+        /// Chooses offspring's parent and, some of the time, a mate
+        void chooseParents(Offspring & offspring,
+                           int const survivors,
+                           double const totalFitness) const;
+
+        /// Replaces offspring's genome with a mutated cross of its
+        /// parents'. Draws from the thread's neat::RandomScope.
+        void breed(Offspring const & offspring);
+
+        /// The generational evaluate phase: one update of every agent,
+        /// followed by the reproduce phase at the end of a generation
+        void updateGenerational();
+        void reproduce();
+
+        /// Roulette-wheel choice among the first survivors entries of
+        /// m_fitnesses, weighted by adjusted fitness
+        int chooseSurvivor(int const survivors, double const totalFitness) const;
+
         /// Regenerate the population based on distances travelled
         /// with some offspring updated if withMutations is true
         void regenerate(bool const withMutations = true);
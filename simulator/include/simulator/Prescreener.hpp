@@ -0,0 +1,75 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "Controller.hpp"
+#include "model/Animat.hpp"
+#include "neat/Network.hpp"
+#include <memory>
+#include <vector>
+
+namespace simulator {
+
+    struct PrescreenOptions
+    {
+        /// Ticks a candidate swims for; a full evaluation is 20
+        int ticks = 10;
+
+        /// Physics steps per tick, each correspondingly longer; a
+        /// full evaluation takes 10. Much below 6 the body's springs
+        /// become unstable.
+        int substeps = 6;
+
+        /// Candidates scoring under this fraction of the running
+        /// average score are rejected
+        double rejectFraction = 0.25;
+
+        /// Candidates tried per offspring; the last is kept whatever
+        /// its score, so 1 turns prescreening off
+        int attempts = 3;
+    };
+
+    /// A cheap stand-in for evaluating a new genome in the world. The
+    /// genome drives a body of its own, away from the world (so with
+    /// no collisions), at a coarser physics resolution and for a short
+    /// horizon, and is scored on the distance it swims. Used to turn
+    /// away clearly bad offspring before they take a population slot.
+    class Prescreener
+    {
+      public:
+        /// workers is the number of threads that may score at once
+        Prescreener(PrescreenOptions const & options, int const workers);
+
+        PrescreenOptions const & options() const;
+
+        /// Scores genome using worker's scratch body. Different workers
+        /// may score concurrently. 0 if the physics broke. currentBlocks
+        /// is the body the genome will drive if it doesn't give a
+        /// segment count of its own, as Population::resizeAgent does.
+        double score(neat::Network const & genome,
+                     int const currentBlocks,
+                     int const worker);
+
+        /// Whether score is good enough compared to scores so far,
+        /// which it is then added to. Only one thread may call this.
+        bool accept(double const score);
+
+      private:
+        PrescreenOptions const m_options;
+
+        /// Each worker's genome copy, body and controllers (indexed by
+        /// block count, built against the genome copy), made on first use
+        struct Scratch
+        {
+            explicit Scratch(neat::Network const & g);
+            neat::Network genome;
+            model::Animat animat;
+            std::vector<std::shared_ptr<Controller>> controllers;
+        };
+        std::vector<std::unique_ptr<Scratch>> m_scratch;
+
+        /// Exponential moving average of scores
+        double m_average;
+        long m_samples;
+    };
+}
@@ -23,6 +23,10 @@ namespace simulator {
         void set() override
         {
             
+        }
+        void reset() override
+        {
+
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include "model/AnimatWorld.hpp"
+#include "recorder/TickFrame.hpp"
+#include "recorder/TrajectoryReader.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace simulator {
+
+    /// Plays a recorded trajectory file back into an AnimatWorld
+    /// instead of simulating it, so that anything drawing the world
+    /// (e.g. GLEnvironment) works unchanged. Recorded point-mass
+    /// positions are copied straight into each animat's physics
+    /// engine; no physics is integrated. Every chunk of the file is
+    /// a keyframe, so seeking decodes at most one chunk.
+    class Replay
+    {
+      public:
+        /// Throws if path isn't a trajectory file or holds no frames
+        explicit Replay(std::string const & path);
+        Replay() = delete;
+
+        /// Stops the playback thread
+        ~Replay();
+
+        /// The world that frames are played into. Its
+        /// population size is that of the recording.
+        model::AnimatWorld & animatWorld();
+
+        /// Starts the playback thread
+        void start();
+
+        void pause();
+        void resume();
+
+        /// Playback speed in recorded ticks per second
+        void setSpeed(double const ticksPerSecond);
+
+        /// Jumps to the last recorded frame at or before tick
+        void seek(long const tick);
+
+        /// Moves frames recorded frames forwards (or backwards if
+        /// negative) from the current one, e.g. to scrub while paused
+        void step(long const frames);
+
+        long currentTick() const;
+        long firstTick() const;
+        long lastTick() const;
+
+      private:
+        recorder::TrajectoryReader m_reader;
+        model::AnimatWorld m_animatWorld;
+
+        /// The decoded chunk currently being played
+        std::vector<recorder::TickFrame> m_frames;
+        int m_chunk;
+        int m_frame;
+
+        /// Playback clock, in recorded ticks
+        double m_position;
+        std::atomic<long> m_currentTick;
+
+        bool m_paused;
+        double m_speed;
+        bool m_seekPending;
+        long m_seekTarget;
+        long m_stepPending;
+        bool m_shutdown;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::thread m_playbackThread;
+
+        void run();
+
+        /// Shows the last frame at or before tick, decoding
+        /// another chunk only if tick lies outside the current one
+        void showTick(long const tick);
+
+        /// Shows the frame frames away from the current one
+        void showRelative(long frames);
+
+        void loadChunk(int const chunk);
+        void applyFrame(recorder::TickFrame const & frame);
+    };
+}
@@ -3,35 +3,91 @@
 #pragma once
 
 #include "Agent.hpp"
+#include "Checkpointer.hpp"
 #include "Population.hpp"
 #include "model/AnimatWorld.hpp"
+#include "recorder/FrameCapture.hpp"
+#include "recorder/TrajectoryRecorder.hpp"
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace simulator {
     class Simulation
     {
       public:
-        Simulation(int const popSize);
+        /// seed fixes the initial placement and everything else
+        /// drawn from rand(); 0 seeds from the clock
+        Simulation(int const popSize, unsigned const seed = 0);
 
         /// Initializes and starts the main simulation thread
         void start();
 
+        /// Runs count ticks on the calling thread instead, for headless
+        /// benchmarking. Not to be mixed with start().
+        void runTicks(long const count);
+
         void pause();
         void resume();
 
         void activateEvolution();
         void deactivateEvolution();
 
+        /// See Population::setGenerational, setWorkers and
+        /// setPrescreen. Call before start().
+        void setGenerational(int const generationTicks);
+        void setSteadyState();
+        void setWorkers(int const workers);
+        void setPrescreen(PrescreenOptions const & options);
+        void disablePrescreen();
+
         void setSleepDuration(int const duration);
 
         /// Returns a reference to the simulated world
         model::AnimatWorld & animatWorld();
 
+        /// Returns a reference to the evolving population. Only to be
+        /// used from the thread that runs the ticks.
+        Population & population();
+
+        /// Throws in generational mode, which steps agents in isolation
         void enableCollisionHandling();
         void disableCollisionHandling();
 
+        /// Periodically checkpoint to path every everyN ticks
+        /// (0 means only on request). Call before start().
+        void enableCheckpointing(std::string const & path,
+                                 long const everyN,
+                                 CheckpointFormat const format = CheckpointFormat::Stream);
+
+        /// Checkpoint at the end of the current tick
+        void requestCheckpoint();
+
+        /// Restores from a checkpoint file written by a simulation
+        /// of the same population size. Either format is accepted.
+        /// Call before start(). Returns false if the file does not exist.
+        bool restore(std::string const & path);
+
+        /// Records agent trajectories to path every everyN ticks,
+        /// replacing any recording in progress. Safe to call from any
+        /// thread; takes effect between ticks. Throws if path can't
+        /// be opened.
+        void startRecording(std::string const & path, long const everyN = 1);
+        void stopRecording();
+
+        /// Renders the world to numbered images in directory every
+        /// everyN ticks, without needing a window, replacing any
+        /// capture in progress. Rendering and file I/O happen off the
+        /// simulation thread. Safe to call from any thread; takes
+        /// effect between ticks. Throws if directory doesn't exist.
+        void startFrameCapture(std::string const & directory,
+                               long const everyN = 100,
+                               recorder::ImageFormat const format = recorder::ImageFormat::PNG);
+        void stopFrameCapture();
+
       private:
         /// The main simulation loop runs on this thread
         std::thread m_simThread;
@@ -48,12 +104,66 @@ namespace simulator {
         /// For controlling the speed of the simulation in us
         std::atomic<int> m_sleepDuration;
 
+        /// Simulation ticks so far (checkpointed)
+        long m_tick;
+
+        /// Writes checkpoints to disk off the simulation thread
+        std::unique_ptr<Checkpointer> m_checkpointer;
+
+        /// Checkpoint interval in ticks; 0 to disable
+        long m_checkpointEvery;
+
+        CheckpointFormat m_checkpointFormat;
+
+        /// Set from other threads to trigger a checkpoint
+        std::atomic<bool> m_checkpointRequested;
+
+        /// Reused between checkpoints to avoid reallocating
+        std::vector<char> m_checkpointBuffer;
+        std::vector<FlatAgent> m_checkpointRecords;
+
+        /// The recorder the population should be using, handed
+        /// over to the simulation thread between ticks
+        std::shared_ptr<recorder::TrajectoryRecorder> m_recorder;
+
+        /// Keeps a stopped recorder alive so that its writer thread
+        /// is joined here rather than on the simulation thread
+        std::shared_ptr<recorder::TrajectoryRecorder> m_retiredRecorder;
+
+        std::mutex m_recorderMutex;
+        std::atomic<bool> m_recorderChanged;
+
+        /// Frame capture as requested, and as used by the
+        /// simulation thread, which picks up changes between ticks
+        std::shared_ptr<recorder::FrameCapture> m_frameCapture;
+        std::shared_ptr<recorder::FrameCapture> m_activeFrameCapture;
+
+        /// As for m_retiredRecorder
+        std::shared_ptr<recorder::FrameCapture> m_retiredFrameCapture;
+
+        std::mutex m_frameCaptureMutex;
+        std::atomic<bool> m_frameCaptureChanged;
+
         /// The simulation loop that runs in thread
         void loop();
 
+        /// A single tick of the world
+        void tick();
+
+        /// Checkpoints, and picks up recorder and frame capture
+        /// changes; runs between ticks
+        void betweenTicks();
+
         /// Called by doLoop and when stabilizing the physics model
         void doLoop(long const tick, 
                     int const everyN = 100, 
                     bool const withMutations = true);
+
+        /// Serializes the whole simulation state and hands
+        /// it to the checkpointer. Runs on the simulation thread.
+        void checkpoint();
+
+        /// Hands this tick's world to the frame capture, if sampled
+        void captureFrame();
     };
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace simulator {
+
+    /// A fixed set of threads for splitting a job across cores, kept
+    /// alive between jobs so that running one doesn't start threads
+    /// or allocate. The calling thread takes part as worker 0.
+    class WorkerPool
+    {
+      public:
+        /// 0 uses one worker per core
+        explicit WorkerPool(int const workers = 0);
+        WorkerPool(WorkerPool const &) = delete;
+        WorkerPool & operator=(WorkerPool const &) = delete;
+        ~WorkerPool();
+
+        int size() const;
+
+        /// Calls job(worker) once on each worker, 0 <= worker < size(),
+        /// and returns when every call has. If any throws, the first
+        /// exception (by worker) is rethrown once all are done.
+        template <typename Job>
+        void run(Job && job)
+        {
+            using JobType = std::remove_reference_t<Job>;
+            dispatch([](void * context, int const worker) {
+                         (*static_cast<JobType *>(context))(worker);
+                     },
+                     &job);
+        }
+
+        /// Calls job(i) for every 0 <= i < count, split into interleaved
+        /// stripes, one per worker
+        template <typename Job>
+        void forEach(int const count, Job && job)
+        {
+            auto const workers = size();
+            run([count, workers, &job](int const worker) {
+                for (int i = worker; i < count; i += workers) {
+                    job(i);
+                }
+            });
+        }
+
+      private:
+        using Function = void (*)(void *, int);
+
+        std::vector<std::thread> m_threads;
+        std::vector<std::exception_ptr> m_errors;
+
+        std::mutex m_mutex;
+        std::condition_variable m_start;
+        std::condition_variable m_done;
+
+        /// The job in progress
+        Function m_function;
+        void * m_context;
+
+        /// Incremented for each job; workers wait for it to change
+        std::uint64_t m_generation;
+
+        /// Workers yet to finish the current job
+        int m_remaining;
+
+        bool m_shutdown;
+
+        void dispatch(Function const function, void * const context);
+        void work(int const worker);
+        void call(int const worker);
+    };
+}
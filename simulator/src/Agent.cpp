@@ -2,12 +2,21 @@
 
 #include "simulator/Agent.hpp"
 #include "simulator/CTRNNController.hpp"
+#include "instrument/Instrument.hpp"
 #include "neat/MutationParameters.hpp"
+#include "neat/Random.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
 
 namespace {
     int const NEAT_INPUTS = 7;
-    int const NEAT_OUTPUTS = 2;
-    int const MAX_NEAT_NODES = 12;
+
+    // Weight, time constant and body segment count
+    int const NEAT_OUTPUTS = 3;
+    int const MAX_NEAT_NODES = 13;
     double const NEAT_WEIGHT_BOUND = 30.0;
     neat::MutationParameters NEAT_MUTS{0.2,  // node addition
                                        0.2,  // node function change
@@ -23,7 +32,8 @@ namespace simulator {
                MAX_NEAT_NODES, 
                NEAT_MUTS,
                NEAT_WEIGHT_BOUND)
-      , m_controller(std::make_shared<CTRNNController>(m_animat->getBlockCount(), m_neat))
+      , m_controller(makeCTRNNController(m_animat->getBlockCount(), m_neat))
+      , m_controllers()
       , m_startPosition{0,0,0}
       , m_distanceMoved(0)
       , m_bad(false)
@@ -31,6 +41,10 @@ namespace simulator {
       , m_adjustedFitness(0)
       , m_handleCollisions(false)
     {
+        auto const blockCount = m_animat->getBlockCount();
+        m_controllers.resize(std::max(blockCount, model::Animat::RESERVED_BLOCKS) + 1);
+        m_controllers[blockCount] = m_controller;
+
         // set where the animat currently is in the world
         // will be used as a basis for computing distance moved
         // recordStartPosition();
@@ -72,6 +86,18 @@ namespace simulator {
 
     int Agent::update(std::vector<Agent> & otherAgents)
     {
+        return step(&otherAgents);
+    }
+
+    int Agent::update()
+    {
+        return step(nullptr);
+    }
+
+    int Agent::step(std::vector<Agent> * otherAgents)
+    {
+        INSTRUMENT_TRACED_SCOPE("agent.update");
+        INSTRUMENT_COUNT("agent.steps", 1);
         auto blockCount = m_animat->getBlockCount();
         for(int integ = 0; integ < 10; ++integ) {
             for (auto i = 0 ; i < blockCount; ++i) {
@@ -83,8 +109,10 @@ namespace simulator {
             m_animat->applyWaterForces();
 
             // Collision check
-            if(m_handleCollisions) {
-                for(auto & other : otherAgents) {
+            if(m_handleCollisions && otherAgents) {
+                INSTRUMENT_SCOPE("agent.collisions");
+                INSTRUMENT_COUNT("agent.collision_checks", otherAgents->size() - 1);
+                for(auto & other : *otherAgents) {
                     if(this != &other) {
                         checkForCollisionWithOther(other);
                     }
@@ -111,26 +139,40 @@ namespace simulator {
 
     void Agent::inheritNeat(Agent const & other)
     {
+        TRACE_INSTANT("evolution.inherit");
         m_neat = other.m_neat;
         m_controller->set();
     }
 
     void Agent::inheritNeat(neat::Network const & net)
     {
+        TRACE_INSTANT("evolution.inherit");
         m_neat = net;
         m_controller->set();
     }
 
+    void Agent::inheritNeat(Agent const & fitter, Agent const & mate)
+    {
+        TRACE_INSTANT("evolution.inherit");
+        m_neat = fitter.m_neat;
+        if(&mate != &fitter) {
+            m_neat.crossWeightsFrom(mate.m_neat);
+        }
+        m_controller->set();
+    }
+
     void Agent::mutateNeat()
     {
         // During mutation, it is possible for new
         // innovations to appear. Whenever this happens
         // the agent becomes a new species which is
         // visualized using colour.
+        TRACE_INSTANT("evolution.mutate");
         if(m_neat.mutate()) {
-            auto r = ::rand() / double(RAND_MAX);
-            auto g = ::rand() / double(RAND_MAX);
-            auto b = ::rand() / double(RAND_MAX);
+            TRACE_INSTANT("evolution.species");
+            auto r = neat::random() / double(RAND_MAX);
+            auto g = neat::random() / double(RAND_MAX);
+            auto b = neat::random() / double(RAND_MAX);
             r *= 100;
             g *= 100;
             b *= 100;
@@ -141,10 +183,53 @@ namespace simulator {
         }
     }
 
+    int Agent::segmentCount(neat::Network const & genome)
+    {
+        // Genomes from before the segment output existed keep
+        // whatever body they have
+        if(genome.getOutputCount() < 3) {
+            return -1;
+        }
+
+        // Fixed inputs rather than the genome's own, which hold
+        // whichever substrate neuron the controller last set up
+        double inputs[NEAT_INPUTS] = {};
+        inputs[NEAT_INPUTS - 1] = 10;
+        auto output = genome.getOutput(2, inputs);
+        output += 1;
+        auto segments = output * 5.0;
+        if(segments < 5) {
+            segments = 5;
+        }
+        if(segments > 12) {
+            segments = 12;
+        }
+        return (int)(segments);
+    }
+
+    int Agent::segmentCount() const
+    {
+        return segmentCount(m_neat);
+    }
+
     void Agent::resetController()
     {
-        m_controller.reset();
-        m_controller = std::make_shared<CTRNNController>(m_animat->getBlockCount(), m_neat);
+        // A new controller is only needed the first time the body
+        // takes on a given size; otherwise reset the one built for
+        // that size in place rather than allocating on the
+        // simulation thread
+        auto const blockCount = m_animat->getBlockCount();
+        auto const slot = static_cast<std::size_t>(blockCount);
+        if(slot >= m_controllers.size()) {
+            m_controllers.resize(slot + 1);
+        }
+        auto & controller = m_controllers[slot];
+        if(controller) {
+            controller->reset();
+        } else {
+            controller = makeCTRNNController(blockCount, m_neat);
+        }
+        m_controller = controller;
     }
 
     void Agent::recordStartPosition()
@@ -166,7 +251,7 @@ namespace simulator {
         return m_distanceMoved;
     }
 
-    neat::Network Agent::getNeatNet() const
+    neat::Network const & Agent::getNeatNet() const
     {
         return m_neat;
     }
@@ -189,4 +274,116 @@ namespace simulator {
     {
         m_handleCollisions = false;
     }
+    bool Agent::handlesCollisions() const
+    {
+        return m_handleCollisions;
+    }
+
+    void Agent::updateAnimat(std::shared_ptr<model::Animat> animat)
+    {
+        m_animat = std::move(animat);
+    }
+
+    void Agent::save(serial::BinaryWriter & writer) const
+    {
+        m_neat.save(writer);
+        writer.write(m_startPosition.m_vec);
+        writer.write(m_distanceMoved);
+        writer.write(m_bad);
+        writer.write(static_cast<std::int64_t>(m_age));
+        writer.write(m_adjustedFitness);
+        writer.write(m_handleCollisions);
+    }
+
+    void Agent::load(serial::BinaryReader & reader)
+    {
+        m_neat.load(reader);
+        reader.read(m_startPosition.m_vec);
+        reader.read(m_distanceMoved);
+        reader.read(m_bad);
+        m_age = reader.read<std::int64_t>();
+        reader.read(m_adjustedFitness);
+        reader.read(m_handleCollisions);
+        resetController();
+    }
+
+    FlatAgent Agent::exportRecord() const
+    {
+        FlatAgent record{};
+        auto const colour = m_animat->getSpeciesColour();
+        record.blockCount = m_animat->getBlockCount();
+        record.bad = m_bad;
+        record.handleCollisions = m_handleCollisions;
+        record.age = m_age;
+        record.adjustedFitness = m_adjustedFitness;
+        record.distanceMoved = m_distanceMoved;
+        std::copy(std::begin(m_startPosition.m_vec),
+                  std::end(m_startPosition.m_vec),
+                  record.startPosition);
+        record.speciesColour[0] = colour.R;
+        record.speciesColour[1] = colour.G;
+        record.speciesColour[2] = colour.B;
+        record.genome = m_neat.getState();
+        return record;
+    }
+
+    void Agent::exportGenome(neat::NodeState * nodes,
+                             neat::ConnectionState * connections,
+                             neat::InnovationInfo * innovations) const
+    {
+        m_neat.exportState(nodes, connections, innovations);
+    }
+
+    void Agent::importState(FlatAgent const & record,
+                            neat::NodeState const * nodes,
+                            neat::ConnectionState const * connections,
+                            neat::InnovationInfo const * innovations)
+    {
+        m_neat.importState(record.genome, nodes, connections, innovations);
+        std::copy(std::begin(record.startPosition),
+                  std::end(record.startPosition),
+                  m_startPosition.m_vec);
+        m_distanceMoved = record.distanceMoved;
+        m_bad = record.bad != 0;
+        m_age = record.age;
+        m_adjustedFitness = record.adjustedFitness;
+        m_handleCollisions = record.handleCollisions != 0;
+        updateSpeciesColour(record.speciesColour[0],
+                            record.speciesColour[1],
+                            record.speciesColour[2]);
+        resetController();
+    }
+
+    void Agent::recordFrame(recorder::TickFrame & frame) const
+    {
+        auto const blockCount = m_animat->getBlockCount();
+        auto const central = m_animat->getCentralPoint().first;
+
+        // Heading is the direction from the body centre
+        // to the midpoint between the antennae
+        auto const front = (m_animat->getLeftAntennaePoint() +
+                            m_animat->getRightAntennaePoint()) / 2.0;
+        frame.blockCounts.push_back(blockCount);
+        frame.centralX.push_back(central.m_vec[0]);
+        frame.centralY.push_back(central.m_vec[1]);
+        frame.heading.push_back(std::atan2(front.m_vec[1] - central.m_vec[1],
+                                           front.m_vec[0] - central.m_vec[0]));
+        frame.fitness.push_back(m_adjustedFitness);
+        frame.distance.push_back(m_distanceMoved);
+        auto const colour = m_animat->getSpeciesColour();
+        frame.speciesR.push_back(colour.R);
+        frame.speciesG.push_back(colour.G);
+        frame.speciesB.push_back(colour.B);
+        for (auto i = 0; i < blockCount; ++i) {
+            frame.motors.push_back(m_controller->getLeftMotorOutput(i));
+            frame.motors.push_back(m_controller->getRightMotorOutput(i));
+        }
+        auto & engine = m_animat->getPhysicsEngine();
+        auto const pointCount = (blockCount + 1) * 2;
+        for (auto i = 0; i < pointCount; ++i) {
+            auto const position = engine.getPointMassPosition(i);
+            frame.pointX.push_back(position.m_vec[0]);
+            frame.pointY.push_back(position.m_vec[1]);
+        }
+    }
 }
@@ -0,0 +1,134 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/Checkpointer.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    std::uint32_t const CHECKPOINT_MAGIC = 0x4b435053; // "SPCK"
+    std::uint32_t const CHECKPOINT_VERSION = 2;
+}
+
+namespace simulator {
+
+    Checkpointer::Checkpointer(std::string path)
+      : m_path(std::move(path))
+      , m_pending()
+      , m_writing()
+      , m_hasPending(false)
+      , m_busy(false)
+      , m_shutdown(false)
+    {
+        m_writerThread = std::thread(&Checkpointer::run, this);
+    }
+
+    Checkpointer::~Checkpointer()
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_shutdown = true;
+        }
+        m_cond.notify_all();
+        m_writerThread.join();
+    }
+
+    std::string const & Checkpointer::path() const
+    {
+        return m_path;
+    }
+
+    void Checkpointer::submit(std::vector<char> & buffer)
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_pending.swap(buffer);
+            m_hasPending = true;
+        }
+        m_cond.notify_all();
+    }
+
+    void Checkpointer::flush()
+    {
+        std::unique_lock<std::mutex> ul(m_mutex);
+        m_cond.wait(ul, [this]{ return !m_hasPending && !m_busy; });
+    }
+
+    void Checkpointer::run()
+    {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> ul(m_mutex);
+                m_cond.wait(ul, [this]{ return m_hasPending || m_shutdown; });
+                if (!m_hasPending) {
+                    return;
+                }
+                m_writing.swap(m_pending);
+                m_hasPending = false;
+                m_busy = true;
+            }
+
+            // Outside of the lock so that submit never waits on disk
+            try {
+                writeFile(m_writing);
+            } catch (std::exception const & e) {
+                std::cerr << "Checkpointer: " << e.what() << std::endl;
+            }
+
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                m_busy = false;
+            }
+            m_cond.notify_all();
+        }
+    }
+
+    void Checkpointer::writeFile(std::vector<char> const & data) const
+    {
+        auto const tmpPath = m_path + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), data.size());
+            if (!out) {
+                throw std::runtime_error("failed to write " + tmpPath);
+            }
+        }
+        if (std::rename(tmpPath.c_str(), m_path.c_str()) != 0) {
+            throw std::runtime_error("failed to rename " + tmpPath);
+        }
+    }
+
+    void Checkpointer::writeHeader(serial::BinaryWriter & writer)
+    {
+        writer.write(CHECKPOINT_MAGIC);
+        writer.write(CHECKPOINT_VERSION);
+    }
+
+    void Checkpointer::readHeader(serial::BinaryReader & reader)
+    {
+        if (reader.read<std::uint32_t>() != CHECKPOINT_MAGIC) {
+            throw std::runtime_error("Checkpointer: not a checkpoint file");
+        }
+        if (reader.read<std::uint32_t>() != CHECKPOINT_VERSION) {
+            throw std::runtime_error("Checkpointer: unsupported checkpoint version");
+        }
+    }
+
+    std::vector<char> Checkpointer::readFile(std::string const & path)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return {};
+        }
+        std::vector<char> data(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(data.data(), data.size());
+        if (!in) {
+            throw std::runtime_error("Checkpointer: failed to read " + path);
+        }
+        return data;
+    }
+}
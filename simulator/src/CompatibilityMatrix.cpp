@@ -0,0 +1,207 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/CompatibilityMatrix.hpp"
+#include "instrument/Instrument.hpp"
+#include <algorithm>
+
+namespace {
+
+    // Agents per tile side; one 64-bit word of a row
+    int const BLOCK = 64;
+
+    // Below this many genome comparisons an update runs on the calling
+    // thread, as waking the pool would cost more than it saves
+    long const PARALLEL_COMPARISONS = 4096;
+
+    template <typename Job>
+    void forEach(simulator::WorkerPool & pool, bool const parallel, int const count, Job && job)
+    {
+        if (parallel) {
+            pool.forEach(count, job);
+        } else {
+            for (int i = 0; i < count; ++i) {
+                job(i);
+            }
+        }
+    }
+}
+
+namespace simulator {
+
+    CompatibilityMatrix::CompatibilityMatrix(int const size, double const threshold)
+      : m_size(size)
+      , m_words((size + BLOCK - 1) / BLOCK)
+      , m_threshold(threshold)
+      , m_bits(static_cast<std::size_t>(size) * m_words, 0)
+      , m_counts(size, 0)
+      , m_changed(size, 0)
+      , m_changedList()
+      , m_stale(true)
+      , m_tiles()
+    {
+        m_changedList.reserve(size);
+        for (int rowBlock = 0; rowBlock < m_words; ++rowBlock) {
+            for (int columnBlock = rowBlock; columnBlock < m_words; ++columnBlock) {
+                m_tiles.emplace_back(rowBlock, columnBlock);
+            }
+        }
+    }
+
+    void CompatibilityMatrix::invalidate(int const i)
+    {
+        if (!m_changed[i]) {
+            m_changed[i] = 1;
+            m_changedList.push_back(i);
+        }
+    }
+
+    void CompatibilityMatrix::invalidateAll()
+    {
+        m_stale = true;
+    }
+
+    int CompatibilityMatrix::speciesSize(int const i) const
+    {
+        return m_counts[i];
+    }
+
+    int CompatibilityMatrix::representative(int const i) const
+    {
+        auto const * row = m_bits.data() + static_cast<std::size_t>(i) * m_words;
+        for (int w = 0; w < m_words; ++w) {
+            if (row[w] != 0) {
+                return w * BLOCK + __builtin_ctzll(row[w]);
+            }
+        }
+        return i;
+    }
+
+    bool CompatibilityMatrix::same(std::vector<Agent> const & agents, int const i, int const j) const
+    {
+        return agents[i].getNeatNet().measureDifference(agents[j].getNeatNet()) < m_threshold;
+    }
+
+    bool CompatibilityMatrix::test(int const i, int const j) const
+    {
+        return (m_bits[static_cast<std::size_t>(i) * m_words + j / BLOCK] >> (j % BLOCK)) & 1;
+    }
+
+    int CompatibilityMatrix::countRow(int const i) const
+    {
+        auto const * row = m_bits.data() + static_cast<std::size_t>(i) * m_words;
+        auto count = 0;
+        for (int w = 0; w < m_words; ++w) {
+            count += __builtin_popcountll(row[w]);
+        }
+        return count;
+    }
+
+    void CompatibilityMatrix::update(std::vector<Agent> const & agents, WorkerPool & pool)
+    {
+        // Past half the population changed, a full recompute, which
+        // compares each pair once rather than twice, is cheaper
+        if (m_stale || static_cast<int>(m_changedList.size()) * 2 > m_size) {
+            rebuild(agents, pool);
+        } else if (!m_changedList.empty()) {
+            updateRows(agents, pool);
+        }
+        for (auto const i : m_changedList) {
+            m_changed[i] = 0;
+        }
+        m_changedList.clear();
+        m_stale = false;
+    }
+
+    void CompatibilityMatrix::rebuild(std::vector<Agent> const & agents, WorkerPool & pool)
+    {
+        INSTRUMENT_TRACED_SCOPE("species.rebuild");
+        auto const parallel = long(m_size) * m_size / 2 >= PARALLEL_COMPARISONS;
+
+        // Each word of the matrix is written by exactly one tile, so
+        // tiles can be computed in any order on any thread
+        forEach(pool, parallel, static_cast<int>(m_tiles.size()), [this, &agents](int const t) {
+            computeTile(agents, m_tiles[t].first, m_tiles[t].second);
+        });
+        forEach(pool, parallel, m_size, [this](int const i) {
+            m_counts[i] = countRow(i);
+        });
+    }
+
+    void CompatibilityMatrix::computeTile(std::vector<Agent> const & agents,
+                                          int const rowBlock,
+                                          int const columnBlock)
+    {
+        auto const rowStart = rowBlock * BLOCK;
+        auto const rowEnd = std::min(m_size, rowStart + BLOCK);
+        auto const columnStart = columnBlock * BLOCK;
+        auto const columnEnd = std::min(m_size, columnStart + BLOCK);
+
+        // The tile's words for rows in rowBlock, and its transpose's
+        // for rows in columnBlock
+        std::uint64_t rows[BLOCK] = {};
+        std::uint64_t columns[BLOCK] = {};
+        for (int i = rowStart; i < rowEnd; ++i) {
+            auto const j0 = rowBlock == columnBlock ? i : columnStart;
+            for (int j = j0; j < columnEnd; ++j) {
+                if (same(agents, i, j)) {
+                    rows[i - rowStart] |= std::uint64_t(1) << (j - columnStart);
+                    columns[j - columnStart] |= std::uint64_t(1) << (i - rowStart);
+                }
+            }
+        }
+        if (rowBlock == columnBlock) {
+            for (int i = rowStart; i < rowEnd; ++i) {
+                m_bits[static_cast<std::size_t>(i) * m_words + rowBlock] =
+                    rows[i - rowStart] | columns[i - rowStart];
+            }
+            return;
+        }
+        for (int i = rowStart; i < rowEnd; ++i) {
+            m_bits[static_cast<std::size_t>(i) * m_words + columnBlock] = rows[i - rowStart];
+        }
+        for (int j = columnStart; j < columnEnd; ++j) {
+            m_bits[static_cast<std::size_t>(j) * m_words + rowBlock] = columns[j - columnStart];
+        }
+    }
+
+    void CompatibilityMatrix::updateRows(std::vector<Agent> const & agents, WorkerPool & pool)
+    {
+        INSTRUMENT_SCOPE("species.update_rows");
+        auto const changed = static_cast<int>(m_changedList.size());
+        auto const parallel = long(changed) * m_size >= PARALLEL_COMPARISONS;
+
+        // Changed rows are recomputed whole, a word at a time so that
+        // even a single row is split across the pool
+        forEach(pool, parallel, changed * m_words, [this, &agents](int const unit) {
+            auto const i = m_changedList[unit / m_words];
+            auto const w = unit % m_words;
+            auto const end = std::min(m_size, (w + 1) * BLOCK);
+            std::uint64_t word = 0;
+            for (int j = w * BLOCK; j < end; ++j) {
+                if (same(agents, i, j)) {
+                    word |= std::uint64_t(1) << (j - w * BLOCK);
+                }
+            }
+            m_bits[static_cast<std::size_t>(i) * m_words + w] = word;
+        });
+        for (auto const i : m_changedList) {
+            m_counts[i] = countRow(i);
+        }
+
+        // Then every other row takes its changed columns from the
+        // changed rows, which are no longer written to
+        forEach(pool, parallel, m_size, [this](int const j) {
+            if (m_changed[j]) {
+                return;
+            }
+            auto * row = m_bits.data() + static_cast<std::size_t>(j) * m_words;
+            for (auto const i : m_changedList) {
+                auto const now = test(i, j);
+                if (now != test(j, i)) {
+                    row[i / BLOCK] ^= std::uint64_t(1) << (i % BLOCK);
+                    m_counts[j] += now ? 1 : -1;
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,337 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/FlatCheckpoint.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    std::uint32_t const FLAT_MAGIC = 0x544c4653; // "SFLT"
+    std::uint32_t const FLAT_VERSION = 3;
+
+    /// Every section starts on a cache line
+    std::uint64_t const SECTION_ALIGNMENT = 64;
+
+    std::uint64_t alignUp(std::uint64_t const offset)
+    {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    template <typename T>
+    void placeSection(simulator::FlatSection & section,
+                      std::uint64_t const count,
+                      std::uint64_t & end)
+    {
+        section.offset = alignUp(end);
+        section.count = count;
+        end = section.offset + count * sizeof(T);
+    }
+
+    template <typename T>
+    T * sectionAt(std::vector<char> & buffer, simulator::FlatSection const & section)
+    {
+        return reinterpret_cast<T *>(buffer.data() + section.offset);
+    }
+
+    void checkSlice(std::uint64_t const first,
+                    std::uint64_t const count,
+                    simulator::FlatSection const & section)
+    {
+        if (first > section.count || count > section.count - first) {
+            throw std::runtime_error("FlatCheckpoint: agent record out of bounds");
+        }
+    }
+}
+
+namespace simulator {
+
+    FlatCheckpoint::FlatCheckpoint(std::string const & path)
+      : m_data(nullptr)
+      , m_size(0)
+    {
+        auto const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("FlatCheckpoint: failed to open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < sizeof(FlatHeader)) {
+            ::close(fd);
+            throw std::runtime_error("FlatCheckpoint: truncated file " + path);
+        }
+        m_size = st.st_size;
+        auto const mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("FlatCheckpoint: failed to map " + path);
+        }
+        m_data = static_cast<char const *>(mapped);
+        try {
+            validate();
+        } catch (...) {
+            ::munmap(const_cast<char *>(m_data), m_size);
+            throw;
+        }
+    }
+
+    FlatCheckpoint::~FlatCheckpoint()
+    {
+        ::munmap(const_cast<char *>(m_data), m_size);
+    }
+
+    FlatHeader const & FlatCheckpoint::header() const
+    {
+        return *reinterpret_cast<FlatHeader const *>(m_data);
+    }
+
+    FlatAgent const * FlatCheckpoint::agents() const
+    {
+        return section<FlatAgent>(header().agents);
+    }
+
+    neat::NodeState const * FlatCheckpoint::nodes() const
+    {
+        return section<neat::NodeState>(header().nodes);
+    }
+
+    neat::ConnectionState const * FlatCheckpoint::connections() const
+    {
+        return section<neat::ConnectionState>(header().connections);
+    }
+
+    neat::InnovationInfo const * FlatCheckpoint::innovations() const
+    {
+        return section<neat::InnovationInfo>(header().innovations);
+    }
+
+    neat::InnovationInfo const * FlatCheckpoint::globalInnovations() const
+    {
+        return section<neat::InnovationInfo>(header().globalInnovations);
+    }
+
+    physics::PointMassState const * FlatCheckpoint::pointMasses() const
+    {
+        return section<physics::PointMassState>(header().pointMasses);
+    }
+
+    physics::SpringState const * FlatCheckpoint::springs() const
+    {
+        return section<physics::SpringState>(header().springs);
+    }
+
+    void FlatCheckpoint::validate() const
+    {
+        auto const & h = header();
+        if (h.magic != FLAT_MAGIC) {
+            throw std::runtime_error("FlatCheckpoint: not a flat checkpoint");
+        }
+        if (h.version != FLAT_VERSION) {
+            throw std::runtime_error("FlatCheckpoint: unsupported version");
+        }
+        auto checkSection = [this](FlatSection const & s, std::size_t const recordSize) {
+            if (s.offset % SECTION_ALIGNMENT != 0 ||
+                s.offset > m_size ||
+                s.count > (m_size - s.offset) / recordSize) {
+                throw std::runtime_error("FlatCheckpoint: section out of bounds");
+            }
+        };
+        checkSection(h.agents, sizeof(FlatAgent));
+        checkSection(h.nodes, sizeof(neat::NodeState));
+        checkSection(h.connections, sizeof(neat::ConnectionState));
+        checkSection(h.innovations, sizeof(neat::InnovationInfo));
+        checkSection(h.globalInnovations, sizeof(neat::InnovationInfo));
+        checkSection(h.pointMasses, sizeof(physics::PointMassState));
+        checkSection(h.springs, sizeof(physics::SpringState));
+        if (h.agentCount < 0 || h.agents.count != h.agentCount) {
+            throw std::runtime_error("FlatCheckpoint: bad agent count");
+        }
+
+        auto const records = agents();
+        for (int i = 0; i < h.agentCount; ++i) {
+            auto const & r = records[i];
+            if (r.genome.nodeCount < 0 || r.genome.connectionCount < 0 ||
+                r.genome.innovationCount < 0 ||
+                r.pointMassCount < 0 || r.springCount < 0) {
+                throw std::runtime_error("FlatCheckpoint: bad agent record");
+            }
+            checkSlice(r.firstNode, r.genome.nodeCount, h.nodes);
+            checkSlice(r.firstConnection, r.genome.connectionCount, h.connections);
+            checkSlice(r.firstInnovation, r.genome.innovationCount, h.innovations);
+            checkSlice(r.firstPointMass, r.pointMassCount, h.pointMasses);
+            checkSlice(r.firstSpring, r.springCount, h.springs);
+        }
+    }
+
+    long FlatCheckpoint::restore(model::AnimatWorld & animatWorld,
+                                 Population & population) const
+    {
+        auto const & h = header();
+        auto & agentList = population.getAgents();
+        if (h.agentCount != animatWorld.getPopSize() ||
+            h.agentCount != agentList.size()) {
+            throw std::runtime_error("FlatCheckpoint: population size mismatch");
+        }
+
+        neat::Network::setGlobalInnovations(h.globalInnovationNumber,
+                                            globalInnovations(),
+                                            h.globalInnovations.count);
+        animatWorld.setOptimizationCount(h.optimizations);
+
+        // Resizing animats is cheap but rewires each one's physics,
+        // so is done before the parallel part
+        auto const records = agents();
+        for (int i = 0; i < h.agentCount; ++i) {
+            auto const & r = records[i];
+            if (r.blockCount < 2 || r.blockCount > 64) {
+                throw std::runtime_error("FlatCheckpoint: bad block count");
+            }
+            if (r.blockCount != animatWorld.animat(i)->getBlockCount()) {
+                animatWorld.reconstructAnimat(i, r.blockCount);
+            }
+            auto const animat = animatWorld.animat(i);
+            auto & engine = animat->getPhysicsEngine();
+            if (r.pointMassCount != engine.getPointMassCount() ||
+                r.springCount != engine.getSpringCount()) {
+                throw std::runtime_error("FlatCheckpoint: topology mismatch");
+            }
+            agentList[i].updateAnimat(animat);
+        }
+
+        // Every agent owns its genome and animat, so
+        // agents can be restored independently
+        auto const threadCount =
+            std::max(1, std::min<int>(std::thread::hardware_concurrency(), h.agentCount));
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(threadCount);
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                try {
+                    for (int i = t; i < h.agentCount; i += threadCount) {
+                        auto const & r = records[i];
+                        animatWorld.animat(i)->importState(pointMasses() + r.firstPointMass,
+                                                           springs() + r.firstSpring);
+                        agentList[i].importState(r,
+                                                 nodes() + r.firstNode,
+                                                 connections() + r.firstConnection,
+                                                 innovations() + r.firstInnovation);
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        for (auto const & error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        if (h.evoOn) {
+            population.activateEvolution();
+        } else {
+            population.deactivateEvolution();
+        }
+        population.setEliteIndex(h.eliteIndex);
+        population.setGenerationState(h.generationTicks, h.generationAge);
+        population.genomesChanged();
+        return h.tick;
+    }
+
+    void FlatCheckpoint::write(std::vector<char> & buffer,
+                               std::vector<FlatAgent> & records,
+                               long const tick,
+                               model::AnimatWorld & animatWorld,
+                               Population & population)
+    {
+        auto & agentList = population.getAgents();
+        auto const agentCount = static_cast<int>(agentList.size());
+        auto const & globalMap = neat::Network::getGlobalInnovationMap();
+
+        // First pass: size every agent's slices
+        records.clear();
+        records.reserve(agentCount);
+        std::uint64_t nodeCount = 0;
+        std::uint64_t connectionCount = 0;
+        std::uint64_t innovationCount = 0;
+        std::uint64_t pointMassCount = 0;
+        std::uint64_t springCount = 0;
+        for (int i = 0; i < agentCount; ++i) {
+            auto record = agentList[i].exportRecord();
+            auto & engine = animatWorld.animat(i)->getPhysicsEngine();
+            record.pointMassCount = engine.getPointMassCount();
+            record.springCount = engine.getSpringCount();
+            record.firstNode = nodeCount;
+            record.firstConnection = connectionCount;
+            record.firstInnovation = innovationCount;
+            record.firstPointMass = pointMassCount;
+            record.firstSpring = springCount;
+            nodeCount += record.genome.nodeCount;
+            connectionCount += record.genome.connectionCount;
+            innovationCount += record.genome.innovationCount;
+            pointMassCount += record.pointMassCount;
+            springCount += record.springCount;
+            records.push_back(record);
+        }
+
+        FlatHeader h{};
+        h.magic = FLAT_MAGIC;
+        h.version = FLAT_VERSION;
+        h.tick = tick;
+        h.optimizations = animatWorld.getOptimizationCount();
+        h.agentCount = agentCount;
+        h.globalInnovationNumber = neat::Network::getGlobalInnovationNumber();
+        h.evoOn = population.evolutionActive();
+        h.eliteIndex = population.getEliteIndex();
+        h.generationTicks = population.getGenerationTicks();
+        h.generationAge = population.getGenerationAge();
+        std::uint64_t end = sizeof(FlatHeader);
+        placeSection<FlatAgent>(h.agents, agentCount, end);
+        placeSection<neat::NodeState>(h.nodes, nodeCount, end);
+        placeSection<neat::ConnectionState>(h.connections, connectionCount, end);
+        placeSection<neat::InnovationInfo>(h.innovations, innovationCount, end);
+        placeSection<neat::InnovationInfo>(h.globalInnovations, globalMap.size(), end);
+        placeSection<physics::PointMassState>(h.pointMasses, pointMassCount, end);
+        placeSection<physics::SpringState>(h.springs, springCount, end);
+
+        // Second pass: everything is written straight into place
+        buffer.clear();
+        buffer.resize(end);
+        *sectionAt<FlatHeader>(buffer, FlatSection{0, 1}) = h;
+        std::copy(std::begin(records), std::end(records),
+                  sectionAt<FlatAgent>(buffer, h.agents));
+        auto const nodesOut = sectionAt<neat::NodeState>(buffer, h.nodes);
+        auto const connectionsOut = sectionAt<neat::ConnectionState>(buffer, h.connections);
+        auto const innovationsOut = sectionAt<neat::InnovationInfo>(buffer, h.innovations);
+        auto const massesOut = sectionAt<physics::PointMassState>(buffer, h.pointMasses);
+        auto const springsOut = sectionAt<physics::SpringState>(buffer, h.springs);
+        for (int i = 0; i < agentCount; ++i) {
+            auto const & r = records[i];
+            agentList[i].exportGenome(nodesOut + r.firstNode,
+                                      connectionsOut + r.firstConnection,
+                                      innovationsOut + r.firstInnovation);
+            animatWorld.animat(i)->exportState(massesOut + r.firstPointMass,
+                                               springsOut + r.firstSpring);
+        }
+        auto globalOut = sectionAt<neat::InnovationInfo>(buffer, h.globalInnovations);
+        for (auto const & it : globalMap) {
+            *globalOut++ = it.second;
+        }
+    }
+
+    bool FlatCheckpoint::isFlatCheckpoint(std::string const & path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::uint32_t magic = 0;
+        in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+        return in && magic == FLAT_MAGIC;
+    }
+}
@@ -0,0 +1,329 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/Islands.hpp"
+#include "simulator/MigrationRing.hpp"
+#include "simulator/Simulation.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <new>
+#include <signal.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+    using simulator::MigrationRing;
+
+    enum IslandState
+    {
+        Running,
+        Done,
+        Failed
+    };
+
+    /// Written by one island, read by the coordinator
+    struct IslandStats
+    {
+        std::atomic<long> ticks;
+        std::atomic<long> optimizations;
+        std::atomic<long> emigrants;
+        std::atomic<long> immigrants;
+
+        /// Migrants that couldn't be sent (ring full) or adopted
+        std::atomic<long> dropped;
+
+        /// Adjusted fitness over the population
+        std::atomic<double> bestFitness;
+        std::atomic<double> meanFitness;
+
+        std::atomic<int> state;
+    };
+
+    static_assert(std::atomic<long>::is_always_lock_free &&
+                  std::atomic<double>::is_always_lock_free &&
+                  std::atomic<int>::is_always_lock_free,
+                  "IslandStats: shared stats must be lock-free");
+
+    /// Everything shared between the islands and the coordinator
+    struct Shared
+    {
+        Shared(int const islands)
+          : size(sizeof(MigrationRing) * islands + sizeof(IslandStats) * islands)
+          , memory(::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0))
+          , rings()
+          , stats()
+        {
+            if (memory == MAP_FAILED) {
+                throw std::runtime_error("runIslands: couldn't map shared memory");
+            }
+            auto * bytes = static_cast<char *>(memory);
+            for (int i = 0; i < islands; ++i) {
+                rings.push_back(new (bytes) MigrationRing);
+                bytes += sizeof(MigrationRing);
+            }
+            for (int i = 0; i < islands; ++i) {
+                stats.push_back(new (bytes) IslandStats{});
+                bytes += sizeof(IslandStats);
+            }
+        }
+
+        ~Shared()
+        {
+            ::munmap(memory, size);
+        }
+
+        std::size_t const size;
+        void * const memory;
+        std::vector<MigrationRing *> rings;
+        std::vector<IslandStats *> stats;
+    };
+
+    void publishFitness(simulator::Population & population, IslandStats & stats)
+    {
+        auto best = 0.0;
+        auto total = 0.0;
+        auto & agents = population.getAgents();
+        for (auto const & agent : agents) {
+            best = std::max(best, agent.getAdjustedFitness());
+            total += agent.getAdjustedFitness();
+        }
+        stats.bestFitness.store(best, std::memory_order_relaxed);
+        stats.meanFitness.store(total / agents.size(), std::memory_order_relaxed);
+    }
+
+    void emigrate(simulator::Population & population,
+                  int const migrants,
+                  MigrationRing & ring,
+                  IslandStats & stats,
+                  std::vector<int> & indices,
+                  std::vector<char> & buffer)
+    {
+        population.fittest(migrants, indices);
+        for (auto const index : indices) {
+            buffer.clear();
+            serial::BinaryWriter writer(buffer);
+            population.getAgents()[index].getNeatNet().save(writer);
+            if (ring.push(buffer.data(), buffer.size())) {
+                stats.emigrants.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void immigrate(simulator::Population & population,
+                   MigrationRing & ring,
+                   IslandStats & stats,
+                   neat::Network & migrant,
+                   std::vector<char> & buffer)
+    {
+        while (ring.pop(buffer)) {
+            try {
+                serial::BinaryReader reader(buffer.data(), buffer.size());
+                migrant.load(reader);
+
+                // Innovation numbers were handed out by another process
+                migrant.adoptInnovations();
+                population.immigrate(migrant);
+                stats.immigrants.fetch_add(1, std::memory_order_relaxed);
+            } catch (std::exception const &) {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void runIsland(simulator::IslandOptions const & options,
+                   unsigned const seed,
+                   MigrationRing & inbox,
+                   MigrationRing & outbox,
+                   IslandStats & stats)
+    {
+        // Leaked: the island exits without tearing the world down
+        auto * simulation = new simulator::Simulation(options.popSize, seed);
+        simulation->activateEvolution();
+
+        // The islands already have a core each
+        simulation->setWorkers(1);
+        if (options.generationTicks > 0) {
+            simulation->setGenerational(options.generationTicks);
+        }
+        auto & population = simulation->population();
+
+        // Reused between migrations; load replaces everything in the
+        // scratch genome so any agent's will do to start from
+        neat::Network migrant(population.getAgents()[0].getNeatNet());
+        std::vector<int> indices;
+        std::vector<char> buffer;
+
+        for (long tick = 1; tick <= options.ticks; ++tick) {
+            simulation->runTicks(1);
+            immigrate(population, inbox, stats, migrant, buffer);
+            if (&outbox != &inbox && tick % options.migrateEvery == 0) {
+                emigrate(population, options.migrants, outbox, stats, indices, buffer);
+            }
+            if (tick % 100 == 0 || tick == options.ticks) {
+                publishFitness(population, stats);
+                stats.optimizations.store(simulation->animatWorld().getOptimizationCount(),
+                                          std::memory_order_relaxed);
+            }
+            stats.ticks.store(tick, std::memory_order_relaxed);
+        }
+    }
+
+    void report(std::vector<IslandStats *> const & stats,
+                double const ticksPerSecond,
+                std::ostream & out)
+    {
+        long ticks = 0;
+        long migrated = 0;
+        long dropped = 0;
+        auto best = 0.0;
+        for (auto const * island : stats) {
+            ticks += island->ticks.load(std::memory_order_relaxed);
+            migrated += island->immigrants.load(std::memory_order_relaxed);
+            dropped += island->dropped.load(std::memory_order_relaxed);
+            best = std::max(best, island->bestFitness.load(std::memory_order_relaxed));
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line),
+                      "ticks %ld (%.0f/s), best fitness %.3f, migrated %ld, dropped %ld\n",
+                      ticks, ticksPerSecond, best, migrated, dropped);
+        out << line << std::flush;
+    }
+
+    void summarize(std::vector<IslandStats *> const & stats, std::ostream & out)
+    {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%6s %8s %13s %9s %9s %8s %12s %12s\n",
+                      "island", "ticks", "optimizations", "sent", "received",
+                      "dropped", "best", "mean");
+        out << line;
+        for (std::size_t i = 0; i < stats.size(); ++i) {
+            auto const & island = *stats[i];
+            std::snprintf(line, sizeof(line), "%6zu %8ld %13ld %9ld %9ld %8ld %12.3f %12.3f%s\n",
+                          i,
+                          island.ticks.load(),
+                          island.optimizations.load(),
+                          island.emigrants.load(),
+                          island.immigrants.load(),
+                          island.dropped.load(),
+                          island.bestFitness.load(),
+                          island.meanFitness.load(),
+                          island.state.load() == Failed ? "  failed" : "");
+            out << line;
+        }
+    }
+}
+
+namespace simulator {
+
+    int runIslands(IslandOptions const & options, std::ostream & out)
+    {
+        if (options.islands < 1 || options.popSize < 1 ||
+            options.migrateEvery < 1 || options.ticks < 1 ||
+            options.stallSeconds <= 0) {
+            throw std::runtime_error("runIslands: bad options");
+        }
+        Shared shared(options.islands);
+        auto const seed = options.seed ? options.seed
+                                       : static_cast<unsigned>(std::time(nullptr));
+
+        out << std::flush;
+        std::vector<pid_t> workers;
+        for (int i = 0; i < options.islands; ++i) {
+            auto const pid = ::fork();
+            if (pid < 0) {
+                shared.stats[i]->state.store(Failed);
+                continue;
+            }
+            if (pid == 0) {
+                auto & stats = *shared.stats[i];
+                try {
+                    runIsland(options, seed + i,
+                              *shared.rings[i],
+                              *shared.rings[(i + 1) % options.islands],
+                              stats);
+                    stats.state.store(Done);
+                    ::_exit(0);
+                } catch (...) {
+                    stats.state.store(Failed);
+                    ::_exit(1);
+                }
+            }
+            workers.push_back(pid);
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+        auto lastProgress = start;
+        long lastTicks = 0;
+        long progressTicks = 0;
+        auto running = workers.size();
+        while (running > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            for (auto & pid : workers) {
+                int status = 0;
+                if (pid > 0 && ::waitpid(pid, &status, WNOHANG) == pid) {
+                    pid = 0;
+                    --running;
+                }
+            }
+            auto const now = std::chrono::steady_clock::now();
+            long ticks = 0;
+            for (auto const * island : shared.stats) {
+                ticks += island->ticks.load(std::memory_order_relaxed);
+            }
+            if (ticks != progressTicks) {
+                progressTicks = ticks;
+                lastProgress = now;
+            }
+            auto const elapsed = std::chrono::duration<double>(now - lastReport).count();
+            if (elapsed >= options.reportSeconds || running == 0) {
+                report(shared.stats, (ticks - lastTicks) / std::max(elapsed, 1e-6), out);
+                lastReport = now;
+                lastTicks = ticks;
+            }
+
+            // A hung island would otherwise be waited on forever;
+            // those left are reaped below and counted as failed
+            if (running > 0 &&
+                std::chrono::duration<double>(now - lastProgress).count() >= options.stallSeconds) {
+                out << "islands stalled; stopping\n";
+                for (auto & pid : workers) {
+                    if (pid > 0) {
+                        ::kill(pid, SIGKILL);
+                        ::waitpid(pid, nullptr, 0);
+                        pid = 0;
+                    }
+                }
+                running = 0;
+            }
+        }
+
+        // An island that died without saying so crashed
+        auto failed = false;
+        for (auto * island : shared.stats) {
+            if (island->state.load() != Done) {
+                island->state.store(Failed);
+                failed = true;
+            }
+        }
+        auto const seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        char line[80];
+        std::snprintf(line, sizeof(line), "%d islands in %.1fs\n", options.islands, seconds);
+        out << line;
+        summarize(shared.stats, out);
+        return failed ? 1 : 0;
+    }
+}
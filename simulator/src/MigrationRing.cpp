@@ -0,0 +1,45 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/MigrationRing.hpp"
+#include <cstring>
+
+namespace simulator {
+
+    MigrationRing::MigrationRing()
+      : m_head(0)
+      , m_tail(0)
+    {
+    }
+
+    bool MigrationRing::push(char const * data, std::size_t const size)
+    {
+        if (size > sizeof(Slot::data)) {
+            return false;
+        }
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == SLOTS) {
+            return false;
+        }
+        auto & slot = m_slots[tail % SLOTS];
+        slot.size = static_cast<std::uint32_t>(size);
+        std::memcpy(slot.data, data, size);
+
+        // Publishes the slot contents to the consumer
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool MigrationRing::pop(std::vector<char> & data)
+    {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto const & slot = m_slots[head % SLOTS];
+        data.assign(slot.data, slot.data + slot.size);
+
+        // Hands the slot back to the producer
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+}
@@ -1,9 +1,21 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "simulator/Population.hpp"
+#include "instrument/Instrument.hpp"
+#include "neat/Random.hpp"
+#include "serial/BinaryStream.hpp"
+#include <algorithm>
+#include <cstdint>
 
 namespace {
     using FitnessPair = std::pair<int, double>;
+
+    // Genomes differing by less than this are of the same species
+    double const SPECIES_THRESHOLD = 1;
+
+    // Chance that a generational offspring has a second parent
+    double const CROSSOVER_PROBABILITY = 0.75;
+
     bool 
     iIsIndexedInTopN(int const i,
                      int const N,
@@ -20,70 +32,7 @@ namespace {
 
     inline int randomInt(int const popSize)
     {
-        return (rand() % static_cast<int>(popSize));
-    }
-
-    // Experimental; crossover function not working
-    neat::Network offspringNet(int const index, std::vector<simulator::Agent> const & agents) 
-    {
-
-        // Only cross over most similar
-        auto & candA = agents[index];
-        auto neatA = candA.getNeatNet();
-
-        auto diff = 10000;
-        int i = 0;
-        int rem = 0;
-        for(auto const & candB : agents) {
-            auto neatB = candB.getNeatNet();
-            auto d = neatA.measureDifference(neatB);
-            if(d < diff && i != index) {
-                diff = d;
-                rem = i;
-            }
-            ++i;
-        }
-
-        auto & candB = agents[rem];
-        auto neatB = candB.getNeatNet();
-        return neatA.crossWith(neatB);
-    }
-
-    double getSharedFitness(simulator::Agent & candidate, std::vector<simulator::Agent> & agents)
-    {
-        // Only cross over most similar
-        auto neatA = candidate.getNeatNet();
-
-        // Species colour-coded (r,g,b);
-        auto speciesColour = candidate.getSpeciesColour();
-        auto const r = speciesColour.R;
-        auto const g = speciesColour.G;
-        auto const b = speciesColour.B;
-
-        auto thresh = 1;
-        int i = 0;
-        for(auto & candB : agents) {
-            auto neatB = candB.getNeatNet();
-            auto d = neatA.measureDifference(neatB);
-            if(d < thresh) {
-                candB.updateSpeciesColour(r, g, b);
-                ++i;
-            }
-        }
-        auto const adjusted = candidate.distanceMoved() / (double)i;
-        return adjusted;
-    }
-
-    int getSegmentCount(int const index, std::vector<simulator::Agent> & agents)
-    {
-        auto neat = agents[index].getNeatNet();
-        auto output = neat.getOutput(2);
-        output += 1;
-        auto segments = output * 5.0;
-        if(segments > 12) {
-            segments = 12;
-        }
-        return (int)(segments);
+        return (neat::random() % static_cast<int>(popSize));
     }
 }
 
@@ -94,13 +43,29 @@ namespace simulator {
     , m_animatWorld(animatWorld)
     , m_eliteIndex(0)
     , m_evoOn(true)
+    , m_fitnesses()
+    , m_recorder()
+    , m_generationTicks(0)
+    , m_generationAge(0)
+    , m_pool()
+    , m_species(popSize, SPECIES_THRESHOLD)
+    , m_broken()
+    , m_speciesColours()
+    , m_offspring()
+    , m_engines()
+    , m_breedSeed(0)
+    , m_prescreener()
+    , m_pending()
+    , m_scores()
     {
         m_agents.reserve(popSize);
+        m_fitnesses.reserve(popSize);
         for(int i = 0;i<popSize;++i){
             m_animatWorld.randomizePositionSingleAnimat(i, 10, 10);
             m_agents.emplace_back(m_animatWorld.animat(i));
             m_agents.back().recordStartPosition();
         }
+        setWorkers(0);
     }
 
     void Population::activateEvolution()
@@ -112,6 +77,77 @@ namespace simulator {
         m_evoOn = false;
     }
 
+    void Population::setWorkers(int const workers)
+    {
+        auto const cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        auto const count = std::max(1, std::min(workers > 0 ? workers : cores, m_popSize));
+        if (!m_pool || m_pool->size() != count) {
+            m_pool = std::make_unique<WorkerPool>(count);
+            m_engines.resize(count);
+
+            // Scratch bodies are per worker
+            if (m_prescreener) {
+                setPrescreen(m_prescreener->options());
+            }
+        }
+    }
+
+    void Population::setPrescreen(PrescreenOptions const & options)
+    {
+        m_prescreener = std::make_unique<Prescreener>(options, m_pool->size());
+        m_pending.reserve(m_popSize);
+        m_scores.resize(m_popSize);
+    }
+
+    void Population::disablePrescreen()
+    {
+        m_prescreener.reset();
+    }
+
+    void Population::genomesChanged()
+    {
+        m_species.invalidateAll();
+    }
+
+    void Population::setGenerational(int const generationTicks)
+    {
+        if (generationTicks < 1) {
+            throw std::runtime_error("Population::setGenerational: bad generation length");
+        }
+
+        // Agents are stepped in isolation, so collisions would
+        // silently be ignored
+        auto const collisions = std::any_of(std::begin(m_agents), std::end(m_agents),
+                                            [](Agent const & agent) {
+                                                return agent.handlesCollisions();
+                                            });
+        if (collisions) {
+            throw std::runtime_error("Population::setGenerational: collisions are on");
+        }
+        m_generationTicks = generationTicks;
+        m_generationAge = 0;
+        reserveGenerational();
+
+        // Every agent starts the first generation afresh
+        for (auto & agent : m_agents) {
+            agent.resetAge();
+            agent.recordStartPosition();
+        }
+    }
+
+    void Population::setSteadyState()
+    {
+        m_generationTicks = 0;
+        m_generationAge = 0;
+    }
+
+    void Population::reserveGenerational()
+    {
+        m_broken.assign(m_popSize, 0);
+        m_speciesColours.resize(m_popSize);
+        m_offspring.reserve(m_popSize);
+    }
+
     std::vector<simulator::Agent> & Population::getAgents()
     {
         return m_agents;
@@ -121,6 +157,18 @@ namespace simulator {
                             int const everyN,
                             bool const withMutations)
     {
+        INSTRUMENT_TRACED_SCOPE("population.update");
+
+        // Only genomes replaced since the last update are compared again
+        m_species.update(m_agents, *m_pool);
+
+        if(m_generationTicks > 0) {
+            updateGenerational();
+            if(m_recorder) {
+                recordTrajectories(tick);
+            }
+            return;
+        }
 
         int p = 0;
         double best = 0.0;
@@ -145,7 +193,8 @@ namespace simulator {
             // choose another population member at random
             // and replace this one if chosen one is fitter.
             if(agent.getAge() >= 20) {
-                auto adjustedFitness = getSharedFitness(agent, m_agents);
+                INSTRUMENT_COUNT("evolution.evaluations", 1);
+                auto adjustedFitness = sharedFitness(p);
                 agent.setAdjustedFitness(adjustedFitness);
                 if(adjustedFitness > best) {
                     best = adjustedFitness;
@@ -170,8 +219,8 @@ namespace simulator {
         // Probabilitisticazlly choose parent to generate offspring scaled
         // according to the overall best adjusted fitness
         if(m_evoOn) {
-            std::vector<FitnessPair> fitnesses;
-            fitnesses.reserve(m_popSize);
+            auto & fitnesses = m_fitnesses;
+            fitnesses.clear();
             int i = 0;
             for (auto const & agent : m_agents) {
                 auto f = agent.getAdjustedFitness();
@@ -198,20 +247,391 @@ namespace simulator {
             if(bestIndex > -1 && worstIndex > -1 && worstIndex != choice) {
                 m_agents[worstIndex].inheritNeat(m_agents[choice]);
                 m_agents[worstIndex].mutateNeat();
-                // Mutating the NEAT architecture can result in a
-                // different number of body segments meaning that
-                // the animat needs to be reconstructed.
-                /*
-                auto const oldSegmentCount = m_animatWorld.animat(worstIndex)
-                                             ->getBlockCount();
-                auto const segments = getSegmentCount(worstIndex, m_agents);
-                if(segments != oldSegmentCount) {
-                    m_animatWorld.reconstructAnimat(worstIndex, segments);
-                    m_animatWorld.randomizePositionSingleAnimat(worstIndex, 10, 10);
-                }*/
-                m_agents[worstIndex].resetController();
+
+                // Clearly bad offspring are bred again; the last
+                // attempt stands whatever it would have scored
+                if(m_prescreener) {
+                    for (int attempt = 1;
+                         attempt < m_prescreener->options().attempts && !prescreen(worstIndex);
+                         ++attempt) {
+                        m_agents[worstIndex].inheritNeat(m_agents[choice]);
+                        m_agents[worstIndex].mutateNeat();
+                    }
+                }
+                m_species.invalidate(worstIndex);
+                rebuildAgent(worstIndex);
                 m_animatWorld.incrementOptimizationCount();
             }
         }
+
+        if(m_recorder) {
+            recordTrajectories(tick);
+        }
+    }
+
+    double Population::sharedFitness(int const index)
+    {
+        // Species colour-coded (r,g,b);
+        auto const colour = m_agents[index].getSpeciesColour();
+        m_species.forEachMember(index, [this, &colour](int const member) {
+            m_agents[member].updateSpeciesColour(colour.R, colour.G, colour.B);
+        });
+        return m_agents[index].distanceMoved() / m_species.speciesSize(index);
+    }
+
+    void Population::rebuildAgent(int const index)
+    {
+        if(resizeAgent(index)) {
+            placeAgent(index);
+        }
+        m_agents[index].resetController();
+    }
+
+    bool Population::resizeAgent(int const index)
+    {
+        // Mutating the NEAT architecture can result in a
+        // different number of body segments meaning that
+        // the animat needs to be reconstructed. That happens
+        // in place; the renderer picks it up from the next
+        // snapshot.
+        auto const oldSegmentCount = m_animatWorld.animat(index)->getBlockCount();
+        auto const segments = m_agents[index].segmentCount();
+        if(segments > 0 && segments != oldSegmentCount) {
+            TRACE_INSTANT("evolution.resize");
+            m_animatWorld.reconstructAnimat(index, segments);
+            return true;
+        }
+        return false;
+    }
+
+    void Population::placeAgent(int const index)
+    {
+        m_animatWorld.randomizePositionSingleAnimat(index, 10, 10);
+        m_agents[index].recordStartPosition();
+    }
+
+    bool Population::prescreen(int const index)
+    {
+        auto const blocks = m_animatWorld.animat(index)->getBlockCount();
+        auto const score = m_prescreener->score(m_agents[index].getNeatNet(), blocks, 0);
+        if(m_prescreener->accept(score)) {
+            return true;
+        }
+        INSTRUMENT_COUNT("evolution.prescreen_rejections", 1);
+        return false;
+    }
+
+    void Population::prescreenOffspring()
+    {
+        INSTRUMENT_TRACED_SCOPE("population.prescreen");
+        m_pending.clear();
+        for (int o = 0; o < m_offspring.size(); ++o) {
+            m_pending.push_back(o);
+        }
+        auto const attempts = m_prescreener->options().attempts;
+        auto const workers = m_pool->size();
+        for (int attempt = 1; attempt < attempts && !m_pending.empty(); ++attempt) {
+
+            // Scoring only touches each worker's scratch body
+            auto const pending = static_cast<int>(m_pending.size());
+            m_pool->run([this, pending, workers](int const worker) {
+                for (int p = worker; p < pending; p += workers) {
+                    auto const index = m_offspring[m_pending[p]].index;
+                    auto const blocks = m_animatWorld.animat(index)->getBlockCount();
+                    m_scores[p] = m_prescreener->score(m_agents[index].getNeatNet(),
+                                                       blocks, worker);
+                }
+            });
+
+            // Judged in a fixed order, as the running average depends
+            // on it; failures are bred again from the same parents
+            auto kept = 0;
+            for (int p = 0; p < pending; ++p) {
+                if(m_prescreener->accept(m_scores[p])) {
+                    continue;
+                }
+                INSTRUMENT_COUNT("evolution.prescreen_rejections", 1);
+                m_pending[kept++] = m_pending[p];
+            }
+            m_pending.resize(kept);
+            m_pool->run([this, kept, workers, attempt](int const worker) {
+                for (int p = worker; p < kept; p += workers) {
+                    neat::RandomScope scope(seedEngine(worker, m_pending[p], attempt));
+                    breed(m_offspring[m_pending[p]]);
+                }
+            });
+        }
+    }
+
+    void Population::updateGenerational()
+    {
+        // Evaluate: agents only touch their own state so are
+        // stepped concurrently
+        m_pool->forEach(m_popSize, [this](int const i) {
+            m_broken[i] = m_agents[i].update() == -1;
+        });
+        for (int i = 0; i < m_popSize; ++i) {
+            if(m_broken[i]) {
+                m_animatWorld.randomizePositionSingleAnimat(i, 10, 10);
+                m_agents[i].recordStartPosition();
+                m_agents[i].resetController();
+                m_agents[i].setBad();
+            }
+        }
+        if(++m_generationAge < m_generationTicks) {
+            return;
+        }
+        m_generationAge = 0;
+        reproduce();
+    }
+
+    void Population::reproduce()
+    {
+        INSTRUMENT_TRACED_SCOPE("population.reproduce");
+        INSTRUMENT_COUNT("evolution.evaluations", m_popSize);
+
+        // Species were brought up to date at the start of this update;
+        // each agent takes on the colour of its species' lowest-indexed
+        // member
+        m_pool->forEach(m_popSize, [this](int const i) {
+            m_agents[i].recordDistanceMoved();
+        });
+        for (int i = 0; i < m_popSize; ++i) {
+            m_speciesColours[i] = m_agents[m_species.representative(i)].getSpeciesColour();
+        }
+        m_fitnesses.clear();
+        for (int i = 0; i < m_popSize; ++i) {
+            auto const & colour = m_speciesColours[i];
+            m_agents[i].updateSpeciesColour(colour.R, colour.G, colour.B);
+            auto const adjustedFitness = m_agents[i].distanceMoved() / m_species.speciesSize(i);
+            m_agents[i].setAdjustedFitness(adjustedFitness);
+            m_fitnesses.emplace_back(i, adjustedFitness);
+        }
+
+        // Selection, fittest first; the weaker half is replaced
+        std::sort(std::begin(m_fitnesses), std::end(m_fitnesses),
+                  [](FitnessPair const & a, FitnessPair const & b) {
+                      return a.second > b.second;
+                  });
+        m_eliteIndex = m_fitnesses.front().first;
+        auto const survivors = m_popSize - m_popSize / 2;
+        auto totalFitness = 0.0;
+        for (int s = 0; s < survivors; ++s) {
+            totalFitness += m_fitnesses[s].second;
+        }
+
+        // Breeding, parent choice included, happens concurrently.
+        // Each offspring draws from an engine seeded for it alone from
+        // a seed drawn here, so a seeded run breeds the same offspring
+        // whichever worker handles them.
+        m_offspring.clear();
+        if(m_evoOn) {
+            for (int f = survivors; f < m_popSize; ++f) {
+                m_offspring.push_back({m_fitnesses[f].first, -1, -1, false});
+            }
+        }
+        auto const count = static_cast<int>(m_offspring.size());
+        auto const workers = m_pool->size();
+        m_breedSeed = static_cast<std::uint32_t>(::rand());
+        m_pool->run([this, count, workers, survivors, totalFitness](int const worker) {
+            for (int o = worker; o < count; o += workers) {
+                neat::RandomScope scope(seedEngine(worker, o, 0));
+                chooseParents(m_offspring[o], survivors, totalFitness);
+                breed(m_offspring[o]);
+            }
+        });
+        if(m_prescreener) {
+            prescreenOffspring();
+        }
+
+        // Resizing a body touches that body alone, but placing it
+        // looks at every other, so is done afterwards in a fixed order
+        m_pool->forEach(count, [this](int const o) {
+            auto & offspring = m_offspring[o];
+            offspring.resized = resizeAgent(offspring.index);
+            m_agents[offspring.index].resetController();
+        });
+        for (auto const & offspring : m_offspring) {
+            m_species.invalidate(offspring.index);
+            if(offspring.resized) {
+                placeAgent(offspring.index);
+            }
+            m_animatWorld.incrementOptimizationCount();
+        }
+
+        // Everyone starts the next generation from where they are
+        m_pool->forEach(m_popSize, [this](int const i) {
+            auto & agent = m_agents[i];
+            agent.resetAge();
+            m_animatWorld.translateIfOutOfBounds(i, 200, 200);
+            agent.recordStartPosition();
+        });
+    }
+
+    std::mt19937 & Population::seedEngine(int const worker, int const o, int const attempt)
+    {
+        auto & engine = m_engines[worker];
+        engine.seed(m_breedSeed + static_cast<std::uint32_t>(attempt * m_popSize + o));
+        return engine;
+    }
+
+    void Population::chooseParents(Offspring & offspring,
+                                   int const survivors,
+                                   double const totalFitness) const
+    {
+        offspring.parent = chooseSurvivor(survivors, totalFitness);
+        offspring.mate = offspring.parent;
+        if(neat::random() / double(RAND_MAX) < CROSSOVER_PROBABILITY) {
+            offspring.mate = chooseSurvivor(survivors, totalFitness);
+            if(m_agents[offspring.mate].getAdjustedFitness() >
+               m_agents[offspring.parent].getAdjustedFitness()) {
+                std::swap(offspring.parent, offspring.mate);
+            }
+        }
+    }
+
+    void Population::breed(Offspring const & offspring)
+    {
+        auto & agent = m_agents[offspring.index];
+        agent.inheritNeat(m_agents[offspring.parent], m_agents[offspring.mate]);
+        agent.mutateNeat();
     }
-}
\ No newline at end of file
+
+    int Population::chooseSurvivor(int const survivors, double const totalFitness) const
+    {
+        if(totalFitness <= 0) {
+            return m_fitnesses[randomInt(survivors)].first;
+        }
+        auto const target = neat::random() / double(RAND_MAX) * totalFitness;
+        auto sum = 0.0;
+        for (int s = 0; s < survivors; ++s) {
+            sum += m_fitnesses[s].second;
+            if(target <= sum) {
+                return m_fitnesses[s].first;
+            }
+        }
+        return m_fitnesses[survivors - 1].first;
+    }
+
+    void Population::fittest(int const count, std::vector<int> & indices) const
+    {
+        indices.clear();
+        for (int i = 0; i < m_agents.size(); ++i) {
+            indices.push_back(i);
+        }
+        auto const n = std::min(std::max(count, 0), static_cast<int>(indices.size()));
+        std::partial_sort(std::begin(indices), std::begin(indices) + n, std::end(indices),
+                          [this](int const a, int const b) {
+                              return m_agents[a].getAdjustedFitness() >
+                                     m_agents[b].getAdjustedFitness();
+                          });
+        indices.resize(n);
+    }
+
+    void Population::immigrate(neat::Network const & genome)
+    {
+        auto weakest = 0;
+        auto total = 0.0;
+        for (int i = 0; i < m_agents.size(); ++i) {
+            auto const fitness = m_agents[i].getAdjustedFitness();
+            total += fitness;
+            if (fitness < m_agents[weakest].getAdjustedFitness()) {
+                weakest = i;
+            }
+        }
+        auto & agent = m_agents[weakest];
+        agent.inheritNeat(genome);
+        m_species.invalidate(weakest);
+        rebuildAgent(weakest);
+        agent.resetAge();
+        agent.recordStartPosition();
+        agent.setAdjustedFitness(total / m_agents.size());
+    }
+
+    void Population::setRecorder(std::shared_ptr<recorder::TrajectoryRecorder> trajectoryRecorder)
+    {
+        m_recorder = std::move(trajectoryRecorder);
+    }
+
+    void Population::recordTrajectories(long const tick)
+    {
+        auto const frame = m_recorder->beginFrame(tick);
+        if(!frame) {
+            return;
+        }
+        for (auto const & agent : m_agents) {
+            agent.recordFrame(*frame);
+        }
+        m_recorder->commitFrame();
+    }
+
+    bool Population::evolutionActive() const
+    {
+        return m_evoOn;
+    }
+
+    int Population::getEliteIndex() const
+    {
+        return m_eliteIndex;
+    }
+
+    void Population::setEliteIndex(int const eliteIndex)
+    {
+        m_eliteIndex = eliteIndex;
+    }
+
+    int Population::getGenerationTicks() const
+    {
+        return m_generationTicks;
+    }
+
+    int Population::getGenerationAge() const
+    {
+        return m_generationAge;
+    }
+
+    void Population::setGenerationState(int const generationTicks, int const generationAge)
+    {
+        if (generationTicks < 0 || generationAge < 0 ||
+            (generationTicks > 0 && generationAge >= generationTicks) ||
+            (generationTicks == 0 && generationAge != 0)) {
+            throw std::runtime_error("Population::setGenerationState: bad generation state");
+        }
+        m_generationTicks = generationTicks;
+        m_generationAge = generationAge;
+        if (generationTicks > 0) {
+            reserveGenerational();
+        }
+    }
+
+    void Population::save(serial::BinaryWriter & writer) const
+    {
+        writer.write(m_evoOn);
+        writer.write(static_cast<std::int32_t>(m_eliteIndex));
+        writer.write(static_cast<std::int32_t>(m_generationTicks));
+        writer.write(static_cast<std::int32_t>(m_generationAge));
+        writer.write(static_cast<std::int32_t>(m_agents.size()));
+        for (auto const & agent : m_agents) {
+            agent.save(writer);
+        }
+    }
+
+    void Population::load(serial::BinaryReader & reader)
+    {
+        reader.read(m_evoOn);
+        m_eliteIndex = reader.read<std::int32_t>();
+        auto const generationTicks = reader.read<std::int32_t>();
+        setGenerationState(generationTicks, reader.read<std::int32_t>());
+        auto const popSize = reader.read<std::int32_t>();
+        if (popSize != m_agents.size()) {
+            throw std::runtime_error("Population::load: population size mismatch");
+        }
+        int p = 0;
+        for (auto & agent : m_agents) {
+            agent.updateAnimat(m_animatWorld.animat(p));
+            agent.load(reader);
+            ++p;
+        }
+        m_species.invalidateAll();
+    }
+}
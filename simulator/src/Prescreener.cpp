@@ -0,0 +1,102 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/Prescreener.hpp"
+#include "simulator/Agent.hpp"
+#include "simulator/CTRNNController.hpp"
+#include "instrument/Instrument.hpp"
+#include <algorithm>
+
+namespace {
+
+    // Scores are compared against the average only once there are
+    // enough of them to average
+    long const WARM_UP = 10;
+
+    // Weight of each new score in the running average
+    double const AVERAGE_WEIGHT = 0.05;
+}
+
+namespace simulator {
+
+    Prescreener::Prescreener(PrescreenOptions const & options, int const workers)
+      : m_options(options)
+      , m_scratch(std::max(1, workers))
+      , m_average(0)
+      , m_samples(0)
+    {
+        if (options.ticks < 1 || options.substeps < 1 || options.attempts < 1) {
+            throw std::runtime_error("Prescreener: bad options");
+        }
+    }
+
+    Prescreener::Scratch::Scratch(neat::Network const & g)
+      : genome(g)
+      , animat(0)
+      , controllers()
+    {
+    }
+
+    PrescreenOptions const & Prescreener::options() const
+    {
+        return m_options;
+    }
+
+    double Prescreener::score(neat::Network const & genome,
+                              int const currentBlocks,
+                              int const worker)
+    {
+        INSTRUMENT_SCOPE("evolution.prescreen");
+        auto & scratch = m_scratch[worker];
+        if (!scratch) {
+            scratch.reset(new Scratch(genome));
+        } else {
+            scratch->genome = genome;
+        }
+
+        auto const segments = Agent::segmentCount(scratch->genome);
+        auto const blocks = segments > 0 ? segments : currentBlocks;
+        auto & animat = scratch->animat;
+        animat.resize(blocks);
+        auto & controllers = scratch->controllers;
+        auto const slot = static_cast<std::size_t>(blocks);
+        if (slot >= controllers.size()) {
+            controllers.resize(slot + 1);
+        }
+        auto & controller = controllers[slot];
+        if (controller) {
+            controller->reset();
+        } else {
+            controller = makeCTRNNController(blocks, scratch->genome);
+        }
+
+        // As Agent::update, with the same simulated time per tick
+        // split into fewer, longer steps
+        auto const timeStep = 1.0 / m_options.substeps;
+        auto const start = animat.getCentralPoint().first;
+        for (int tick = 0; tick < m_options.ticks; ++tick) {
+            for (int step = 0; step < m_options.substeps; ++step) {
+                for (int b = 0; b < blocks; ++b) {
+                    animat.applyBlockContraction(b, 0, controller->getLeftMotorOutput(b) * 20);
+                    animat.applyBlockContraction(b, 1, controller->getRightMotorOutput(b) * 20);
+                }
+                animat.applyWaterForces();
+                animat.update(timeStep);
+                if (animat.broke()) {
+                    return 0;
+                }
+            }
+            controller->update();
+        }
+        return animat.getCentralPoint().first.distance(start);
+    }
+
+    bool Prescreener::accept(double const score)
+    {
+        auto const pass = m_samples < WARM_UP ||
+                          score >= m_options.rejectFraction * m_average;
+        m_average = m_samples == 0 ? score
+                                   : m_average + (score - m_average) * AVERAGE_WEIGHT;
+        ++m_samples;
+        return pass;
+    }
+}
@@ -0,0 +1,255 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/Replay.hpp"
+#include "physics/PhysicsEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+    /// How often the playback thread wakes up (~60Hz). Between
+    /// wake-ups it sleeps, which is what keeps replay cheap.
+    auto const FRAME_INTERVAL = std::chrono::milliseconds(16);
+
+    /// Default playback speed, in recorded ticks per second
+    double const DEFAULT_SPEED = 60.0;
+
+    int recordedPopSize(recorder::TrajectoryReader const & reader)
+    {
+        if (reader.chunks().empty()) {
+            throw std::runtime_error("Replay: trajectory has no frames");
+        }
+        return reader.chunks().front().header.agentCount;
+    }
+}
+
+namespace simulator {
+
+    Replay::Replay(std::string const & path)
+      : m_reader(path)
+      , m_animatWorld(recordedPopSize(m_reader))
+      , m_frames()
+      , m_chunk(-1)
+      , m_frame(-1)
+      , m_position(0)
+      , m_currentTick(0)
+      , m_paused(false)
+      , m_speed(DEFAULT_SPEED)
+      , m_seekPending(false)
+      , m_seekTarget(0)
+      , m_stepPending(0)
+      , m_shutdown(false)
+    {
+        // Show the first frame straight away so that the world
+        // is in a recorded state before anything draws it
+        loadChunk(0);
+        m_frame = 0;
+        applyFrame(m_frames.front());
+        m_position = m_frames.front().tick;
+    }
+
+    Replay::~Replay()
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_shutdown = true;
+        }
+        m_cond.notify_all();
+        if (m_playbackThread.joinable()) {
+            m_playbackThread.join();
+        }
+    }
+
+    model::AnimatWorld & Replay::animatWorld()
+    {
+        return m_animatWorld;
+    }
+
+    void Replay::start()
+    {
+        m_playbackThread = std::thread(&Replay::run, this);
+    }
+
+    void Replay::pause()
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_paused = true;
+    }
+
+    void Replay::resume()
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_paused = false;
+    }
+
+    void Replay::setSpeed(double const ticksPerSecond)
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+        m_speed = std::max(ticksPerSecond, 0.0);
+    }
+
+    void Replay::seek(long const tick)
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_seekPending = true;
+            m_seekTarget = tick;
+            m_stepPending = 0;
+        }
+        m_cond.notify_all();
+    }
+
+    void Replay::step(long const frames)
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_stepPending += frames;
+        }
+        m_cond.notify_all();
+    }
+
+    long Replay::currentTick() const
+    {
+        return m_currentTick;
+    }
+
+    long Replay::firstTick() const
+    {
+        return m_reader.chunks().front().header.firstTick;
+    }
+
+    long Replay::lastTick() const
+    {
+        return m_reader.chunks().back().header.lastTick;
+    }
+
+    void Replay::run()
+    {
+        auto last = std::chrono::steady_clock::now();
+        while (true) {
+            std::unique_lock<std::mutex> ul(m_mutex);
+            m_cond.wait_for(ul, FRAME_INTERVAL, [this] {
+                return m_shutdown || m_seekPending || m_stepPending != 0;
+            });
+            if (m_shutdown) {
+                return;
+            }
+            auto const now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> const elapsed = now - last;
+            last = now;
+
+            auto const stepBy = m_stepPending;
+            m_stepPending = 0;
+            if (m_seekPending) {
+                m_position = m_seekTarget;
+                m_seekPending = false;
+            } else if (!m_paused && stepBy == 0) {
+                m_position = std::min(m_position + elapsed.count() * m_speed,
+                                      static_cast<double>(lastTick()));
+            }
+            auto const target = static_cast<long>(m_position);
+            ul.unlock();
+
+            // Frames are applied outside the lock so that
+            // controls never wait on chunk decoding. A corrupt or
+            // truncated chunk pauses playback on the last good frame;
+            // seeking elsewhere carries on from there.
+            try {
+                if (stepBy != 0) {
+                    showRelative(stepBy);
+                    ul.lock();
+                    m_position = m_currentTick;
+                } else {
+                    showTick(target);
+                }
+            } catch (std::exception const & e) {
+                std::cerr << "Replay: " << e.what() << std::endl;
+                if (!ul.owns_lock()) {
+                    ul.lock();
+                }
+                m_paused = true;
+                m_position = m_currentTick;
+            }
+        }
+    }
+
+    void Replay::showTick(long const tick)
+    {
+        auto const & chunks = m_reader.chunks();
+        auto const inCurrent = m_chunk >= 0 &&
+            tick >= m_frames.front().tick &&
+            (m_chunk + 1 == chunks.size() || tick < chunks[m_chunk + 1].header.firstTick);
+        if (!inCurrent) {
+            loadChunk(m_reader.findChunk(tick));
+        }
+
+        auto const it = std::upper_bound(std::begin(m_frames), std::end(m_frames), tick,
+                                         [](long const t, recorder::TickFrame const & frame) {
+                                             return t < frame.tick;
+                                         });
+        auto const frame = std::max<int>(std::distance(std::begin(m_frames), it) - 1, 0);
+        if (frame != m_frame || !inCurrent) {
+            m_frame = frame;
+            applyFrame(m_frames[m_frame]);
+        }
+    }
+
+    void Replay::showRelative(long frames)
+    {
+        if (m_chunk < 0) {
+            showTick(m_currentTick);
+        }
+        auto const chunkCount = static_cast<int>(m_reader.chunks().size());
+        auto frame = m_frame + frames;
+        while (frame < 0 && m_chunk > 0) {
+            loadChunk(m_chunk - 1);
+            frame += m_frames.size();
+        }
+        while (frame >= static_cast<long>(m_frames.size()) && m_chunk + 1 < chunkCount) {
+            frame -= m_frames.size();
+            loadChunk(m_chunk + 1);
+        }
+        m_frame = std::min(std::max(frame, 0L), static_cast<long>(m_frames.size()) - 1);
+        applyFrame(m_frames[m_frame]);
+    }
+
+    void Replay::loadChunk(int const chunk)
+    {
+        // Left unloaded if reading fails part way
+        m_chunk = -1;
+        m_reader.readChunk(chunk, m_frames);
+        m_chunk = chunk;
+        m_frame = -1;
+    }
+
+    void Replay::applyFrame(recorder::TickFrame const & frame)
+    {
+        if (frame.agentCount() != m_animatWorld.getPopSize()) {
+            throw std::runtime_error("Replay: frame population size mismatch");
+        }
+        auto pointOffset = 0;
+        for (int i = 0; i < frame.agentCount(); ++i) {
+            auto const blocks = frame.blockCounts[i];
+            if (blocks != m_animatWorld.animat(i)->getBlockCount()) {
+                m_animatWorld.reconstructAnimat(i, blocks);
+            }
+            auto const animat = m_animatWorld.animat(i);
+            auto & engine = animat->getPhysicsEngine();
+            auto const pointCount = (blocks + 1) * 2;
+            for (int p = 0; p < pointCount; ++p) {
+                engine.setPointMassPosition(p, {frame.pointX[pointOffset + p],
+                                                frame.pointY[pointOffset + p],
+                                                0});
+            }
+            pointOffset += pointCount;
+            animat->updateSpeciesColour(frame.speciesR[i],
+                                        frame.speciesG[i],
+                                        frame.speciesB[i]);
+            animat->updateDerivedComponents();
+        }
+        m_currentTick = frame.tick;
+        m_animatWorld.publishSnapshot(frame.tick);
+    }
+}
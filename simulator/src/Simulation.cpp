@@ -1,19 +1,40 @@
 /// Copyright (c) 2017 Ben Jones
 
 #include "simulator/Simulation.hpp"
+#include "simulator/FlatCheckpoint.hpp"
+#include "instrument/Instrument.hpp"
+#include "serial/BinaryStream.hpp"
+#include <cstdint>
 #include <unistd.h>
 #include <algorithm>
 #include <thread>
 
 namespace simulator {
 
-    Simulation::Simulation(int const popSize)
-    : m_animatWorld(popSize)
+    Simulation::Simulation(int const popSize, unsigned const seed)
+    : m_animatWorld(popSize, seed)
     , m_population(popSize, m_animatWorld)
     , m_paused(false)
     , m_sleepDuration{0}
+    , m_tick(0)
+    , m_checkpointer()
+    , m_checkpointEvery(0)
+    , m_checkpointFormat(CheckpointFormat::Stream)
+    , m_checkpointRequested(false)
+    , m_checkpointBuffer()
+    , m_checkpointRecords()
+    , m_recorder()
+    , m_retiredRecorder()
+    , m_recorderMutex()
+    , m_recorderChanged(false)
+    , m_frameCapture()
+    , m_activeFrameCapture()
+    , m_retiredFrameCapture()
+    , m_frameCaptureMutex()
+    , m_frameCaptureChanged(false)
     {
         //m_animatWorld.randomizePositions(10, 10);
+        m_animatWorld.publishSnapshot(m_tick);
     }
 
     void Simulation::activateEvolution()
@@ -25,11 +46,41 @@ namespace simulator {
         m_population.deactivateEvolution();
     }
 
+    void Simulation::setGenerational(int const generationTicks)
+    {
+        m_population.setGenerational(generationTicks);
+    }
+
+    void Simulation::setSteadyState()
+    {
+        m_population.setSteadyState();
+    }
+
+    void Simulation::setWorkers(int const workers)
+    {
+        m_population.setWorkers(workers);
+    }
+
+    void Simulation::setPrescreen(PrescreenOptions const & options)
+    {
+        m_population.setPrescreen(options);
+    }
+
+    void Simulation::disablePrescreen()
+    {
+        m_population.disablePrescreen();
+    }
+
     model::AnimatWorld & Simulation::animatWorld()
     {
         return m_animatWorld;
     }
 
+    Population & Simulation::population()
+    {
+        return m_population;
+    }
+
     void Simulation::start()
     {
         // run simulation proper
@@ -56,26 +107,184 @@ namespace simulator {
                             bool const withMutations)
     {
         m_population.update(tick, everyN, withMutations);
+
+        // Headless runs (islands, benchmarks, frame capture) have no
+        // one to publish to
+        if (m_animatWorld.rendererAttached()) {
+            m_animatWorld.publishSnapshot(tick);
+        }
     }
 
     void Simulation::loop()
     {
-        long tick = 0;
+        instrument::Tracer::instance().setThreadName("sim");
         while(true) {
 
             // TODO: change from a spin-lock-esque
             // pattern to a proper condition var.
             // I'm being lazy. Need a holiday.
             if(!m_paused) {
-                doLoop(tick, 500);
+                tick();
                 usleep(m_sleepDuration);
-                ++tick;
             }
+            betweenTicks();
+        }
+    }
+
+    void Simulation::runTicks(long const count)
+    {
+        for (long t = 0; t < count; ++t) {
+            tick();
+            betweenTicks();
+        }
+    }
+
+    void Simulation::tick()
+    {
+        {
+            INSTRUMENT_TRACED_SCOPE("sim.tick");
+            doLoop(m_tick, 500);
+            captureFrame();
+        }
+        INSTRUMENT_COUNT("sim.ticks", 1);
+        ++m_tick;
+    }
+
+    void Simulation::betweenTicks()
+    {
+        // Checkpoints are taken between ticks so that
+        // the captured state is always consistent
+        if(m_checkpointer &&
+           (m_checkpointRequested.exchange(false) ||
+            (!m_paused && m_checkpointEvery > 0 && m_tick % m_checkpointEvery == 0))) {
+            checkpoint();
+        }
+
+        if(m_recorderChanged.exchange(false)) {
+            std::lock_guard<std::mutex> lg(m_recorderMutex);
+            m_population.setRecorder(m_recorder);
+        }
+
+        if(m_frameCaptureChanged.exchange(false)) {
+            std::lock_guard<std::mutex> lg(m_frameCaptureMutex);
+            m_activeFrameCapture = m_frameCapture;
         }
     }
 
+    void Simulation::startRecording(std::string const & path, long const everyN)
+    {
+        auto trajectoryRecorder = std::make_shared<recorder::TrajectoryRecorder>(path, everyN);
+        stopRecording();
+        std::lock_guard<std::mutex> lg(m_recorderMutex);
+        m_recorder = std::move(trajectoryRecorder);
+        m_recorderChanged = true;
+    }
+
+    void Simulation::stopRecording()
+    {
+        std::lock_guard<std::mutex> lg(m_recorderMutex);
+        if(m_recorder) {
+            m_recorder->close();
+            m_retiredRecorder = std::move(m_recorder);
+        }
+        m_recorderChanged = true;
+    }
+
+    void Simulation::startFrameCapture(std::string const & directory,
+                                       long const everyN,
+                                       recorder::ImageFormat const format)
+    {
+        auto frameCapture = std::make_shared<recorder::FrameCapture>(directory, everyN, format);
+        stopFrameCapture();
+        std::lock_guard<std::mutex> lg(m_frameCaptureMutex);
+        m_frameCapture = std::move(frameCapture);
+        m_frameCaptureChanged = true;
+    }
+
+    void Simulation::stopFrameCapture()
+    {
+        std::lock_guard<std::mutex> lg(m_frameCaptureMutex);
+        if(m_frameCapture) {
+            m_frameCapture->close();
+            m_retiredFrameCapture = std::move(m_frameCapture);
+        }
+        m_frameCaptureChanged = true;
+    }
+
+    void Simulation::captureFrame()
+    {
+        if(!m_activeFrameCapture) {
+            return;
+        }
+        if(auto const snapshot = m_activeFrameCapture->beginFrame(m_tick)) {
+            m_animatWorld.fillSnapshot(*snapshot, m_tick);
+            m_activeFrameCapture->commitFrame();
+        }
+    }
+
+    void Simulation::enableCheckpointing(std::string const & path,
+                                         long const everyN,
+                                         CheckpointFormat const format)
+    {
+        m_checkpointer = std::make_unique<Checkpointer>(path);
+        m_checkpointEvery = everyN;
+        m_checkpointFormat = format;
+    }
+
+    void Simulation::requestCheckpoint()
+    {
+        m_checkpointRequested = true;
+    }
+
+    void Simulation::checkpoint()
+    {
+        if (m_checkpointFormat == CheckpointFormat::Flat) {
+            FlatCheckpoint::write(m_checkpointBuffer, m_checkpointRecords,
+                                  m_tick, m_animatWorld, m_population);
+            m_checkpointer->submit(m_checkpointBuffer);
+            return;
+        }
+        m_checkpointBuffer.clear();
+        serial::BinaryWriter writer(m_checkpointBuffer);
+        Checkpointer::writeHeader(writer);
+        writer.write(static_cast<std::int64_t>(m_tick));
+        neat::Network::saveGlobalInnovations(writer);
+        m_animatWorld.save(writer);
+        m_population.save(writer);
+        m_checkpointer->submit(m_checkpointBuffer);
+    }
+
+    bool Simulation::restore(std::string const & path)
+    {
+        if (FlatCheckpoint::isFlatCheckpoint(path)) {
+            FlatCheckpoint const flat(path);
+            m_tick = flat.restore(m_animatWorld, m_population);
+            m_animatWorld.publishSnapshot(m_tick);
+            return true;
+        }
+        auto const data = Checkpointer::readFile(path);
+        if (data.empty()) {
+            return false;
+        }
+        serial::BinaryReader reader(data.data(), data.size());
+        Checkpointer::readHeader(reader);
+        m_tick = reader.read<std::int64_t>();
+        neat::Network::loadGlobalInnovations(reader);
+        m_animatWorld.load(reader);
+        m_population.load(reader);
+        if (!reader.atEnd()) {
+            throw std::runtime_error("Simulation::restore: trailing data in " + path);
+        }
+        m_animatWorld.publishSnapshot(m_tick);
+        return true;
+    }
+
     void Simulation::enableCollisionHandling()
     {
+        // See Population::setGenerational
+        if (m_population.getGenerationTicks() > 0) {
+            throw std::runtime_error("Simulation::enableCollisionHandling: generational evolution is on");
+        }
         auto & agents = m_population.getAgents();
         for(auto & agent : agents) {
             agent.enableCollisionHandling();
@@ -0,0 +1,107 @@
+/// Copyright (c) 2017-present Ben Jones
+
+#include "simulator/WorkerPool.hpp"
+#include <algorithm>
+
+namespace simulator {
+
+    WorkerPool::WorkerPool(int const workers)
+      : m_threads()
+      , m_errors()
+      , m_mutex()
+      , m_start()
+      , m_done()
+      , m_function(nullptr)
+      , m_context(nullptr)
+      , m_generation(0)
+      , m_remaining(0)
+      , m_shutdown(false)
+    {
+        auto const count = workers > 0
+                         ? workers
+                         : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        m_errors.resize(count);
+        m_threads.reserve(count - 1);
+        for (int w = 1; w < count; ++w) {
+            m_threads.emplace_back(&WorkerPool::work, this, w);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_shutdown = true;
+        }
+        m_start.notify_all();
+        for (auto & thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    int WorkerPool::size() const
+    {
+        return static_cast<int>(m_errors.size());
+    }
+
+    void WorkerPool::dispatch(Function const function, void * const context)
+    {
+        if (m_threads.empty()) {
+            function(context, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lg(m_mutex);
+            m_function = function;
+            m_context = context;
+            m_remaining = static_cast<int>(m_threads.size());
+            ++m_generation;
+        }
+        m_start.notify_all();
+        call(0);
+        {
+            std::unique_lock<std::mutex> ul(m_mutex);
+            m_done.wait(ul, [this] { return m_remaining == 0; });
+        }
+        for (auto & error : m_errors) {
+            if (error) {
+                auto const first = error;
+                std::fill(std::begin(m_errors), std::end(m_errors), nullptr);
+                std::rethrow_exception(first);
+            }
+        }
+    }
+
+    void WorkerPool::call(int const worker)
+    {
+        try {
+            m_function(m_context, worker);
+        } catch (...) {
+            m_errors[worker] = std::current_exception();
+        }
+    }
+
+    void WorkerPool::work(int const worker)
+    {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> ul(m_mutex);
+                m_start.wait(ul, [this, seen] { return m_shutdown || m_generation != seen; });
+                if (m_shutdown) {
+                    return;
+                }
+                seen = m_generation;
+            }
+            call(worker);
+            bool last = false;
+            {
+                std::lock_guard<std::mutex> lg(m_mutex);
+                last = --m_remaining == 0;
+            }
+            if (last) {
+                m_done.notify_one();
+            }
+        }
+    }
+}